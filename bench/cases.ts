@@ -0,0 +1,239 @@
+import { Readable, Transform, Writable } from 'stream';
+import { pipeline } from 'stream/promises';
+import binding = require('../binding');
+import {
+  compress,
+  compressAsync,
+  CompressStream,
+  Compressor,
+  decompress,
+  decompressAsync,
+  DecompressStream,
+  Decompressor,
+  trainDictionary,
+} from '../lib';
+import { Corpus, makeCorpora, makeRecords } from './corpora';
+
+export interface BenchCase {
+  name: string;
+  /** Uncompressed bytes processed by each call to `run`. */
+  bytes: number;
+  run(): void | Promise<void>;
+}
+
+const STREAM_CHUNK_SIZES = [4 * 1024, 64 * 1024, 1024 * 1024];
+const MT_LEVELS = [3, 9];
+const MT_WORKERS = [0, 2, 4];
+
+async function runStream(
+  stream: Transform,
+  data: Buffer,
+  chunkSize: number,
+): Promise<void> {
+  const chunks: Buffer[] = [];
+  for (let pos = 0; pos < data.length; pos += chunkSize) {
+    chunks.push(data.subarray(pos, pos + chunkSize));
+  }
+  const sink = new Writable({
+    write(_chunk, _encoding, callback) {
+      callback();
+    },
+  });
+  await pipeline(Readable.from(chunks), stream, sink);
+}
+
+function formatSize(size: number): string {
+  return size >= 1024 * 1024 ? `${size / 1024 / 1024}M` : `${size / 1024}K`;
+}
+
+function corpusCases(corpora: readonly Corpus[]): BenchCase[] {
+  const cases: BenchCase[] = [];
+  for (const { name, data } of corpora) {
+    const bytes = data.length;
+    const frame = compress(data);
+    const cmp = new Compressor();
+    const dec = new Decompressor();
+    cases.push(
+      { name: `compress/${name}`, bytes, run: () => void compress(data) },
+      {
+        name: `compressAsync/${name}`,
+        bytes,
+        run: async () => void (await compressAsync(data)),
+      },
+      { name: `decompress/${name}`, bytes, run: () => void decompress(frame) },
+      {
+        name: `decompressAsync/${name}`,
+        bytes,
+        run: async () => void (await decompressAsync(frame)),
+      },
+      {
+        name: `Compressor/${name}`,
+        bytes,
+        run: () => void cmp.compress(data),
+      },
+      {
+        name: `Decompressor/${name}`,
+        bytes,
+        run: () => void dec.decompress(frame),
+      },
+    );
+    for (const chunkSize of STREAM_CHUNK_SIZES) {
+      const chunk = formatSize(chunkSize);
+      cases.push(
+        {
+          name: `CompressStream/${chunk}/${name}`,
+          bytes,
+          run: () => runStream(new CompressStream(), data, chunkSize),
+        },
+        {
+          name: `DecompressStream/${chunk}/${name}`,
+          bytes,
+          run: () => runStream(new DecompressStream(), frame, chunkSize),
+        },
+      );
+    }
+  }
+  return cases;
+}
+
+// Multithreading only pays off on compressible data, so these stick to JSON
+function multithreadCases(corpora: readonly Corpus[]): BenchCase[] {
+  const cases: BenchCase[] = [];
+  const corpus = corpora.find((c) => c.name === 'json');
+  if (corpus === undefined) return cases;
+  const { name, data } = corpus;
+  for (const level of MT_LEVELS) {
+    for (const workers of MT_WORKERS) {
+      const cmp = new Compressor();
+      cmp.setParameters({ compressionLevel: level, nbWorkers: workers });
+      cases.push({
+        name: `Compressor/level=${level}/workers=${workers}/${name}`,
+        bytes: data.length,
+        run: () => void cmp.compress(data),
+      });
+    }
+  }
+  return cases;
+}
+
+async function dictionaryCases(): Promise<BenchCase[]> {
+  const records = makeRecords(4000);
+  const training = records.slice(0, 2000);
+  const samples = records.slice(2000);
+  const bytes = samples.reduce((acc, sample) => acc + sample.length, 0);
+  const dict = await trainDictionary(training);
+
+  const cases: BenchCase[] = [];
+  for (const [variant, dictionary] of [
+    ['none', undefined],
+    ['dict', dict],
+  ] as const) {
+    const cmp = new Compressor();
+    const dec = new Decompressor();
+    if (dictionary !== undefined) {
+      cmp.loadDictionary(dictionary);
+      dec.loadDictionary(dictionary);
+    }
+    const frames = samples.map((sample) => cmp.compress(sample));
+    cases.push(
+      {
+        name: `records/Compressor/${variant}`,
+        bytes,
+        run: () => {
+          for (const sample of samples) cmp.compress(sample);
+        },
+      },
+      {
+        name: `records/compressBatch/${variant}`,
+        bytes,
+        run: () => void cmp.compressBatch(samples),
+      },
+      {
+        name: `records/Decompressor/${variant}`,
+        bytes,
+        run: () => {
+          for (const frame of frames) dec.decompress(frame);
+        },
+      },
+    );
+  }
+  return cases;
+}
+
+// Payloads small enough that the cost of crossing into native code dominates,
+// measured against raw libzstd calls as a baseline
+function tinyCases(): BenchCase[] {
+  const records = makeRecords(1000);
+  const bytes = records.reduce((acc, record) => acc + record.length, 0);
+  const frames = records.map((record) => compress(record));
+  const dest = Buffer.alloc(binding.compressBound(1024));
+  const params = new Int32Array(0);
+  const level = binding.defaultCLevel();
+  const cmp = new Compressor();
+  const dec = new Decompressor();
+  return [
+    {
+      name: 'tiny/binding.compress',
+      bytes,
+      run: () => {
+        for (const record of records) binding.compress(dest, record, level);
+      },
+    },
+    {
+      name: 'tiny/binding.compressPooled',
+      bytes,
+      run: () => {
+        for (const record of records)
+          binding.compressPooled(dest, record, params);
+      },
+    },
+    {
+      name: 'tiny/compress',
+      bytes,
+      run: () => {
+        for (const record of records) compress(record);
+      },
+    },
+    {
+      name: 'tiny/Compressor',
+      bytes,
+      run: () => {
+        for (const record of records) cmp.compress(record);
+      },
+    },
+    {
+      name: 'tiny/binding.decompress',
+      bytes,
+      run: () => {
+        for (const frame of frames) binding.decompress(dest, frame);
+      },
+    },
+    {
+      name: 'tiny/decompress',
+      bytes,
+      run: () => {
+        for (const frame of frames) decompress(frame);
+      },
+    },
+    {
+      name: 'tiny/Decompressor',
+      bytes,
+      run: () => {
+        for (const frame of frames) dec.decompress(frame);
+      },
+    },
+  ];
+}
+
+/**
+ * Build every benchmark case, with corpora of `size` bytes.
+ */
+export async function makeCases(size: number): Promise<BenchCase[]> {
+  const corpora = makeCorpora(size);
+  return [
+    ...corpusCases(corpora),
+    ...multithreadCases(corpora),
+    ...tinyCases(),
+    ...(await dictionaryCases()),
+  ];
+}
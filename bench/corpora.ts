@@ -0,0 +1,98 @@
+export interface Corpus {
+  name: string;
+  data: Buffer;
+}
+
+// Small seeded PRNG (mulberry32), so every run measures identical data
+function makeRandom(seed: number): () => number {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+const LEVELS = ['debug', 'info', 'info', 'info', 'warn', 'error'];
+const PATHS = ['/api/users', '/api/orders', '/api/search', '/health', '/login'];
+
+function logRecord(rand: () => number, i: number): string {
+  const pick = <T>(arr: readonly T[]): T =>
+    arr[Math.floor(rand() * arr.length)] as T;
+  return JSON.stringify({
+    ts: 1700000000000 + i * 37,
+    level: pick(LEVELS),
+    msg: `request ${pick(['completed', 'failed', 'retried'])}`,
+    path: pick(PATHS),
+    status: pick([200, 200, 200, 201, 304, 404, 500]),
+    durationMs: Math.round(rand() * 250),
+    user: `user-${Math.floor(rand() * 5000)}`,
+    requestId: Math.floor(rand() * 2 ** 48).toString(16),
+  });
+}
+
+function jsonLogs(size: number, rand: () => number): Buffer {
+  const lines: string[] = [];
+  let length = 0;
+  for (let i = 0; length < size; i++) {
+    const line = logRecord(rand, i) + '\n';
+    lines.push(line);
+    length += line.length;
+  }
+  return Buffer.from(lines.join('')).subarray(0, size);
+}
+
+// Fixed-size records of timestamps, small IDs, and a random walk, like a
+// typical metrics dump
+function binary(size: number, rand: () => number): Buffer {
+  const buf = Buffer.alloc(size);
+  let value = 100;
+  for (let pos = 0; pos + 16 <= size; pos += 16) {
+    value += rand() - 0.5;
+    buf.writeUInt32LE(1700000000 + pos / 16, pos);
+    buf.writeUInt32LE(Math.floor(rand() * 64), pos + 4);
+    buf.writeDoubleLE(value, pos + 8);
+  }
+  return buf;
+}
+
+function random(size: number, rand: () => number): Buffer {
+  const buf = Buffer.alloc(size);
+  for (let i = 0; i < size; i++) {
+    buf[i] = Math.floor(rand() * 256);
+  }
+  return buf;
+}
+
+function repetitive(size: number, rand: () => number): Buffer {
+  const phrases = Array.from({ length: 8 }, () => random(64, rand));
+  const parts: Buffer[] = [];
+  for (let length = 0; length < size; length += 64) {
+    parts.push(phrases[Math.floor(rand() * phrases.length)] as Buffer);
+  }
+  return Buffer.concat(parts).subarray(0, size);
+}
+
+/**
+ * Generate the benchmark corpora, each `size` bytes long.
+ */
+export function makeCorpora(size: number): Corpus[] {
+  return [
+    { name: 'json', data: jsonLogs(size, makeRandom(1)) },
+    { name: 'binary', data: binary(size, makeRandom(2)) },
+    { name: 'random', data: random(size, makeRandom(3)) },
+    { name: 'repetitive', data: repetitive(size, makeRandom(4)) },
+  ];
+}
+
+/**
+ * Generate `count` small JSON records, for the dictionary benchmarks.
+ */
+export function makeRecords(count: number): Buffer[] {
+  const rand = makeRandom(5);
+  return Array.from({ length: count }, (_, i) =>
+    Buffer.from(logRecord(rand, i)),
+  );
+}
@@ -0,0 +1,94 @@
+import { performance } from 'perf_hooks';
+import type { BenchCase } from './cases';
+
+const MIN_ITERATIONS = 5;
+
+export interface BenchResult {
+  name: string;
+  iterations: number;
+  /** Throughput of uncompressed data, in MB/s. */
+  throughput: number;
+  /** Per-call latency, in milliseconds. */
+  latency: { mean: number; median: number; p99: number };
+}
+
+export interface Comparison {
+  name: string;
+  baseline: number;
+  current: number;
+  /** Relative change in throughput, negative if slower. */
+  change: number;
+  regressed: boolean;
+}
+
+async function runOnce(benchCase: BenchCase): Promise<number> {
+  const start = performance.now();
+  const promise = benchCase.run();
+  // Synchronous cases aren't awaited, so they're timed without a microtask
+  if (promise instanceof Promise) await promise;
+  return performance.now() - start;
+}
+
+/**
+ * Run `benchCase` repeatedly for at least `minTime` milliseconds, after a
+ * short warmup.
+ */
+export async function measure(
+  benchCase: BenchCase,
+  minTime: number,
+): Promise<BenchResult> {
+  let warmup = 0;
+  do {
+    warmup += await runOnce(benchCase);
+  } while (warmup < minTime / 10);
+
+  const times: number[] = [];
+  let total = 0;
+  while (total < minTime || times.length < MIN_ITERATIONS) {
+    const time = await runOnce(benchCase);
+    times.push(time);
+    total += time;
+  }
+
+  times.sort((a, b) => a - b);
+  const percentile = (p: number): number =>
+    times[Math.min(times.length - 1, Math.floor(p * times.length))] ?? 0;
+  return {
+    name: benchCase.name,
+    iterations: times.length,
+    throughput: (benchCase.bytes * times.length) / (total * 1000),
+    latency: {
+      mean: total / times.length,
+      median: percentile(0.5),
+      p99: percentile(0.99),
+    },
+  };
+}
+
+/**
+ * Compare throughput against a baseline, flagging any case that got slower by
+ * more than `threshold` (as a fraction).
+ *
+ * Cases missing from either side are skipped.
+ */
+export function compareResults(
+  baseline: readonly BenchResult[],
+  current: readonly BenchResult[],
+  threshold: number,
+): Comparison[] {
+  const baselineByName = new Map(baseline.map((r) => [r.name, r]));
+  const comparisons: Comparison[] = [];
+  for (const result of current) {
+    const base = baselineByName.get(result.name);
+    if (base === undefined) continue;
+    const change = result.throughput / base.throughput - 1;
+    comparisons.push({
+      name: result.name,
+      baseline: base.throughput,
+      current: result.throughput,
+      change,
+      regressed: change < -threshold,
+    });
+  }
+  return comparisons;
+}
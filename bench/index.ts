@@ -0,0 +1,91 @@
+// Benchmarks for the high-level API, run against the native addon built by
+// `npm run build`:
+//
+//   npm run bench -- [--filter REGEX] [--time MS] [--size BYTES]
+//                    [--json FILE] [--compare FILE] [--threshold FRACTION]
+//
+// Every case runs for at least --time milliseconds (default 1000) after a
+// short warmup, on deterministic corpora of --size bytes (default 4 MiB).
+// --json saves the results, which a later run can check with --compare: any
+// case whose throughput dropped by more than --threshold (default 0.1) is
+// flagged, and the process exits with an error.
+import * as fs from 'fs';
+import { parseArgs } from 'util';
+import binding = require('../binding');
+import { makeCases } from './cases';
+import { BenchResult, compareResults, measure } from './harness';
+
+interface BenchReport {
+  node: string;
+  zstd: string;
+  results: BenchResult[];
+}
+
+function formatResult(result: BenchResult): string {
+  const { throughput, latency } = result;
+  return [
+    result.name.padEnd(48),
+    `${throughput.toFixed(1).padStart(9)} MB/s`,
+    `median ${latency.median.toFixed(3).padStart(9)} ms`,
+    `p99 ${latency.p99.toFixed(3).padStart(9)} ms`,
+  ].join('  ');
+}
+
+async function main(): Promise<void> {
+  const { values } = parseArgs({
+    options: {
+      filter: { type: 'string' },
+      time: { type: 'string', default: '1000' },
+      size: { type: 'string', default: String(4 * 1024 * 1024) },
+      json: { type: 'string' },
+      compare: { type: 'string' },
+      threshold: { type: 'string', default: '0.1' },
+    },
+  });
+  const filter = new RegExp(values.filter ?? '');
+  const minTime = Number(values.time);
+  const threshold = Number(values.threshold);
+
+  const baseline =
+    values.compare === undefined
+      ? undefined
+      : (JSON.parse(fs.readFileSync(values.compare, 'utf8')) as BenchReport);
+
+  const cases = await makeCases(Number(values.size));
+  const results: BenchResult[] = [];
+  for (const benchCase of cases) {
+    if (!filter.test(benchCase.name)) continue;
+    const result = await measure(benchCase, minTime);
+    console.log(formatResult(result));
+    results.push(result);
+  }
+
+  if (values.json !== undefined) {
+    const report: BenchReport = {
+      node: process.version,
+      zstd: binding.versionString(),
+      results,
+    };
+    fs.writeFileSync(values.json, JSON.stringify(report, null, 2) + '\n');
+  }
+
+  if (baseline !== undefined) {
+    console.log(`\nCompared to ${values.compare ?? ''}:`);
+    const comparisons = compareResults(baseline.results, results, threshold);
+    for (const { name, change, regressed } of comparisons) {
+      const sign = change >= 0 ? '+' : '';
+      const percent = `${sign}${(change * 100).toFixed(1)}%`.padStart(8);
+      const flag = regressed ? '  REGRESSED' : '';
+      console.log(`${name.padEnd(48)}  ${percent}${flag}`);
+    }
+    if (comparisons.some((c) => c.regressed)) {
+      console.error('\nThroughput regressed beyond the threshold');
+      process.exitCode = 1;
+    }
+  }
+}
+
+main().catch((err: unknown) => {
+  console.error(err);
+  process.exitCode = 1;
+});
@@ -0,0 +1,19 @@
+// Compiles TypeScript on the fly, so the benchmarks run straight from source
+// against the same code the tests exercise
+const fs = require('fs');
+const ts = require('typescript');
+
+require.extensions['.ts'] = (mod, filename) => {
+  const { outputText } = ts.transpileModule(fs.readFileSync(filename, 'utf8'), {
+    compilerOptions: {
+      esModuleInterop: true,
+      module: ts.ModuleKind.CommonJS,
+      target: ts.ScriptTarget.ES2022,
+    },
+    fileName: filename,
+  });
+  // _compile is internal to the CommonJS loader, so it isn't typed
+  /** @type {any} */
+  const loader = mod;
+  loader._compile(outputText, filename);
+};
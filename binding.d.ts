@@ -45,6 +45,19 @@ export const MAGIC_SKIPPABLE_START: number;
  */
 export const MAGIC_SKIPPABLE_MASK: number;
 
+/**
+ * Size of the header of a skippable frame, which precedes its contents.
+ *
+ * Corresponds to `ZSTD_SKIPPABLEHEADERSIZE`.
+ * @experimental
+ */
+export const SKIPPABLEHEADERSIZE: number;
+
+/**
+ * Number of entries in each row of the table returned by {@link scanFrames}.
+ */
+export const FRAME_FIELD_COUNT: number;
+
 /**
  * Parameters for Zstandard compression.
  *
@@ -60,6 +73,11 @@ export enum CParameter {
   targetLength,
   strategy,
   targetCBlockSize,
+  /**
+   * Largest block to produce, which lets decompressors limit their memory use
+   * with {@link DParameter.maxBlockSize}.
+   */
+  maxBlockSize,
   enableLongDistanceMatching,
   ldmHashLog,
   ldmMinMatch,
@@ -71,6 +89,47 @@ export enum CParameter {
   nbWorkers,
   jobSize,
   overlapLog,
+  /**
+   * Whether sequences passed to {@link CCtx.compressSequences} mark block
+   * boundaries, as a {@link SequenceFormat}.
+   */
+  blockDelimiters,
+  /** Validate sequences passed to {@link CCtx.compressSequences}. */
+  validateSequences,
+  /**
+   * Fall back to the internal match finder when a registered sequence
+   * producer fails, instead of failing compression.
+   */
+  enableSeqProducerFallback,
+  /**
+   * Promise that streaming compression is always passed the same input buffer,
+   * with the position where the previous call left off, so the input doesn't
+   * need to be copied into an internal window buffer. Positions are passed to
+   * {@link CCtx.compressStream2Into}.
+   */
+  stableInBuffer,
+  /**
+   * Promise that streaming compression is always passed the same output
+   * buffer, with the position where the previous call left off, so output is
+   * written directly instead of going through an internal buffer.
+   */
+  stableOutBuffer,
+}
+
+/**
+ * Formats of the sequences passed to {@link CCtx.compressSequences}.
+ *
+ * Used as values for {@link CParameter.blockDelimiters}.
+ *
+ * Corresponds to `ZSTD_sequenceFormat_e`.
+ *
+ * @category Advanced API
+ */
+export enum SequenceFormat {
+  /** Blocks are split automatically */
+  noBlockDelimiters,
+  /** Each block ends with a sequence with `offset` and `matchLength` of 0 */
+  explicitBlockDelimiters,
 }
 
 /**
@@ -82,6 +141,24 @@ export enum CParameter {
  */
 export enum DParameter {
   windowLogMax,
+  /**
+   * Allow {@link DCtx.refDDict} to reference several dictionaries, selecting
+   * one for each frame by its dictionary ID.
+   */
+  refMultipleDDicts,
+  /**
+   * Largest block to accept, which caps the memory used for streaming
+   * decompression. Frames with larger blocks fail to decompress, so this must
+   * be at least the {@link CParameter.maxBlockSize} they were compressed with.
+   */
+  maxBlockSize,
+  /**
+   * Promise that streaming decompression is always passed the same output
+   * buffer, with the position where the previous call left off, so output is
+   * written directly instead of going through an internal window buffer.
+   * Positions are passed to {@link DCtx.decompressStreamInto}.
+   */
+  stableOutBuffer,
 }
 
 /**
@@ -100,6 +177,58 @@ export enum EndDirective {
   end,
 }
 
+/**
+ * Indices into the arrays returned by {@link CCtx.getStats},
+ * {@link DCtx.getStats}, and {@link getStats}.
+ *
+ * @category Statistics
+ */
+export enum Stat {
+  /** Number of (de)compression calls */
+  calls,
+  /** Bytes consumed from input buffers */
+  bytesIn,
+  /** Bytes written to output buffers */
+  bytesOut,
+  /** Time spent in libzstd, in nanoseconds */
+  nanos,
+  /** Largest context memory usage seen after a call, in bytes */
+  peakMemory,
+}
+
+/**
+ * Columns of the table returned by {@link scanFrames}.
+ *
+ * @category Simple API
+ */
+export enum FrameField {
+  /** Offset of the frame in the scanned buffer */
+  offset,
+  /** Size of the whole frame, including its header */
+  compressedSize,
+  /** Decompressed size, or -1 if the frame doesn't record it */
+  contentSize,
+  /**
+   * Upper bound on the decompressed size, equal to `contentSize` when that is
+   * known
+   */
+  decompressBound,
+  /** Window size needed to decompress the frame */
+  windowSize,
+  /**
+   * Dictionary ID, or 0 if none is recorded. For skippable frames, the low 4
+   * bits of their magic number instead.
+   */
+  dictID,
+  /** 1 if the frame ends with a checksum, 0 otherwise */
+  checksumFlag,
+  /**
+   * 0 for Zstandard frames, or 1 for skippable frames, which have no content
+   * (so zero sizes)
+   */
+  frameType,
+}
+
 /**
  * Identifies what parts of a (de)compression context to reset.
  *
@@ -159,6 +288,23 @@ type StreamResult = [
   srcConsumed: number,
 ];
 
+declare const sequenceProducerTag: unique symbol;
+
+/**
+ * Handle to a native sequence producer, for
+ * {@link CCtx.registerSequenceProducer}.
+ *
+ * Can't be created from JavaScript: sequence producers are C++ functions,
+ * provided by other native addons as a `napi_external` wrapping a
+ * `ZstdNapiSequenceProducer` (see `src/sequence_producer.h`) and tagged with
+ * `kSequenceProducerTypeTag`.
+ *
+ * @category Advanced API
+ */
+export interface SequenceProducer {
+  readonly [sequenceProducerTag]: true;
+}
+
 /**
  * Compression context.
  *
@@ -236,6 +382,24 @@ export class CCtx {
     dict: CDict,
   ): number;
 
+  /**
+   * Asynchronous version of {@link compressUsingCDict}.
+   *
+   * Runs on the libuv threadpool. See {@link compress2Async} for the
+   * restrictions that apply while the operation is in progress.
+   *
+   * @param dstBuf - Output buffer for compressed bytes
+   * @param srcBuf - Data to compress
+   * @param dict - Prepared dictionary
+   * @returns Promise resolving to the number of compressed bytes written to
+   * `dstBuf`
+   */
+  compressUsingCDictAsync(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+    dict: CDict,
+  ): Promise<number>;
+
   /**
    * Set a compression parameter.
    *
@@ -283,6 +447,26 @@ export class CCtx {
    */
   compress2(dstBuf: Uint8Array, srcBuf: Uint8Array): number;
 
+  /**
+   * Asynchronous version of {@link compress2}.
+   *
+   * The compression runs on the libuv threadpool, so the event loop is free to
+   * do other work in the meantime.
+   *
+   * @remarks
+   * Until the returned promise settles, this context can't be used for anything
+   * else: calling any other method on it will throw an error. The buffers are
+   * kept alive for the duration of the operation, but their contents must not
+   * be modified, and their underlying `ArrayBuffer`s must not be transferred or
+   * detached.
+   *
+   * @param dstBuf - Output buffer for compressed bytes
+   * @param srcBuf - Data to compress
+   * @returns Promise resolving to the number of compressed bytes written to
+   * `dstBuf`
+   */
+  compress2Async(dstBuf: Uint8Array, srcBuf: Uint8Array): Promise<number>;
+
   /**
    * Compresses `srcBuf` into `dstBuf` with a streaming interface.
    *
@@ -310,6 +494,166 @@ export class CCtx {
     endOp: EndDirective,
   ): StreamResult;
 
+  /**
+   * Asynchronous version of {@link compressStream2}.
+   *
+   * Runs on the libuv threadpool. See {@link compress2Async} for the
+   * restrictions that apply while the operation is in progress.
+   *
+   * @param dstBuf - Output buffer for compressed bytes
+   * @param srcBuf - Data to compress
+   * @param endOp - Whether to flush or end the frame
+   * @returns Promise resolving to compression progress information
+   */
+  compressStream2Async(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+    endOp: EndDirective,
+  ): Promise<StreamResult>;
+
+  /**
+   * Version of {@link compressStream2} that stores its result in an existing
+   * array.
+   *
+   * The three elements of the {@link StreamResult} are written to the start of
+   * `result` instead of a newly allocated tuple, so streaming loops can reuse a
+   * single array for every call.
+   *
+   * Output and input start at `dstPos` and `srcPos` (0 by default), which the
+   * {@link CParameter.stableOutBuffer} and {@link CParameter.stableInBuffer}
+   * parameters require to pass the same buffers to every call. The positions
+   * stored in `result` are then relative to the start of the buffers, rather
+   * than byte counts.
+   *
+   * @param dstBuf - Output buffer for compressed bytes
+   * @param srcBuf - Data to compress
+   * @param endOp - Whether to flush or end the frame
+   * @param result - Array with room for at least three elements
+   * @param dstPos - Position in `dstBuf` to start writing at
+   * @param srcPos - Position in `srcBuf` to start reading at
+   */
+  compressStream2Into(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+    endOp: EndDirective,
+    result: Float64Array,
+    dstPos?: number,
+    srcPos?: number,
+  ): void;
+
+  /**
+   * Compresses a batch of inputs into one output buffer.
+   *
+   * The inputs are stored back-to-back in `srcBuf`, with input `i` spanning
+   * from `srcOffsets[i]` to `srcOffsets[i + 1]`, so `srcOffsets` has one more
+   * entry than there are inputs. Each input is compressed into its own frame
+   * (as if by {@link compress2}), and the frames are written back-to-back into
+   * `dstBuf`. Frame boundaries are written to `dstOffsets` in the same format,
+   * so it must be the same length as `srcOffsets`.
+   *
+   * `dstBuf` must be large enough to fit every frame. The sum of
+   * {@link compressBound} over each input size is always sufficient. Output is
+   * limited to 4 GiB, since offsets are 32-bit.
+   *
+   * @remarks
+   * Compressing many small inputs this way is much faster than calling
+   * {@link compress2} on each one, since the per-call overhead of crossing into
+   * native code is only paid once.
+   *
+   * @param dstBuf - Output buffer for compressed frames
+   * @param srcBuf - Data to compress
+   * @param srcOffsets - Boundaries of each input in `srcBuf`
+   * @param dstOffsets - Output array for the boundaries of each frame
+   * @returns Total number of compressed bytes written to `dstBuf`
+   */
+  compressBatch(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+    srcOffsets: Uint32Array,
+    dstOffsets: Uint32Array,
+  ): number;
+
+  /**
+   * Asynchronous version of {@link compressBatch}.
+   *
+   * Runs on the libuv threadpool. See {@link compress2Async} for the
+   * restrictions that apply while the operation is in progress, which also
+   * apply to `dstOffsets`.
+   *
+   * @param dstBuf - Output buffer for compressed frames
+   * @param srcBuf - Data to compress
+   * @param srcOffsets - Boundaries of each input in `srcBuf`
+   * @param dstOffsets - Output array for the boundaries of each frame
+   * @returns Promise resolving to the total number of compressed bytes written
+   * to `dstBuf`
+   */
+  compressBatchAsync(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+    srcOffsets: Uint32Array,
+    dstOffsets: Uint32Array,
+  ): Promise<number>;
+
+  /**
+   * Compresses `srcBuf` into `dstBuf` as described by `seqBuf`.
+   *
+   * Instead of searching for matches, the encoder uses the caller's sequences,
+   * which is much faster when the caller already knows where the repetition
+   * in its data is. Each sequence is packed as four consecutive elements of
+   * `seqBuf`: the match offset, the number of literals before the match, the
+   * match length, and a `rep` field that's ignored on input. The literal and
+   * match lengths must add up to the length of `srcBuf`.
+   *
+   * Respects the parameters set with {@link setParameter}, notably
+   * {@link CParameter.blockDelimiters} and
+   * {@link CParameter.validateSequences}.
+   *
+   * Wraps `ZSTD_compressSequences`.
+   *
+   * @param dstBuf - Output buffer for compressed bytes
+   * @param seqBuf - Packed sequences describing `srcBuf`
+   * @param srcBuf - Data to compress
+   * @returns Number of compressed bytes written to `dstBuf`
+   */
+  compressSequences(
+    dstBuf: Uint8Array,
+    seqBuf: Uint32Array,
+    srcBuf: Uint8Array,
+  ): number;
+
+  /**
+   * Asynchronous version of {@link compressSequences}.
+   *
+   * Runs on the libuv threadpool. See {@link compress2Async} for the
+   * restrictions that apply while the operation is in progress, which also
+   * apply to `seqBuf`.
+   *
+   * @param dstBuf - Output buffer for compressed bytes
+   * @param seqBuf - Packed sequences describing `srcBuf`
+   * @param srcBuf - Data to compress
+   * @returns Promise resolving to the number of compressed bytes written to
+   * `dstBuf`
+   */
+  compressSequencesAsync(
+    dstBuf: Uint8Array,
+    seqBuf: Uint32Array,
+    srcBuf: Uint8Array,
+  ): Promise<number>;
+
+  /**
+   * Use a native sequence producer to find matches during compression.
+   *
+   * The producer replaces the internal match finder for block compression by
+   * {@link compress2} and {@link compressStream2}. It can't be combined with
+   * multithreading or long-distance matching. Pass `null` to go back to the
+   * internal match finder.
+   *
+   * Wraps `ZSTD_registerSequenceProducer`.
+   *
+   * @param producer - Sequence producer created by a native addon
+   */
+  registerSequenceProducer(producer: SequenceProducer | null): void;
+
   /**
    * Load a compression dictionary from `dictBuf`.
    *
@@ -320,14 +664,101 @@ export class CCtx {
    */
   loadDictionary(dictBuf: Uint8Array): void;
 
+  /**
+   * Use the prepared dictionary `cdict` for compression.
+   *
+   * Like {@link loadDictionary}, this dictionary will only be used by the
+   * {@link compress2} and {@link compressStream2} methods. It remains in use
+   * until replaced, or until parameters are reset. Referencing a prepared
+   * dictionary is much cheaper than loading one, since it doesn't need to be
+   * copied or digested again.
+   *
+   * The compression level of `cdict` overrides the level set on this context.
+   *
+   * Wraps `ZSTD_CCtx_refCDict`.
+   */
+  refCDict(cdict: CDict): void;
+
+  /**
+   * Run multithreaded compression jobs on the shared thread pool `pool`.
+   *
+   * Only used when {@link CParameter.nbWorkers} is set, and only takes effect
+   * if called before this context first compresses with workers. The pool
+   * remains in use across parameter resets. Pass `null` to start private
+   * worker threads instead.
+   *
+   * Wraps `ZSTD_CCtx_refThreadPool`.
+   */
+  refThreadPool(pool: ThreadPool | null): void;
+
+  /**
+   * Reference `prefixBuf` as raw content for the next frame to match against.
+   *
+   * Works like a content-only dictionary, but the prefix is used in place
+   * without being copied or digested, so it's cheap to set even when large.
+   * Only the next frame compressed by {@link compress2} or
+   * {@link compressStream2} uses it, and it must be decompressed with the same
+   * prefix (see {@link DCtx.refPrefix}). Matches can reach back into the prefix
+   * as far as the window size allows.
+   *
+   * The buffer is kept alive until replaced, but its contents must not be
+   * modified until the frame is complete.
+   *
+   * Wraps `ZSTD_CCtx_refPrefix`.
+   *
+   * @param prefixBuf - Content to use as a prefix
+   */
+  refPrefix(prefixBuf: Uint8Array): void;
+
+  /**
+   * Reports how far compression of the current frame has progressed.
+   *
+   * Input that has been passed in but is still buffered (by the context, or by
+   * worker threads with `nbWorkers` set) counts as ingested but not yet
+   * consumed, so the difference shows how much work is pending.
+   *
+   * Wraps `ZSTD_getFrameProgression`.
+   *
+   * @returns Progress counters for the current frame
+   */
+  getFrameProgression(): FrameProgression;
+
+  /**
+   * Returns how many bytes are ready to be flushed immediately.
+   *
+   * Only meaningful with `nbWorkers` set, in which case this is the amount of
+   * compressed data in the oldest active job. A value of zero while workers
+   * are busy means flushing would have to wait for them. Always returns zero
+   * in single-threaded mode.
+   *
+   * Wraps `ZSTD_toFlushNow`.
+   *
+   * @returns Number of bytes that could be flushed without waiting
+   */
+  toFlushNow(): number;
+
+  /**
+   * Returns this context's usage counters, indexed by {@link Stat}.
+   *
+   * Counters only advance while statistics are enabled with
+   * {@link setStatsEnabled}. They can be read at any time, even while an
+   * asynchronous operation is in progress.
+   *
+   * @returns A new array of counters
+   */
+  getStats(): Float64Array;
+
   private __brand: 'CCtx';
 }
 
 /**
  * Prepared dictionary for compression.
  *
- * Wraps `ZSTD_CDict`. The finalizer automatically calls `ZSTD_freeCDict` when
- * this object is garbage collected.
+ * Wraps `ZSTD_CDict`. Prepared dictionaries are read-only, so identical ones
+ * are shared across the whole process (including worker threads): creating a
+ * `CDict` with the same content and level as one that's already in use reuses
+ * it instead of preparing it again. The native dictionary is freed once the
+ * last object and context using it are gone.
  *
  * @category Dictionary
  */
@@ -342,6 +773,29 @@ export class CDict {
    */
   constructor(dictBuf: Uint8Array, level: number);
 
+  /**
+   * Load a dictionary for compression from the bytes in `dictBuf`, tuned with
+   * the given compression parameters.
+   *
+   * The parameters (such as `windowLog` or `strategy`) are used instead of the
+   * defaults for the compression level, and will override any set when this
+   * dictionary is used. Dictionaries created this way aren't shared across the
+   * process, but can still be shared by any number of contexts with
+   * {@link CCtx.refCDict}.
+   *
+   * If `byRef` is true, the dictionary references `dictBuf` in place instead of
+   * copying it. `dictBuf` is kept alive as long as the dictionary is, but its
+   * contents must not be modified, and its underlying `ArrayBuffer` must not be
+   * transferred or detached.
+   *
+   * Wraps `ZSTD_createCDict_advanced2`.
+   *
+   * @param dictBuf - Dictionary content
+   * @param params - Flattened list of {@link CParameter} and value pairs
+   * @param byRef - Reference `dictBuf` instead of copying it
+   */
+  constructor(dictBuf: Uint8Array, params: Int32Array, byRef: boolean);
+
   /**
    * Returns the ID for this dictionary.
    *
@@ -387,6 +841,26 @@ export class DCtx {
    */
   decompress(dstBuf: Uint8Array, srcBuf: Uint8Array): number;
 
+  /**
+   * Asynchronous version of {@link DCtx.decompress | decompress}.
+   *
+   * The decompression runs on the libuv threadpool, so the event loop is free
+   * to do other work in the meantime.
+   *
+   * @remarks
+   * Until the returned promise settles, this context can't be used for anything
+   * else: calling any other method on it will throw an error. The buffers are
+   * kept alive for the duration of the operation, but their contents must not
+   * be modified, and their underlying `ArrayBuffer`s must not be transferred or
+   * detached.
+   *
+   * @param dstBuf - Output buffer for decompressed bytes
+   * @param srcBuf - Data to decompress
+   * @returns Promise resolving to the number of decompressed bytes written to
+   * `dstBuf`
+   */
+  decompressAsync(dstBuf: Uint8Array, srcBuf: Uint8Array): Promise<number>;
+
   /**
    * Decompresses `srcBuf` into `dstBuf` with a streaming interface.
    *
@@ -407,6 +881,116 @@ export class DCtx {
    */
   decompressStream(dstBuf: Uint8Array, srcBuf: Uint8Array): StreamResult;
 
+  /**
+   * Asynchronous version of {@link decompressStream}.
+   *
+   * Runs on the libuv threadpool. See {@link decompressAsync} for the
+   * restrictions that apply while the operation is in progress.
+   *
+   * @param dstBuf - Output buffer for decompressed bytes
+   * @param srcBuf - Data to decompress
+   * @returns Promise resolving to decompression progress information
+   */
+  decompressStreamAsync(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+  ): Promise<StreamResult>;
+
+  /**
+   * Version of {@link decompressStream} that stores its result in an existing
+   * array.
+   *
+   * See {@link CCtx.compressStream2Into} for details. Output starts at
+   * `dstPos`, for use with {@link DParameter.stableOutBuffer}.
+   *
+   * @param dstBuf - Output buffer for decompressed bytes
+   * @param srcBuf - Data to decompress
+   * @param result - Array with room for at least three elements
+   * @param dstPos - Position in `dstBuf` to start writing at
+   */
+  decompressStreamInto(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+    result: Float64Array,
+    dstPos?: number,
+  ): void;
+
+  /**
+   * Decompresses `srcBuf` into `dstBuf` with a streaming interface, continuing
+   * across frame boundaries.
+   *
+   * Works like {@link decompressStream}, except that it doesn't stop at the
+   * end of each frame: it returns once all of `srcBuf` has been consumed or
+   * `dstBuf` is full. This lets a buffer holding many frames be decompressed
+   * with a single call per output buffer.
+   *
+   * @param dstBuf - Output buffer for decompressed bytes
+   * @param srcBuf - Data to decompress
+   * @returns Decompression progress information
+   */
+  decompressFrames(dstBuf: Uint8Array, srcBuf: Uint8Array): StreamResult;
+
+  /**
+   * Asynchronous version of {@link decompressFrames}.
+   *
+   * Runs on the libuv threadpool. See {@link decompressAsync} for the
+   * restrictions that apply while the operation is in progress.
+   *
+   * @param dstBuf - Output buffer for decompressed bytes
+   * @param srcBuf - Data to decompress
+   * @returns Promise resolving to decompression progress information
+   */
+  decompressFramesAsync(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+  ): Promise<StreamResult>;
+
+  /**
+   * Decompresses a batch of inputs into one output buffer.
+   *
+   * The inverse of {@link CCtx.compressBatch}: input `i` spans from
+   * `srcOffsets[i]` to `srcOffsets[i + 1]` in `srcBuf`, and is decompressed (as
+   * if by {@link DCtx.decompress | decompress}) into `dstBuf` directly after
+   * the output of the previous input. The output boundaries are written to
+   * `dstOffsets`, which must be the same length as `srcOffsets`.
+   *
+   * `dstBuf` must be large enough to fit every output. Output is limited to 4
+   * GiB, since offsets are 32-bit.
+   *
+   * @param dstBuf - Output buffer for decompressed bytes
+   * @param srcBuf - Data to decompress
+   * @param srcOffsets - Boundaries of each input in `srcBuf`
+   * @param dstOffsets - Output array for the boundaries of each output
+   * @returns Total number of decompressed bytes written to `dstBuf`
+   */
+  decompressBatch(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+    srcOffsets: Uint32Array,
+    dstOffsets: Uint32Array,
+  ): number;
+
+  /**
+   * Asynchronous version of {@link decompressBatch}.
+   *
+   * Runs on the libuv threadpool. See {@link decompressAsync} for the
+   * restrictions that apply while the operation is in progress, which also
+   * apply to `dstOffsets`.
+   *
+   * @param dstBuf - Output buffer for decompressed bytes
+   * @param srcBuf - Data to decompress
+   * @param srcOffsets - Boundaries of each input in `srcBuf`
+   * @param dstOffsets - Output array for the boundaries of each output
+   * @returns Promise resolving to the total number of decompressed bytes
+   * written to `dstBuf`
+   */
+  decompressBatchAsync(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+    srcOffsets: Uint32Array,
+    dstOffsets: Uint32Array,
+  ): Promise<number>;
+
   /**
    * Decompresses `srcBuf` into `dstBuf`, using `dictBuf` as a dictionary.
    *
@@ -479,14 +1063,51 @@ export class DCtx {
    */
   loadDictionary(dictBuf: Uint8Array): void;
 
-  private __brand: 'DCtx';
+  /**
+   * Use the prepared dictionary `ddict` for decompression.
+   *
+   * Like {@link loadDictionary}, this dictionary will be used by
+   * {@link DCtx.decompress | decompress} and {@link decompressStream}.
+   * Normally it replaces any previous dictionary, but if the
+   * {@link DParameter.refMultipleDDicts} parameter is enabled, each referenced
+   * dictionary is kept, and the right one is selected for each frame by its
+   * dictionary ID.
+   *
+   * Wraps `ZSTD_DCtx_refDDict`.
+   */
+  refDDict(ddict: DDict): void;
+
+  /**
+   * Reference `prefixBuf` as raw content for the next frame.
+   *
+   * Frames compressed with a prefix (see {@link CCtx.refPrefix}) can only be
+   * decompressed with the same one. Like a compression prefix, it's used in
+   * place, applies only to the next frame, and must not be modified until that
+   * frame is decompressed.
+   *
+   * Wraps `ZSTD_DCtx_refPrefix`.
+   *
+   * @param prefixBuf - Content used as a prefix during compression
+   */
+  refPrefix(prefixBuf: Uint8Array): void;
+
+  /**
+   * Returns this context's usage counters, indexed by {@link Stat}.
+   *
+   * See {@link CCtx.getStats} for details.
+   *
+   * @returns A new array of counters
+   */
+  getStats(): Float64Array;
+
+  private __brand: 'DCtx';
 }
 
 /**
  * Prepared dictionary for decompression.
  *
- * Wraps `ZSTD_DDict`. The finalizer automatically calls `ZSTD_freeDDict` when
- * this object is garbage collected.
+ * Wraps `ZSTD_DDict`. Like {@link CDict}, identical dictionaries are shared
+ * across the whole process, and freed once no longer in use.
  *
  * @category Dictionary
  */
@@ -510,6 +1131,175 @@ export class DDict {
   private __brand: 'DDict';
 }
 
+/**
+ * Pool of worker threads for multithreaded compression.
+ *
+ * By default, each {@link CCtx} with {@link CParameter.nbWorkers} set starts
+ * its own worker threads. Contexts referencing a shared pool with
+ * {@link CCtx.refThreadPool} queue their jobs on it instead, so the total
+ * number of threads stays fixed no matter how many contexts are in use.
+ *
+ * Wraps `ZSTD_threadPool`. The pool is freed once this object is garbage
+ * collected and no context references it anymore.
+ *
+ * @category Advanced API
+ */
+export class ThreadPool {
+  /**
+   * Creates a new pool with `numThreads` worker threads.
+   *
+   * Without `numThreads`, returns a handle to the process-wide pool, sized to
+   * the number of CPU cores, which the pooled contexts of
+   * {@link compressPooled}, {@link compressPooledAsync} and
+   * {@link compressFile} also use when {@link CParameter.nbWorkers} is set.
+   *
+   * Wraps `ZSTD_createThreadPool`.
+   *
+   * @param numThreads - Number of threads, up to the maximum allowed value of
+   * {@link CParameter.nbWorkers}
+   */
+  constructor(numThreads?: number);
+
+  /**
+   * Returns the number of worker threads in this pool.
+   */
+  getNumThreads(): number;
+
+  private __brand: 'ThreadPool';
+}
+
+/**
+ * Random-access reader for data in the Zstandard seekable format.
+ *
+ * The seekable format splits data into independently compressed frames, and
+ * appends a seek table (in a skippable frame) recording the size of each one.
+ * This wraps the parsed seek table, and decompresses arbitrary ranges by
+ * decompressing only the frames that overlap them. The compressed data itself
+ * is passed in separately, so it can be read from disk on demand.
+ *
+ * Mirrors the `ZSTD_seekTable` API from zstd's `contrib/seekable_format`.
+ *
+ * @category Seekable Format
+ */
+export class SeekableReader {
+  /**
+   * Parse the seek table at the end of `tableBuf`.
+   *
+   * `tableBuf` may contain other data before the seek table, such as the
+   * entire file. Use {@link seekTableSize} to find out how much of the end of
+   * a file to read.
+   */
+  constructor(tableBuf: Uint8Array);
+
+  /** Returns the number of frames in the seek table. */
+  getNumFrames(): number;
+
+  /**
+   * Returns the offset of frame `frameIndex` in the compressed data.
+   *
+   * Passing the number of frames returns the total size of the compressed
+   * frames, which is where the seek table starts.
+   */
+  getFrameCompressedOffset(frameIndex: number): number;
+
+  /** Returns the compressed size of frame `frameIndex`. */
+  getFrameCompressedSize(frameIndex: number): number;
+
+  /**
+   * Returns the offset of frame `frameIndex` in the decompressed data.
+   *
+   * Passing the number of frames returns the total decompressed size.
+   */
+  getFrameDecompressedOffset(frameIndex: number): number;
+
+  /** Returns the decompressed size of frame `frameIndex`. */
+  getFrameDecompressedSize(frameIndex: number): number;
+
+  /**
+   * Returns the index of the frame containing decompressed `offset`.
+   *
+   * @returns Index of the frame, or the number of frames if `offset` is past
+   * the end of the data
+   */
+  offsetToFrameIndex(offset: number): number;
+
+  /**
+   * Decompresses `dstBuf.length` bytes starting at decompressed `offset` into
+   * `dstBuf`.
+   *
+   * `srcBuf` must contain the compressed data starting at the beginning of the
+   * frame containing `offset` (see {@link getFrameCompressedOffset}), through
+   * the end of the last frame overlapping the requested range. Frames outside
+   * the range are never touched.
+   *
+   * @param dstBuf - Output buffer for decompressed bytes
+   * @param srcBuf - Compressed frames covering the requested range
+   * @param offset - Decompressed offset to start at
+   * @returns Number of decompressed bytes written to `dstBuf`, which is less
+   * than its length only if the range extends past the end of the data
+   */
+  decompress(dstBuf: Uint8Array, srcBuf: Uint8Array, offset: number): number;
+
+  /**
+   * Asynchronous version of {@link SeekableReader.decompress | decompress}.
+   *
+   * Runs on the libuv threadpool, using pooled decompression contexts. The
+   * reader isn't modified, so any number of calls may be in progress at once,
+   * which allows separate frames to be decompressed in parallel. The buffers
+   * are kept alive until the returned promise settles, but their contents
+   * must not be modified in the meantime.
+   *
+   * @param dstBuf - Output buffer for decompressed bytes
+   * @param srcBuf - Compressed frames covering the requested range
+   * @param offset - Decompressed offset to start at
+   * @returns Promise resolving to the number of decompressed bytes written to
+   * `dstBuf`
+   */
+  decompressAsync(
+    dstBuf: Uint8Array,
+    srcBuf: Uint8Array,
+    offset: number,
+  ): Promise<number>;
+
+  private __brand: 'SeekableReader';
+}
+
+/**
+ * Returns the total size of the seek table ending at the end of `footerBuf`.
+ *
+ * Only the 9-byte seek table footer needs to be present, so this can be used
+ * to find out how much of the end of a file to read before creating a
+ * {@link SeekableReader}.
+ *
+ * @param footerBuf - Buffer ending with a seek table footer
+ * @returns Size of the seek table, including its skippable frame header
+ * @category Seekable Format
+ */
+export function seekTableSize(footerBuf: Uint8Array): number;
+
+/**
+ * Progress of the frame being compressed by a {@link CCtx}.
+ *
+ * Returned by {@link CCtx.getFrameProgression}. Corresponds to
+ * `ZSTD_frameProgression`.
+ *
+ * @category Advanced API
+ */
+export interface FrameProgression {
+  /** Bytes of input passed to the context, including buffered input */
+  ingested: number;
+  /** Bytes of input compressed so far */
+  consumed: number;
+  /** Bytes of compressed output generated so far */
+  produced: number;
+  /** Bytes of compressed output written to output buffers */
+  flushed: number;
+  /** ID of the most recently started job, in multithreaded mode */
+  currentJobID: number;
+  /** Number of worker threads currently running jobs */
+  nbActiveWorkers: number;
+}
+
 /**
  * Inclusive lower and upper bounds for a parameter.
  *
@@ -584,6 +1374,183 @@ export function compress(
  */
 export function decompress(dstBuf: Uint8Array, srcBuf: Uint8Array): number;
 
+/**
+ * Compresses `srcBuf` into `dstBuf` with a pooled compression context.
+ *
+ * Works like {@link CCtx.compress2}, but uses a context from a process-wide
+ * pool instead of a dedicated {@link CCtx}. Pooled contexts keep their
+ * parameters, so repeated calls with the same `params` don't pay to reset and
+ * reconfigure a context. The pool is shared between threads, so this is safe
+ * to use concurrently with {@link compressPooledAsync}.
+ *
+ * Wraps `ZSTD_compress2`.
+ *
+ * @param dstBuf - Output buffer for compressed bytes
+ * @param srcBuf - Data to compress
+ * @param params - Flattened list of {@link CParameter} and value pairs
+ * @returns Number of compressed bytes written to `dstBuf`
+ * @category Simple API
+ */
+export function compressPooled(
+  dstBuf: Uint8Array,
+  srcBuf: Uint8Array,
+  params: Int32Array,
+): number;
+
+/**
+ * Asynchronous version of {@link compressPooled}.
+ *
+ * Runs on the libuv threadpool. The buffers are kept alive for the duration of
+ * the operation, but their contents must not be modified, and their underlying
+ * `ArrayBuffer`s must not be transferred or detached.
+ *
+ * @param dstBuf - Output buffer for compressed bytes
+ * @param srcBuf - Data to compress
+ * @param params - Flattened list of {@link CParameter} and value pairs
+ * @returns Promise resolving to the number of compressed bytes written to
+ * `dstBuf`
+ * @category Simple API
+ */
+export function compressPooledAsync(
+  dstBuf: Uint8Array,
+  srcBuf: Uint8Array,
+  params: Int32Array,
+): Promise<number>;
+
+/**
+ * Decompresses `srcBuf` into `dstBuf` with a pooled decompression context.
+ *
+ * Works like {@link DCtx.decompress}, but uses a context from a process-wide
+ * pool instead of a dedicated {@link DCtx}. See {@link compressPooled} for
+ * details.
+ *
+ * Wraps `ZSTD_decompressDCtx`.
+ *
+ * @param dstBuf - Output buffer for decompressed bytes
+ * @param srcBuf - Data to decompress
+ * @param params - Flattened list of {@link DParameter} and value pairs
+ * @returns Number of decompressed bytes written to `dstBuf`
+ * @category Simple API
+ */
+export function decompressPooled(
+  dstBuf: Uint8Array,
+  srcBuf: Uint8Array,
+  params: Int32Array,
+): number;
+
+/**
+ * Asynchronous version of {@link decompressPooled}.
+ *
+ * Runs on the libuv threadpool, with the same restrictions as
+ * {@link compressPooledAsync}.
+ *
+ * @param dstBuf - Output buffer for decompressed bytes
+ * @param srcBuf - Data to decompress
+ * @param params - Flattened list of {@link DParameter} and value pairs
+ * @returns Promise resolving to the number of decompressed bytes written to
+ * `dstBuf`
+ * @category Simple API
+ */
+export function decompressPooledAsync(
+  dstBuf: Uint8Array,
+  srcBuf: Uint8Array,
+  params: Int32Array,
+): Promise<number>;
+
+/**
+ * Decompresses the frames in `srcBuf` into `dstBuf` in parallel.
+ *
+ * Every frame in `srcBuf` must record its decompressed size, so that its
+ * position in `dstBuf` is known up front. Frames are then handed out to up to
+ * `threads` threads, each decompressing them straight into their slice of
+ * `dstBuf` with a pooled context. Only input made of many frames benefits,
+ * such as the output of {@link CCtx.compressStream2} with regular
+ * {@link EndDirective.end | ends}.
+ *
+ * The threads are started for each call (the calling thread being one of
+ * them), and never outnumber the frames.
+ *
+ * Blocks until every frame is decompressed; see
+ * {@link decompressParallelAsync} to keep the event loop free.
+ *
+ * @param dstBuf - Output buffer for decompressed bytes
+ * @param srcBuf - Data to decompress
+ * @param params - Flattened list of {@link DParameter} and value pairs
+ * @param threads - Maximum number of threads, or 0 for one per CPU core
+ * @returns Number of decompressed bytes written to `dstBuf`
+ * @category Simple API
+ */
+export function decompressParallel(
+  dstBuf: Uint8Array,
+  srcBuf: Uint8Array,
+  params: Int32Array,
+  threads: number,
+): number;
+
+/**
+ * Asynchronous version of {@link decompressParallel}.
+ *
+ * Coordinated from the libuv threadpool, with the same restrictions as
+ * {@link compressPooledAsync}.
+ *
+ * @param dstBuf - Output buffer for decompressed bytes
+ * @param srcBuf - Data to decompress
+ * @param params - Flattened list of {@link DParameter} and value pairs
+ * @param threads - Maximum number of threads, or 0 for one per CPU core
+ * @returns Promise resolving to the number of decompressed bytes written to
+ * `dstBuf`
+ * @category Simple API
+ */
+export function decompressParallelAsync(
+  dstBuf: Uint8Array,
+  srcBuf: Uint8Array,
+  params: Int32Array,
+  threads: number,
+): Promise<number>;
+
+/**
+ * Compresses the file at `srcPath` into a new file at `dstPath`.
+ *
+ * Runs on the libuv threadpool with a pooled context, like
+ * {@link compressPooledAsync}. Where possible, the input is mapped into memory
+ * and compressed in place, with the {@link CParameter.stableInBuffer}
+ * parameter set, and output is written in large blocks. Set
+ * {@link CParameter.nbWorkers} to compress with several threads.
+ *
+ * An existing file at `dstPath` is replaced, and on failure, removed, unless
+ * it's the input file itself, which is rejected. The input file must not be
+ * modified while this is in progress.
+ *
+ * @param srcPath - Path of the file to compress
+ * @param dstPath - Path of the compressed file
+ * @param params - Flattened list of {@link CParameter} and value pairs
+ * @returns Promise resolving to the size of the compressed file
+ * @category Simple API
+ */
+export function compressFile(
+  srcPath: string,
+  dstPath: string,
+  params: Int32Array,
+): Promise<number>;
+
+/**
+ * Decompresses the file at `srcPath` into a new file at `dstPath`.
+ *
+ * Works like {@link compressFile}. When the frames record their content size,
+ * space for the output is reserved up front, where supported.
+ *
+ * @param srcPath - Path of the file to decompress
+ * @param dstPath - Path of the decompressed file
+ * @param params - Flattened list of {@link DParameter} and value pairs
+ * @returns Promise resolving to the size of the decompressed file
+ * @category Simple API
+ */
+export function decompressFile(
+  srcPath: string,
+  dstPath: string,
+  params: Int32Array,
+): Promise<number>;
+
 /**
  * Returns the number of decompressed bytes in the provided frame.
  *
@@ -604,6 +1571,112 @@ export function getFrameContentSize(frameBuf: Uint8Array): number | null;
  */
 export function findFrameCompressedSize(frameBuf: Uint8Array): number;
 
+/**
+ * Returns the total number of decompressed bytes in all frames in `srcBuf`.
+ *
+ * Every frame is scanned in a single call, so this is much cheaper than
+ * walking the frames with {@link getFrameContentSize} and
+ * {@link findFrameCompressedSize}.
+ *
+ * Wraps `ZSTD_findDecompressedSize`.
+ *
+ * @param srcBuf - Buffer containing only complete Zstandard frames
+ * @returns Number of decompressed bytes, or `null` if any frame doesn't record
+ * its size
+ * @category Simple API
+ */
+export function findDecompressedSize(srcBuf: Uint8Array): number | null;
+
+/**
+ * Returns an upper bound on the number of decompressed bytes in all frames in
+ * `srcBuf`.
+ *
+ * Unlike {@link findDecompressedSize}, this works on frames that don't record
+ * their size, but the bound can be much larger than the actual size.
+ *
+ * Wraps `ZSTD_decompressBound`.
+ *
+ * @param srcBuf - Buffer containing only complete Zstandard frames
+ * @returns Maximum number of decompressed bytes
+ * @category Simple API
+ */
+export function decompressBound(srcBuf: Uint8Array): number;
+
+/**
+ * Returns the total number of decompressed bytes in all frames in `srcBuf`,
+ * after checking that it's safe to allocate that much.
+ *
+ * Works like {@link findDecompressedSize}, but throws a `RangeError` if the
+ * size exceeds `maxOutputSize`, and an `Error` if it's more than the frames
+ * could possibly decompress to. Frame headers are otherwise trusted, so this
+ * stops a few bytes of malicious input from claiming gigabytes of content.
+ *
+ * @param srcBuf - Buffer containing only complete Zstandard frames
+ * @param maxOutputSize - Largest acceptable size (may be `Infinity`)
+ * @returns Number of decompressed bytes, or `null` if any frame doesn't record
+ * its size
+ * @category Simple API
+ */
+export function checkDecompressedSize(
+  srcBuf: Uint8Array,
+  maxOutputSize: number,
+): number | null;
+
+/**
+ * Describes every frame in `srcBuf` in a single call.
+ *
+ * Returns a table with one row of {@link FRAME_FIELD_COUNT} entries per frame
+ * (including skippable frames), in order, with the columns given by
+ * {@link FrameField}. Field `f` of frame `i` is at index
+ * `i * FRAME_FIELD_COUNT + f`.
+ *
+ * This is much cheaper than calling {@link getFrameContentSize},
+ * {@link findFrameCompressedSize} and friends on each frame in turn, which
+ * matters for archives made of many small frames.
+ *
+ * @param srcBuf - Buffer containing only complete Zstandard frames
+ * @returns A new table of frame information
+ * @category Simple API
+ */
+export function scanFrames(srcBuf: Uint8Array): Float64Array;
+
+/**
+ * Writes `srcBuf` into `dstBuf` as a skippable frame.
+ *
+ * Decompressors pass over skippable frames, so they can hold metadata
+ * alongside compressed data. `dstBuf` needs room for the contents plus
+ * {@link SKIPPABLEHEADERSIZE} bytes.
+ *
+ * Wraps `ZSTD_writeSkippableFrame`.
+ *
+ * @param dstBuf - Output buffer for the frame
+ * @param srcBuf - Contents of the frame
+ * @param magicVariant - Number from 0 to 15 to distinguish kinds of frames by
+ * @returns Number of bytes written to `dstBuf`
+ * @category Simple API
+ */
+export function writeSkippableFrame(
+  dstBuf: Uint8Array,
+  srcBuf: Uint8Array,
+  magicVariant: number,
+): number;
+
+/**
+ * Reads the contents of the skippable frame at the start of `srcBuf` into
+ * `dstBuf`.
+ *
+ * Wraps `ZSTD_readSkippableFrame`.
+ *
+ * @param dstBuf - Output buffer for the contents
+ * @param srcBuf - Buffer starting with a complete skippable frame
+ * @returns Size of the contents, and the magic number variant of the frame
+ * @category Simple API
+ */
+export function readSkippableFrame(
+  dstBuf: Uint8Array,
+  srcBuf: Uint8Array,
+): [number, number];
+
 /**
  * Returns worst-case maximum compressed size for an input of `srcSize` bytes.
  *
@@ -706,3 +1779,215 @@ export function getDictIDFromDict(dictBuf: Uint8Array): number;
  * @category Dictionary
  */
 export function getDictIDFromFrame(frameBuf: Uint8Array): number;
+
+/**
+ * Parameters shared by the dictionary builder functions.
+ *
+ * Corresponds to `ZDICT_params_t`.
+ *
+ * @category Dictionary
+ */
+export interface DictionaryParameters {
+  /**
+   * Compression level the dictionary will be used with, which is used to tune
+   * its entropy tables. Zero (the default) means the default level.
+   */
+  compressionLevel?: number | undefined;
+  /** Dictionary ID to use, or zero (the default) for a random ID. */
+  dictID?: number | undefined;
+}
+
+/**
+ * Parameters for the COVER dictionary training algorithm.
+ *
+ * Zero (the default) for `k`, `d`, or `steps` lets the optimizer search for a
+ * suitable value. See `ZDICT_cover_params_t` for a full description.
+ *
+ * @category Dictionary
+ */
+export interface CoverParameters extends DictionaryParameters {
+  /** Segment size */
+  k?: number | undefined;
+  /** Dmer size */
+  d?: number | undefined;
+  /** Number of steps to try when searching for `k` */
+  steps?: number | undefined;
+  /** Number of threads to train with */
+  nbThreads?: number | undefined;
+  /** Fraction of samples used for training, with the rest used for testing */
+  splitPoint?: number | undefined;
+  /** Try smaller dictionaries, and use them if they're nearly as good */
+  shrinkDict?: boolean | undefined;
+  /** Maximum ratio regression (in percent) allowed when shrinking */
+  shrinkDictMaxRegression?: number | undefined;
+}
+
+/**
+ * Parameters for the fast COVER dictionary training algorithm.
+ *
+ * See `ZDICT_fastCover_params_t` for a full description.
+ *
+ * @category Dictionary
+ */
+export interface FastCoverParameters extends CoverParameters {
+  /** Log of the size of the frequency array */
+  f?: number | undefined;
+  /** Acceleration level, trading dictionary quality for speed */
+  accel?: number | undefined;
+}
+
+/**
+ * Result of {@link optimizeTrainFromBufferCover}.
+ *
+ * @category Dictionary
+ */
+export interface CoverResult {
+  /** Size of the dictionary written to `dictBuf` */
+  dictSize: number;
+  /** Segment size selected by the optimizer */
+  k: number;
+  /** Dmer size selected by the optimizer */
+  d: number;
+  /** Number of steps used */
+  steps: number;
+  /** Split point used */
+  splitPoint: number;
+}
+
+/**
+ * Result of {@link optimizeTrainFromBufferFastCover}.
+ *
+ * @category Dictionary
+ */
+export interface FastCoverResult extends CoverResult {
+  /** Log of the size of the frequency array used */
+  f: number;
+  /** Acceleration level used */
+  accel: number;
+}
+
+/**
+ * Trains a dictionary from `samplesBuf`, writing it to `dictBuf`.
+ *
+ * The samples are stored back-to-back in `samplesBuf`, with their sizes in
+ * `sampleSizes`. The size of `dictBuf` is the maximum size of the dictionary.
+ *
+ * Wraps `ZDICT_trainFromBuffer`, which runs on the libuv threadpool. The
+ * buffers are kept alive for the duration of the operation, but their contents
+ * must not be accessed, and their underlying `ArrayBuffer`s must not be
+ * transferred or detached.
+ *
+ * @param dictBuf - Output buffer for the dictionary
+ * @param samplesBuf - Training samples
+ * @param sampleSizes - Size of each sample in `samplesBuf`
+ * @returns Promise resolving to the size of the dictionary written to
+ * `dictBuf`
+ * @category Dictionary
+ */
+export function trainFromBuffer(
+  dictBuf: Uint8Array,
+  samplesBuf: Uint8Array,
+  sampleSizes: Uint32Array,
+): Promise<number>;
+
+/**
+ * Trains a dictionary with the COVER algorithm, tuning any unset parameters.
+ *
+ * Works like {@link trainFromBuffer}, but with control over the training
+ * parameters, including multi-threaded training. Slower than
+ * {@link optimizeTrainFromBufferFastCover}, but may produce slightly better
+ * dictionaries.
+ *
+ * Wraps `ZDICT_optimizeTrainFromBuffer_cover`.
+ *
+ * @param dictBuf - Output buffer for the dictionary
+ * @param samplesBuf - Training samples
+ * @param sampleSizes - Size of each sample in `samplesBuf`
+ * @param params - Training parameters
+ * @returns Promise resolving to the dictionary size and selected parameters
+ * @category Dictionary
+ */
+export function optimizeTrainFromBufferCover(
+  dictBuf: Uint8Array,
+  samplesBuf: Uint8Array,
+  sampleSizes: Uint32Array,
+  params: CoverParameters,
+): Promise<CoverResult>;
+
+/**
+ * Trains a dictionary with the fast COVER algorithm, tuning any unset
+ * parameters.
+ *
+ * Works like {@link trainFromBuffer} (which uses this algorithm with default
+ * parameters), but with control over the training parameters, including
+ * multi-threaded training.
+ *
+ * Wraps `ZDICT_optimizeTrainFromBuffer_fastCover`.
+ *
+ * @param dictBuf - Output buffer for the dictionary
+ * @param samplesBuf - Training samples
+ * @param sampleSizes - Size of each sample in `samplesBuf`
+ * @param params - Training parameters
+ * @returns Promise resolving to the dictionary size and selected parameters
+ * @category Dictionary
+ */
+export function optimizeTrainFromBufferFastCover(
+  dictBuf: Uint8Array,
+  samplesBuf: Uint8Array,
+  sampleSizes: Uint32Array,
+  params: FastCoverParameters,
+): Promise<FastCoverResult>;
+
+/**
+ * Builds a dictionary from raw content, writing it to `dictBuf`.
+ *
+ * Adds a header and entropy tables (computed from the samples) to
+ * `contentBuf`, which should contain the data most likely to be seen in
+ * compressed inputs. If `dictBuf` is too small for all of it, content is
+ * dropped from the start of `contentBuf`.
+ *
+ * Wraps `ZDICT_finalizeDictionary`, which runs on the libuv threadpool with the
+ * same restrictions as {@link trainFromBuffer}.
+ *
+ * @param dictBuf - Output buffer for the dictionary
+ * @param contentBuf - Dictionary content
+ * @param samplesBuf - Samples
+ * @param sampleSizes - Size of each sample in `samplesBuf`
+ * @param params - Dictionary parameters
+ * @returns Promise resolving to the size of the dictionary written to
+ * `dictBuf`
+ * @category Dictionary
+ */
+export function finalizeDictionary(
+  dictBuf: Uint8Array,
+  contentBuf: Uint8Array,
+  samplesBuf: Uint8Array,
+  sampleSizes: Uint32Array,
+  params: DictionaryParameters,
+): Promise<number>;
+
+/**
+ * Enables or disables collection of usage statistics, process-wide.
+ *
+ * Statistics are disabled by default. While enabled, every (de)compression call
+ * on a {@link CCtx} or {@link DCtx}, or through the pooled functions, is timed
+ * and counted, which adds a small overhead to each call.
+ *
+ * @param enabled - Whether to collect statistics
+ * @category Statistics
+ */
+export function setStatsEnabled(enabled: boolean): void;
+
+/**
+ * Returns usage counters aggregated over the whole process (including worker
+ * threads).
+ *
+ * The array holds compression counters indexed by {@link Stat}, followed by
+ * decompression counters starting at half its length. Pooled calls (such as
+ * {@link compressPooled}) count towards these totals. Peak memory is the
+ * largest seen by any one context.
+ *
+ * @returns A new array of counters
+ * @category Statistics
+ */
+export function getStats(): Float64Array;
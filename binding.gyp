@@ -2,7 +2,7 @@
   'variables': {
     'copy_licenses': 0,
     'enable_gcov': 0,
-    'napi_build_version': 3,
+    'napi_build_version': 8,
     'conditions': [
       ['OS!="win"', {
         'enable_gcov': '<!(echo $ZSTD_NAPI_ENABLE_GCOV)',
@@ -13,7 +13,7 @@
     {
       'target_name': 'binding',
       'includes': ['build_flags.gypi'],
-      'sources': ['src/binding.cc', 'src/cctx.cc', 'src/cdict.cc', 'src/constants.cc', 'src/dctx.cc', 'src/ddict.cc'],
+      'sources': ['src/binding.cc', 'src/cctx.cc', 'src/cdict.cc', 'src/constants.cc', 'src/context_pool.cc', 'src/dctx.cc', 'src/ddict.cc', 'src/dict_builder.cc', 'src/dict_registry.cc', 'src/files.cc', 'src/frames.cc', 'src/parallel.cc', 'src/seekable.cc', 'src/stats.cc', 'src/thread_pool.cc'],
       'dependencies': ['deps/zstd.gyp:libzstd'],
       'include_dirs': ["<!(node -p \"require('node-addon-api').include_dir\")"],
       'defines': [
@@ -24,6 +24,9 @@
         'NODE_API_SWALLOW_UNTHROWABLE_EXCEPTIONS',
         # Prevent using external buffers, which would break on Electron
         'NODE_API_NO_EXTERNAL_BUFFERS_ALLOWED',
+        # Needed for the experimental APIs used by some bindings (libzstd is
+        # statically linked, so they're always available)
+        'ZSTD_STATIC_LINKING_ONLY',
       ],
       'cflags+': ['-fvisibility=hidden'],
       'cflags!': ['-fno-exceptions'],
@@ -32,10 +32,15 @@
         'zstd/lib/decompress/zstd_ddict.c',
         'zstd/lib/decompress/zstd_decompress_block.c',
         'zstd/lib/decompress/zstd_decompress.c',
+        'zstd/lib/dictBuilder/cover.c',
+        'zstd/lib/dictBuilder/divsufsort.c',
+        'zstd/lib/dictBuilder/fastcover.c',
+        'zstd/lib/dictBuilder/zdict.c',
       ],
       'cflags+': ['-fvisibility=hidden'],
       'defines': [
         'XXH_NAMESPACE=ZSTD_',
+        'ZDICTLIB_VISIBLE=',
         'ZSTDERRORLIB_VISIBLE=',
         'ZSTDLIB_VISIBLE=',
         'ZSTD_MULTITHREAD',
@@ -2,7 +2,17 @@ import { strict as assert } from 'assert';
 import { Transform, TransformCallback } from 'stream';
 
 import binding = require('../binding');
-import { mapBoolean, mapEnum, mapNumber, mapParameters } from './util';
+import {
+  compressBound,
+  CompressScratch,
+  mapBoolean,
+  mapEnum,
+  mapNumber,
+  mapParameters,
+  OutputSlab,
+  packParameters,
+  trimBuffer,
+} from './util';
 
 /**
  * Zstandard compression parameters.
@@ -40,6 +50,8 @@ export interface CompressParameters {
   strategy?: keyof typeof binding.Strategy | undefined;
   /** @category Advanced compression options */
   targetCBlockSize?: number | undefined;
+  /** @category Advanced compression options */
+  maxBlockSize?: number | undefined;
 
   // Long-distance matching options
   /** @category Long-distance matching */
@@ -62,12 +74,50 @@ export interface CompressParameters {
   dictIDFlag?: boolean | undefined;
 
   // Multi-threading parameters
-  /** @category Multi-threading parameters */
+  /**
+   * Number of worker jobs to compress with in parallel.
+   *
+   * The jobs of every high-level compressor ({@link Compressor},
+   * {@link CompressStream}, the Web Streams classes, and functions like
+   * {@link compress} and {@link compressFile}) run on a single process-wide
+   * thread pool, sized to the number of CPU cores, rather than each compressor
+   * starting threads of its own.
+   *
+   * @category Multi-threading parameters
+   */
   nbWorkers?: number | undefined;
   /** @category Multi-threading parameters */
   jobSize?: number | undefined;
   /** @category Multi-threading parameters */
   overlapLog?: number | undefined;
+
+  // Sequence compression parameters
+  /** @category Sequence compression parameters */
+  blockDelimiters?: keyof typeof binding.SequenceFormat | undefined;
+  /** @category Sequence compression parameters */
+  validateSequences?: boolean | undefined;
+  /** @category Sequence compression parameters */
+  enableSeqProducerFallback?: boolean | undefined;
+
+  // Buffer stability parameters
+  /**
+   * Promise to pass the same input buffer to every streaming call.
+   *
+   * Only useful with {@link binding.CCtx.compressStream2Into}; the high-level
+   * compressors either compress in a single call, where this is implied, or
+   * stream from separate buffers, where it makes compression fail.
+   *
+   * @category Buffer stability parameters
+   */
+  stableInBuffer?: boolean | undefined;
+  /**
+   * Promise to pass the same output buffer to every streaming call.
+   *
+   * See {@link stableInBuffer} for caveats.
+   *
+   * @category Buffer stability parameters
+   */
+  stableOutBuffer?: boolean | undefined;
 }
 
 const PARAM_MAPPERS = {
@@ -82,6 +132,7 @@ const PARAM_MAPPERS = {
   targetLength: mapNumber,
   strategy: mapEnum(binding.Strategy),
   targetCBlockSize: mapNumber,
+  maxBlockSize: mapNumber,
 
   // Long-distance matching options
   enableLongDistanceMatching: mapBoolean,
@@ -99,9 +150,167 @@ const PARAM_MAPPERS = {
   nbWorkers: mapNumber,
   jobSize: mapNumber,
   overlapLog: mapNumber,
+
+  // Sequence compression parameters
+  blockDelimiters: mapEnum(binding.SequenceFormat),
+  validateSequences: mapBoolean,
+  enableSeqProducerFallback: mapBoolean,
+
+  // Buffer stability parameters
+  stableInBuffer: mapBoolean,
+  stableOutBuffer: mapBoolean,
 };
 
-function updateCCtxParameters(
+/**
+ * A dictionary for compression, either as raw bytes or prepared.
+ *
+ * Prepared dictionaries ({@link binding.CDict}) are shared across the whole
+ * process, so they're much cheaper to load into many compressors. Their
+ * compression level overrides the `compressionLevel` parameter.
+ */
+export type CompressDictionary = Uint8Array | binding.CDict;
+
+/**
+ * Options for {@link CompressStream}.
+ */
+export interface CompressStreamOptions {
+  /** Dictionary to compress with. */
+  dictionary?: CompressDictionary | undefined;
+  /**
+   * Adjust the compression level as the stream runs, like `zstd --adapt`.
+   *
+   * Each time a new job starts, the level rises when the output is backed up
+   * or compression keeps up with the input easily, and drops when compression
+   * is holding up the input. The `compressionLevel` parameter sets the
+   * starting level.
+   *
+   * The level can only change mid-frame with multithreaded compression, so
+   * `nbWorkers` defaults to 1 with this option, and must not be 0.
+   */
+  adaptiveLevel?: AdaptiveLevelOptions | undefined;
+  /**
+   * Run compression on the libuv threadpool instead of the main thread.
+   *
+   * The event loop then only hands chunks over and collects the output, so
+   * it stays responsive while large inputs are compressed, even when
+   * multithreaded compression blocks on flushes and frame ends. Each call
+   * costs a thread hop, so this is slower for small chunks.
+   */
+  offload?: boolean | undefined;
+}
+
+/**
+ * Bounds for {@link CompressStreamOptions.adaptiveLevel}.
+ */
+export interface AdaptiveLevelOptions {
+  /** Lowest compression level to drop to. Defaults to 1. */
+  minLevel?: number | undefined;
+  /**
+   * Highest compression level to rise to. Defaults to
+   * {@link binding.maxCLevel}.
+   */
+  maxLevel?: number | undefined;
+}
+
+/**
+ * Picks compression levels for {@link CompressStreamOptions.adaptiveLevel}.
+ *
+ * Follows the heuristics of `zstd --adapt`, reconsidering the level once per
+ * new job, after every worker has had a chance to start one.
+ *
+ * @internal
+ */
+export class LevelController {
+  level: number;
+  private readonly minLevel: number;
+  private readonly maxLevel: number;
+  private readonly warmupJobs: number;
+  private lastJobID = 0;
+  private inputPresented = 0;
+  private inputBlocked = 0;
+  private outputBlocked = false;
+
+  constructor(level: number, nbWorkers: number, options: AdaptiveLevelOptions) {
+    const { minLevel = 1, maxLevel = binding.maxCLevel() } = options;
+    if (minLevel > maxLevel) {
+      throw new RangeError('minLevel must not be greater than maxLevel');
+    }
+    this.minLevel = minLevel;
+    this.maxLevel = maxLevel;
+    this.level = Math.min(Math.max(level, minLevel), maxLevel);
+    this.warmupJobs = nbWorkers + 1;
+  }
+
+  /** Records a call given input, and whether it left some unconsumed. */
+  presentInput(blocked: boolean): void {
+    this.inputPresented++;
+    if (blocked) this.inputBlocked++;
+  }
+
+  /** Records that the readable side wants no more output for now. */
+  blockOutput(): void {
+    this.outputBlocked = true;
+  }
+
+  /**
+   * Returns the level to switch to, or `undefined` to keep the current one.
+   */
+  update(progression: binding.FrameProgression): number | undefined {
+    const { currentJobID } = progression;
+    if (currentJobID <= this.lastJobID) return undefined;
+    this.lastJobID = currentJobID;
+    const { inputPresented, inputBlocked, outputBlocked } = this;
+    this.inputPresented = 0;
+    this.inputBlocked = 0;
+    this.outputBlocked = false;
+    if (currentJobID <= this.warmupJobs) return undefined;
+
+    let level = this.level;
+    if (outputBlocked || inputBlocked === 0) {
+      // Spend spare time on compressing better, as either the output can't
+      // take any more or the input can't supply any more
+      level++;
+    } else if (inputBlocked > inputPresented / 8) {
+      // Compression is often too slow to take the input it's given
+      level--;
+    }
+    level = Math.min(Math.max(level, this.minLevel), this.maxLevel);
+    if (level === this.level) return undefined;
+    this.level = level;
+    return level;
+  }
+}
+
+/**
+ * Loads `dictionary` into `cctx`.
+ *
+ * @internal
+ */
+export function loadCCtxDictionary(
+  cctx: binding.CCtx,
+  dictionary: CompressDictionary,
+): void {
+  if (dictionary instanceof binding.CDict) {
+    cctx.refCDict(dictionary);
+  } else {
+    cctx.loadDictionary(dictionary);
+  }
+}
+
+let sharedThreadPool: binding.ThreadPool | undefined;
+
+function getSharedThreadPool(): binding.ThreadPool {
+  // Also used natively by the pooled contexts behind compress and friends
+  sharedThreadPool ??= new binding.ThreadPool();
+  return sharedThreadPool;
+}
+
+/**
+ * Applies `parameters` to `cctx`.
+ *
+ * @internal
+ */
+export function updateCCtxParameters(
   cctx: binding.CCtx,
   parameters: CompressParameters,
 ): void {
@@ -109,6 +318,109 @@ function updateCCtxParameters(
   for (const [param, value] of mapped) {
     cctx.setParameter(param, value);
   }
+  const nbWorkers = mapped.get(binding.CParameter.nbWorkers);
+  if (nbWorkers !== undefined && nbWorkers > 0) {
+    cctx.refThreadPool(getSharedThreadPool());
+  }
+}
+
+/**
+ * Maps `parameters` to the packed form used by pooled contexts.
+ *
+ * @internal
+ */
+export function packCompressParameters(
+  parameters: CompressParameters,
+): Int32Array {
+  return packParameters(
+    mapParameters(binding.CParameter, PARAM_MAPPERS, parameters),
+  );
+}
+
+/**
+ * Options for {@link prepareCompressDictionary}.
+ */
+export interface PrepareDictionaryOptions {
+  /**
+   * Reference the dictionary content in place instead of copying it.
+   *
+   * Saves memory for large dictionaries. The content buffer is kept alive as
+   * long as the dictionary is, but must not be modified, and its underlying
+   * `ArrayBuffer` must not be transferred or detached.
+   */
+  byReference?: boolean | undefined;
+}
+
+/**
+ * Prepare a dictionary for compression, tuned with the given parameters.
+ *
+ * The returned dictionary can be loaded into any number of compressors (see
+ * {@link Compressor.loadDictionary} and {@link CompressStreamOptions}), which
+ * will share it. Its parameters (such as `windowLog` or `strategy`) override
+ * those set on the compressors it's loaded into.
+ *
+ * @example
+ * ```
+ * const cdict = prepareCompressDictionary(dictData, {
+ *   compressionLevel: 19,
+ *   windowLog: 24,
+ * });
+ * const cmp = new Compressor();
+ * cmp.loadDictionary(cdict);
+ * ```
+ *
+ * @param data - Dictionary content
+ * @param parameters - Compression parameters to tune the dictionary for
+ * @param options - Dictionary options
+ * @returns The prepared dictionary
+ */
+export function prepareCompressDictionary(
+  data: Uint8Array,
+  parameters: CompressParameters = {},
+  options: PrepareDictionaryOptions = {},
+): binding.CDict {
+  return new binding.CDict(
+    data,
+    packCompressParameters(parameters),
+    options.byReference ?? false,
+  );
+}
+
+interface Batch {
+  dest: Buffer;
+  src: Buffer;
+  srcOffsets: Uint32Array;
+  dstOffsets: Uint32Array;
+}
+
+/** Packs `buffers` into the arena format used by `CCtx.compressBatch`. */
+function prepareBatch(buffers: readonly Uint8Array[]): Batch {
+  const srcOffsets = new Uint32Array(buffers.length + 1);
+  let total = 0;
+  buffers.forEach((buf, i) => {
+    total += buf.length;
+    srcOffsets[i + 1] = total;
+  });
+  // Each frame needs at most compressBound of its own input, and that sum is
+  // bounded by this, without needing another pass over the inputs
+  const destLen = compressBound(total) + buffers.length * compressBound(0);
+  return {
+    dest: Buffer.allocUnsafe(destLen),
+    src: Buffer.concat(buffers, total),
+    srcOffsets,
+    dstOffsets: new Uint32Array(buffers.length + 1),
+  };
+}
+
+/** Splits the output of `CCtx.compressBatch` into one Buffer per frame. */
+function finishBatch(batch: Batch, length: number): Buffer[] {
+  const { dstOffsets } = batch;
+  const dest = trimBuffer(batch.dest, length);
+  const result = new Array<Buffer>(dstOffsets.length - 1);
+  for (let i = 0; i < result.length; i++) {
+    result[i] = dest.subarray(dstOffsets[i], dstOffsets[i + 1]);
+  }
+  return result;
 }
 
 /**
@@ -130,8 +442,7 @@ function updateCCtxParameters(
  */
 export class Compressor {
   private cctx = new binding.CCtx();
-  private scratchBuf: Buffer | null = null;
-  private scratchLen = -1;
+  private scratch = new CompressScratch();
 
   /**
    * Compress the data in `buffer` with the configured dictionary/parameters.
@@ -140,39 +451,122 @@ export class Compressor {
    * @returns A new Buffer containing the compressed data
    */
   compress(buffer: Uint8Array): Buffer {
-    let dest: Buffer;
-    if (this.scratchBuf && buffer.length <= this.scratchLen) {
-      dest = this.scratchBuf;
-    } else {
-      dest = Buffer.allocUnsafe(binding.compressBound(buffer.length));
-    }
+    return this.scratch.compress(buffer, (dest) =>
+      this.cctx.compress2(dest, buffer),
+    );
+  }
 
-    const length = this.cctx.compress2(dest, buffer);
-    let result;
-    if (length < 0.75 * dest.length) {
-      // Destination buffer is too wasteful, trim by copying
-      result = Buffer.from(dest.subarray(0, length));
+  /**
+   * Asynchronously compress the data in `buffer` with the configured
+   * dictionary/parameters.
+   *
+   * Compression runs on the libuv threadpool instead of blocking the event
+   * loop. Until the returned promise settles, no other methods may be called on
+   * this compressor, and the contents of `buffer` must not be modified.
+   *
+   * @param buffer - Data to compress
+   * @returns A promise resolving to a new Buffer containing the compressed data
+   */
+  async compressAsync(buffer: Uint8Array): Promise<Buffer> {
+    // The scratch buffer can't be shared with an operation running in the
+    // background, so always allocate a fresh destination buffer
+    const dest = Buffer.allocUnsafe(compressBound(buffer.length));
+    const length = await this.cctx.compress2Async(dest, buffer);
+    return trimBuffer(dest, length);
+  }
 
-      // Save the old buffer for scratch if it's small enough
-      if (dest.length <= 128 * 1024 && buffer.length > this.scratchLen) {
-        this.scratchBuf = dest;
-        this.scratchLen = buffer.length;
-      }
-    } else {
-      // Destination buffer is about the right size, return it directly
-      result = dest.subarray(0, length);
-
-      // Make sure we don't re-use the scratch buffer if we're returning it
-      if (Object.is(dest, this.scratchBuf)) {
-        this.scratchBuf = null;
-        this.scratchLen = -1;
-      }
-    }
-    return result;
+  /**
+   * Compress the data in `buffer` using the matches described by `sequences`.
+   *
+   * Skips the search for matches, so this is much faster than {@link compress}
+   * when the caller already knows where the repetition in its data is (for
+   * instance, from a deduplication index). See
+   * {@link binding.CCtx.compressSequences} for the format of `sequences`.
+   *
+   * @param sequences - Packed sequences describing `buffer`
+   * @param buffer - Data to compress
+   * @returns A new Buffer containing the compressed data
+   */
+  compressSequences(sequences: Uint32Array, buffer: Uint8Array): Buffer {
+    const dest = Buffer.allocUnsafe(compressBound(buffer.length));
+    const length = this.cctx.compressSequences(dest, sequences, buffer);
+    return trimBuffer(dest, length);
   }
 
   /**
-   * Load a compression dictionary from the provided buffer.
+   * Asynchronous version of {@link compressSequences}.
+   *
+   * Compression runs on the libuv threadpool, with the same restrictions as
+   * {@link compressAsync}, which also apply to `sequences`.
+   *
+   * @param sequences - Packed sequences describing `buffer`
+   * @param buffer - Data to compress
+   * @returns A promise resolving to a new Buffer containing the compressed data
+   */
+  async compressSequencesAsync(
+    sequences: Uint32Array,
+    buffer: Uint8Array,
+  ): Promise<Buffer> {
+    const dest = Buffer.allocUnsafe(compressBound(buffer.length));
+    const length = await this.cctx.compressSequencesAsync(
+      dest,
+      sequences,
+      buffer,
+    );
+    return trimBuffer(dest, length);
+  }
+
+  /**
+   * Compress each buffer in `buffers` into its own Zstandard frame.
+   *
+   * This produces the same output as calling {@link compress} on each buffer,
+   * but is much faster for large numbers of small buffers since all of the
+   * work is done in a single native call.
+   *
+   * The returned buffers share a single underlying allocation, so retaining
+   * any one of them keeps the memory for all of them alive.
+   *
+   * @param buffers - Data to compress
+   * @returns An array of new Buffers containing the compressed data
+   */
+  compressBatch(buffers: readonly Uint8Array[]): Buffer[] {
+    if (buffers.length === 0) return [];
+    const batch = prepareBatch(buffers);
+    const length = this.cctx.compressBatch(
+      batch.dest,
+      batch.src,
+      batch.srcOffsets,
+      batch.dstOffsets,
+    );
+    return finishBatch(batch, length);
+  }
+
+  /**
+   * Asynchronous version of {@link compressBatch}.
+   *
+   * Compression runs on the libuv threadpool, with the same restrictions as
+   * {@link compressAsync}. The inputs are copied before this method returns,
+   * so they may be modified freely afterwards.
+   *
+   * @param buffers - Data to compress
+   * @returns A promise resolving to an array of new Buffers containing the
+   * compressed data
+   */
+  async compressBatchAsync(buffers: readonly Uint8Array[]): Promise<Buffer[]> {
+    if (buffers.length === 0) return [];
+    const batch = prepareBatch(buffers);
+    const length = await this.cctx.compressBatchAsync(
+      batch.dest,
+      batch.src,
+      batch.srcOffsets,
+      batch.dstOffsets,
+    );
+    return finishBatch(batch, length);
+  }
+
+  /**
+   * Load a compression dictionary from the provided buffer or prepared
+   * dictionary.
    *
    * The loaded dictionary will be used for all future {@link compress} calls
    * until removed or replaced. Passing an empty buffer to this function will
@@ -181,11 +575,11 @@ export class Compressor {
    * Set any parameters you want to set before loading a dictionary, since
    * parameters can't be changed while a dictionary is loaded.
    */
-  loadDictionary(data: Uint8Array): void {
+  loadDictionary(data: CompressDictionary): void {
     // TODO: Compression parameters get locked in on next compress operation,
     // and are cleared by setParameters. There should be some checks to ensure
     // users have a safe usage pattern.
-    this.cctx.loadDictionary(data);
+    loadCCtxDictionary(this.cctx, data);
   }
 
   /**
@@ -214,6 +608,8 @@ const BUF_SIZE = binding.cStreamOutSize();
 
 const dummyFlushBuffer = Buffer.alloc(0);
 const dummyEndBuffer = Buffer.alloc(0);
+// Skippable frames queued by CompressStream.writeMetadata
+const metadataFrames = new WeakSet<Buffer>();
 
 /**
  * High-level interface for streaming Zstandard compression.
@@ -221,6 +617,12 @@ const dummyEndBuffer = Buffer.alloc(0);
  * Implements the standard Node stream transformer interface, so can be used
  * with `.pipe` or any other streaming interface.
  *
+ * After each chunk is compressed, emits a `'progress'` event with the
+ * {@link binding.FrameProgression | progress} of the current frame. With
+ * `nbWorkers` set, this shows how much input is still queued in worker threads,
+ * which can drive back-pressure and rate decisions. Progress is only queried
+ * while the event has listeners.
+ *
  * @example Basic usage
  * ```
  * import { pipeline } from 'stream/promises';
@@ -234,30 +636,60 @@ const dummyEndBuffer = Buffer.alloc(0);
  */
 export class CompressStream extends Transform {
   private cctx = new binding.CCtx();
-  private buffer = Buffer.allocUnsafe(BUF_SIZE);
+  private output = new OutputSlab(BUF_SIZE);
+  private result = new Float64Array(3);
+  private levelController: LevelController | undefined;
+  private inFrame = false;
+  private afterMetadata = false;
+  private readonly offload: boolean;
 
-  // TODO: Allow user to specify a dictionary
   /**
    * Create a new streaming compressor with the specified parameters.
    *
    * @param parameters - Compression parameters
+   * @param options - Stream options
    */
-  constructor(parameters: CompressParameters = {}) {
+  constructor(
+    parameters: CompressParameters = {},
+    options: CompressStreamOptions = {},
+  ) {
     // TODO: autoDestroy doesn't really work on Transform, we should consider
     // calling .destroy ourselves when necessary.
     super({ autoDestroy: true });
+    const { adaptiveLevel } = options;
+    if (adaptiveLevel !== undefined) {
+      const { compressionLevel, nbWorkers = 1 } = parameters;
+      if (nbWorkers < 1) {
+        throw new RangeError('adaptiveLevel requires nbWorkers of at least 1');
+      }
+      this.levelController = new LevelController(
+        compressionLevel || binding.defaultCLevel(),
+        nbWorkers,
+        adaptiveLevel,
+      );
+      parameters = {
+        ...parameters,
+        compressionLevel: this.levelController.level,
+        nbWorkers,
+      };
+    }
     updateCCtxParameters(this.cctx, parameters);
+    if (options.dictionary !== undefined) {
+      loadCCtxDictionary(this.cctx, options.dictionary);
+    }
+    this.offload = options.offload ?? false;
   }
 
-  // TODO: Provide API to allow changing parameters mid-frame in MT mode
+  // TODO: Provide API to allow changing other parameters mid-frame in MT mode
   // TODO: Provide API to allow changing parameters between frames
 
   /**
    * End the current Zstandard frame without ending the stream.
    *
-   * Frames are compressed independently, so this can be used to create a
-   * "seekable" archive, or to provide more resilience to data corruption by
-   * isolating parts of the file from each other.
+   * Frames are compressed independently, so this can be used to provide more
+   * resilience to data corruption by isolating parts of the file from each
+   * other. To create an archive that supports random access, use
+   * {@link SeekableCompressStream} instead.
    *
    * The optional `callback` is invoked with the same semantics as it is for a
    * a stream write.
@@ -279,41 +711,129 @@ export class CompressStream extends Transform {
     this.write(dummyFlushBuffer, callback);
   }
 
+  /**
+   * Write `data` to the stream as a skippable frame.
+   *
+   * Ends the current Zstandard frame, if any, then writes a skippable frame
+   * with the given magic number variant (0 to 15). Decompressors pass over
+   * skippable frames, so they can carry application metadata such as indexes
+   * or checksums alongside the compressed data. Use the `skippableFrames`
+   * option of {@link DecompressStream} to read them back.
+   *
+   * The optional `callback` is invoked with the same semantics as it is for a
+   * a stream write.
+   */
+  writeMetadata(
+    magicVariant: number,
+    data: Uint8Array,
+    callback?: (error?: Error | null) => void,
+  ): void {
+    const frame = Buffer.allocUnsafe(data.length + binding.SKIPPABLEHEADERSIZE);
+    binding.writeSkippableFrame(frame, data, magicVariant);
+    metadataFrames.add(frame);
+    this.write(frame, callback);
+  }
+
+  /**
+   * Report how far compression of the current frame has progressed.
+   *
+   * Wraps {@link binding.CCtx.getFrameProgression}. With the `offload`
+   * option, this throws while a chunk is being compressed; listen for
+   * `'progress'` events instead.
+   */
+  getFrameProgression(): binding.FrameProgression {
+    return this.cctx.getFrameProgression();
+  }
+
+  private emitProgress(): void {
+    // Querying progress isn't free, so skip it if nobody is listening
+    if (this.listenerCount('progress') > 0) {
+      this.emit('progress', this.cctx.getFrameProgression());
+    }
+  }
+
+  private adaptLevel(): void {
+    const { levelController } = this;
+    if (levelController === undefined) return;
+    const level = levelController.update(this.cctx.getFrameProgression());
+    if (level !== undefined) {
+      this.cctx.setParameter(binding.CParameter.compressionLevel, level);
+    }
+  }
+
   private doCompress(chunk: Buffer, endType: binding.EndDirective): void {
-    const flushing = endType !== binding.EndDirective.continue;
+    const { output, result } = this;
     for (;;) {
-      const [ret, produced, consumed] = this.cctx.compressStream2(
-        this.buffer,
-        chunk,
-        endType,
+      this.cctx.compressStream2Into(output.free, chunk, endType, result);
+      const rest = this.compressed(chunk, endType);
+      if (rest === undefined) break;
+      chunk = rest;
+    }
+    if (endType === binding.EndDirective.end) this.inFrame = false;
+  }
+
+  private async doCompressAsync(
+    chunk: Buffer,
+    endType: binding.EndDirective,
+  ): Promise<void> {
+    const { output, result } = this;
+    for (;;) {
+      result.set(
+        await this.cctx.compressStream2Async(output.free, chunk, endType),
       );
-      if (produced > 0) {
-        this.push(this.buffer.subarray(0, produced));
-        this.buffer = Buffer.allocUnsafe(Math.max(BUF_SIZE, ret));
-      }
-      chunk = chunk.subarray(consumed);
-      if (chunk.length == 0 && (!flushing || ret == 0)) return;
+      const rest = this.compressed(chunk, endType);
+      if (rest === undefined) break;
+      chunk = rest;
     }
+    if (endType === binding.EndDirective.end) this.inFrame = false;
   }
 
-  /** @internal */
-  override _transform(
-    chunk: unknown,
-    _encoding: string,
+  /**
+   * Handles the {@link result} of compressing `chunk`, returning the input
+   * left for the next call, or `undefined` if there's nothing left to do.
+   */
+  private compressed(
+    chunk: Buffer,
+    endType: binding.EndDirective,
+  ): Buffer | undefined {
+    const flushing = endType !== binding.EndDirective.continue;
+    const { output, result, levelController } = this;
+    const ret = result[0] ?? 0;
+    const produced = result[1] ?? 0;
+    const consumed = result[2] ?? 0;
+    if (produced > 0 && !this.push(output.take(produced))) {
+      levelController?.blockOutput();
+    }
+    // A frame is only started once some input is consumed, so empty writes
+    // and flushes between frames don't open one
+    if (consumed > 0) this.inFrame = true;
+    const rest = chunk.subarray(consumed);
+    if (!flushing && chunk.length > 0) {
+      levelController?.presentInput(rest.length > 0);
+    }
+    if (rest.length == 0 && (!flushing || ret == 0)) return undefined;
+    return rest;
+  }
+
+  /**
+   * Compresses `chunk` (if any), on the threadpool if the stream is offloaded,
+   * then calls `after` and `done`.
+   */
+  private run(
+    chunk: Buffer | undefined,
+    endType: binding.EndDirective,
+    after: () => void,
     done: TransformCallback,
   ): void {
+    if (this.offload && chunk !== undefined) {
+      this.doCompressAsync(chunk, endType)
+        .then(after)
+        .then(() => done(), (err: unknown) => done(err as Error));
+      return;
+    }
     try {
-      // The Writable machinery is responsible for converting to a Buffer
-      assert(chunk instanceof Buffer);
-
-      // Handle flushes indicated by special dummy buffers
-      let endType = binding.EndDirective.continue;
-      if (Object.is(chunk, dummyFlushBuffer))
-        endType = binding.EndDirective.flush;
-      else if (Object.is(chunk, dummyEndBuffer))
-        endType = binding.EndDirective.end;
-
-      this.doCompress(chunk, endType);
+      if (chunk !== undefined) this.doCompress(chunk, endType);
+      after();
     } catch (err) {
       done(err as Error);
       return;
@@ -323,14 +843,58 @@ export class CompressStream extends Transform {
   }
 
   /** @internal */
-  override _flush(done: TransformCallback): void {
-    try {
-      this.doCompress(dummyEndBuffer, binding.EndDirective.end);
-    } catch (err) {
-      done(err as Error);
+  override _transform(
+    chunk: unknown,
+    _encoding: string,
+    done: TransformCallback,
+  ): void {
+    // The Writable machinery is responsible for converting to a Buffer
+    assert(chunk instanceof Buffer);
+
+    // Skippable frames go between compressed frames, not inside them
+    if (metadataFrames.has(chunk)) {
+      this.run(
+        this.inFrame ? dummyEndBuffer : undefined,
+        binding.EndDirective.end,
+        () => {
+          this.push(chunk);
+          this.afterMetadata = true;
+          this.emitProgress();
+        },
+        done,
+      );
       return;
     }
-    done();
-    return;
+
+    // Handle flushes indicated by special dummy buffers
+    let endType = binding.EndDirective.continue;
+    if (Object.is(chunk, dummyFlushBuffer))
+      endType = binding.EndDirective.flush;
+    else if (Object.is(chunk, dummyEndBuffer))
+      endType = binding.EndDirective.end;
+
+    this.run(
+      chunk,
+      endType,
+      () => {
+        this.adaptLevel();
+        if (this.inFrame) this.afterMetadata = false;
+        this.emitProgress();
+      },
+      done,
+    );
+  }
+
+  /** @internal */
+  override _flush(done: TransformCallback): void {
+    // Don't follow trailing metadata with an empty frame
+    this.run(
+      this.inFrame || !this.afterMetadata ? dummyEndBuffer : undefined,
+      binding.EndDirective.end,
+      () => {
+        this.emitProgress();
+      },
+      done,
+    );
   }
 }
@@ -1,8 +1,15 @@
 import { strict as assert } from 'assert';
-import { Transform, TransformCallback } from 'stream';
+import { Transform, TransformCallback, Writable } from 'stream';
 
 import binding = require('../binding');
-import { mapNumber, mapParameters } from './util';
+import {
+  mapBoolean,
+  mapNumber,
+  mapParameters,
+  OutputSlab,
+  packParameters,
+  trimBuffer,
+} from './util';
 
 /**
  * Zstandard decompression parameters.
@@ -13,13 +20,115 @@ import { mapNumber, mapParameters } from './util';
  */
 export interface DecompressParameters {
   windowLogMax?: number | undefined;
+  /**
+   * Keep every prepared dictionary loaded, instead of replacing the previous
+   * one, and select the right one for each frame by its dictionary ID.
+   */
+  refMultipleDDicts?: boolean | undefined;
+  /**
+   * Largest block to accept, from 1 KiB up to the default of 128 KiB.
+   *
+   * Lowering it reduces the memory needed for streaming decompression, but
+   * frames must have been compressed with a `maxBlockSize` no larger.
+   */
+  maxBlockSize?: number | undefined;
+  /**
+   * Promise to pass the same output buffer to every streaming call.
+   *
+   * {@link DecompressIntoStream} sets this itself. Other high-level
+   * decompressors move between output buffers, so fail with this set.
+   */
+  stableOutBuffer?: boolean | undefined;
 }
 
 const PARAM_MAPPERS = {
   windowLogMax: mapNumber,
+  refMultipleDDicts: mapBoolean,
+  maxBlockSize: mapNumber,
+  stableOutBuffer: mapBoolean,
 };
 
-function updateDCtxParameters(
+/**
+ * A dictionary for decompression, either as raw bytes or prepared.
+ *
+ * Prepared dictionaries ({@link binding.DDict}) are shared across the whole
+ * process, so they're much cheaper to load into many decompressors.
+ */
+export type DecompressDictionary = Uint8Array | binding.DDict;
+
+/**
+ * Options for {@link DecompressStream}.
+ */
+export interface DecompressStreamOptions {
+  /**
+   * Dictionary to decompress with.
+   *
+   * If an array of prepared dictionaries is given, the right one is selected
+   * for each frame by its dictionary ID.
+   */
+  dictionary?: DecompressDictionary | readonly binding.DDict[] | undefined;
+  /**
+   * Maximum total size of the decompressed output.
+   *
+   * The stream fails with a `RangeError` as soon as its output would exceed
+   * this, without decompressing any further. Useful as a defense against
+   * decompression bombs. Defaults to no limit.
+   */
+  maxOutputSize?: number | undefined;
+  /**
+   * Emit the contents of skippable frames in the input.
+   *
+   * Each skippable frame is reported with a `'skippableFrame'` event, passing
+   * its contents and magic number variant. Without this, skippable frames are
+   * silently passed over. See {@link CompressStream.writeMetadata}.
+   */
+  skippableFrames?: boolean | undefined;
+  /**
+   * Run decompression on the libuv threadpool instead of the main thread.
+   *
+   * The event loop then only hands chunks over and collects the output, so
+   * it stays responsive while large inputs are decompressed. Each call costs
+   * a thread hop, so this is slower for small chunks.
+   */
+  offload?: boolean | undefined;
+}
+
+function loadDCtxDictionary(
+  dctx: binding.DCtx,
+  dictionary: DecompressDictionary,
+): void {
+  if (dictionary instanceof binding.DDict) {
+    dctx.refDDict(dictionary);
+  } else {
+    dctx.loadDictionary(dictionary);
+  }
+}
+
+/**
+ * Loads the `dictionary` stream option into `dctx`.
+ *
+ * @internal
+ */
+export function loadStreamDictionary(
+  dctx: binding.DCtx,
+  dictionary: DecompressStreamOptions['dictionary'],
+): void {
+  if (Array.isArray(dictionary)) {
+    dctx.setParameter(binding.DParameter.refMultipleDDicts, 1);
+    for (const ddict of dictionary as readonly binding.DDict[]) {
+      dctx.refDDict(ddict);
+    }
+  } else if (dictionary !== undefined) {
+    loadDCtxDictionary(dctx, dictionary as DecompressDictionary);
+  }
+}
+
+/**
+ * Applies `parameters` to `dctx`.
+ *
+ * @internal
+ */
+export function updateDCtxParameters(
   dctx: binding.DCtx,
   parameters: DecompressParameters,
 ): void {
@@ -29,20 +138,147 @@ function updateDCtxParameters(
   }
 }
 
-function getTotalContentSize(buffer: Uint8Array): number | null {
-  let result = 0;
-  let frame = buffer;
-  while (frame.length > 0) {
-    const contentSize = binding.getFrameContentSize(frame);
-    if (contentSize === null) return null;
-    result += contentSize;
-    frame = frame.subarray(binding.findFrameCompressedSize(frame));
-  }
-  return result;
+/**
+ * Maps `parameters` to the packed form used by pooled contexts.
+ *
+ * @internal
+ */
+export function packDecompressParameters(
+  parameters: DecompressParameters,
+): Int32Array {
+  return packParameters(
+    mapParameters(binding.DParameter, PARAM_MAPPERS, parameters),
+  );
 }
 
 const BUF_SIZE = binding.dStreamOutSize();
 
+/**
+ * Options for {@link Decompressor.decompress}.
+ */
+export interface DecompressOptions {
+  /**
+   * Expected size of the decompressed data.
+   *
+   * Only used when the input doesn't record its decompressed size, as the
+   * initial size of the output buffer. An accurate hint avoids having to grow
+   * the buffer as decompression proceeds.
+   */
+  sizeHint?: number | undefined;
+  /**
+   * Maximum size of the decompressed data.
+   *
+   * If the data would decompress to anything larger, a `RangeError` is thrown
+   * instead of allocating more memory. Useful as a defense against
+   * decompression bombs. Defaults to no limit.
+   */
+  maxOutputSize?: number | undefined;
+}
+
+/**
+ * Returns the decompressed size of `input` if every frame records it.
+ *
+ * The size is checked against the configured limit, and against what the
+ * frames could actually hold, before the caller allocates anything.
+ *
+ * @internal
+ */
+export function findContentSize(
+  input: Uint8Array,
+  options: DecompressOptions,
+): number | null {
+  const { maxOutputSize = Infinity } = options;
+  return binding.checkDecompressedSize(input, maxOutputSize);
+}
+
+/**
+ * Returns the error for decompressed output going over the caller's
+ * {@link DecompressOptions.maxOutputSize}.
+ *
+ * @internal
+ */
+export function maxOutputSizeError(): RangeError {
+  return new RangeError('Decompressed size exceeds maxOutputSize');
+}
+
+/**
+ * Output buffer for decompressing data of unknown size, which grows as needed.
+ *
+ * Everything is decompressed directly into one buffer, which is only copied
+ * when it has to grow, doubling in size each time. This saves the extra copy of
+ * concatenating separately allocated chunks at the end.
+ */
+class GrowableOutput {
+  private buffer: Buffer;
+  private length = 0;
+  private readonly limit: number;
+  private readonly userLimit: boolean;
+
+  constructor(input: Uint8Array, options: DecompressOptions) {
+    const { maxOutputSize = Infinity } = options;
+    const bound = binding.decompressBound(input);
+    this.limit = Math.min(maxOutputSize, bound);
+    this.userLimit = maxOutputSize <= bound;
+    // Without a hint, the input size is used as a conservative lower bound on
+    // the content size, as a bigger guess may waste memory on small inputs
+    const initial = options.sizeHint ?? Math.max(BUF_SIZE, input.length);
+    this.buffer = Buffer.allocUnsafe(Math.min(this.limit, initial));
+  }
+
+  /** Unused space at the end of the buffer, for more output. */
+  get free(): Buffer {
+    return this.buffer.subarray(this.length);
+  }
+
+  get full(): boolean {
+    return this.length === this.buffer.length;
+  }
+
+  /** Records `produced` more bytes of output written to {@link free}. */
+  advance(produced: number): void {
+    this.length += produced;
+  }
+
+  /** Grows the buffer, keeping the output so far. */
+  grow(): void {
+    if (this.buffer.length >= this.limit) {
+      // Output can only legitimately go over the caller's limit; going over the
+      // bound from the frame headers means they don't match the data
+      if (this.userLimit) throw maxOutputSizeError();
+      throw new Error('Decompressed size exceeds what the frame headers allow');
+    }
+    const size = Math.max(BUF_SIZE, this.buffer.length * 2);
+    const grown = Buffer.allocUnsafe(Math.min(this.limit, size));
+    this.buffer.copy(grown, 0, 0, this.length);
+    this.buffer = grown;
+  }
+
+  /** Returns the output, trimmed to size. */
+  finish(): Buffer {
+    return trimBuffer(this.buffer, this.length);
+  }
+}
+
+/**
+ * Checks whether streaming decompression into `output` is complete, throwing if
+ * the input is truncated.
+ */
+function finishedStreaming(
+  output: GrowableOutput,
+  remainingInput: Uint8Array,
+  ret: number,
+): boolean {
+  if (remainingInput.length > 0 || output.full) {
+    // Unless the last frame has been fully flushed, there's more output to
+    // come, even if all of the input has been consumed
+    return remainingInput.length === 0 && ret === 0;
+  }
+  if (ret !== 0) {
+    throw new Error('Input ended in middle of compressed data frame');
+  }
+  return true;
+}
+
 /**
  * High-level interface for customized single-pass Zstandard decompression.
  *
@@ -66,17 +302,18 @@ export class Decompressor {
   /**
    * Decompress the data in `buffer` with the configured dictionary/parameters.
    *
+   * If every frame in `buffer` records its decompressed size, the result is
+   * allocated up front at exactly the right size. Otherwise, it's decompressed
+   * into a buffer that grows as needed, and
+   * {@link DecompressOptions.sizeHint} can help size it correctly.
+   *
    * @param buffer - Compressed data
+   * @param options - Decompression options
    * @returns A new buffer with the uncompressed data
    */
-  decompress(buffer: Uint8Array): Buffer {
-    // TODO: Default allocation limit, with option to override
-    // TODO: Add a way to supply a known size or size hint
-
-    // Find total uncompressed size of all frames in buffer
-    const contentSize = getTotalContentSize(buffer);
-
+  decompress(buffer: Uint8Array, options: DecompressOptions = {}): Buffer {
     // Fast path if we have a content size
+    const contentSize = findContentSize(buffer, options);
     if (contentSize !== null) {
       const result = Buffer.allocUnsafe(contentSize);
       const decompressedSize = this.dctx.decompress(result, buffer);
@@ -85,40 +322,109 @@ export class Decompressor {
     }
 
     // Fall back to streaming decompression
-    const resultChunks: Buffer[] = [];
+    const output = new GrowableOutput(buffer, options);
     let remainingInput = buffer;
-    while (remainingInput.length > 0) {
-      // With the complete input available, decompressStream will gladly fill
-      // an arbitrarily large buffer. We can exploit this to save native calls
-      // by using the input size as a heuristic lower bound on the content size.
-      //
-      // This is conservative: it won't over-allocate memory by more than the
-      // max of the input length and BUF_SIZE. It doesn't perform well in the
-      // face of extremely high compression ratios, but the worst case is
-      // equivalent to always allocating BUF_SIZE.
-      const chunkLen = Math.max(BUF_SIZE, remainingInput.length);
-      const chunk = Buffer.allocUnsafe(chunkLen);
-      const [, produced, consumed] = this.dctx.decompressStream(
-        chunk,
+    this.dctx.reset(binding.ResetDirective.sessionOnly);
+    for (;;) {
+      // With the complete input available, this fills as much of the output
+      // buffer as it can in one call, however many frames that takes
+      const [ret, produced, consumed] = this.dctx.decompressFrames(
+        output.free,
         remainingInput,
       );
-      resultChunks.push(chunk.subarray(0, produced));
+      output.advance(produced);
       remainingInput = remainingInput.subarray(consumed);
+      if (finishedStreaming(output, remainingInput, ret)) break;
+      output.grow();
+    }
+    return output.finish();
+  }
+
+  /**
+   * Asynchronously decompress the data in `buffer` with the configured
+   * dictionary/parameters.
+   *
+   * Decompression runs on the libuv threadpool instead of blocking the event
+   * loop. Until the returned promise settles, no other methods may be called on
+   * this decompressor, and the contents of `buffer` must not be modified.
+   *
+   * @param buffer - Compressed data
+   * @param options - Decompression options
+   * @returns A promise resolving to a new buffer with the uncompressed data
+   */
+  async decompressAsync(
+    buffer: Uint8Array,
+    options: DecompressOptions = {},
+  ): Promise<Buffer> {
+    // Fast path if we have a content size
+    const contentSize = findContentSize(buffer, options);
+    if (contentSize !== null) {
+      const result = Buffer.allocUnsafe(contentSize);
+      const decompressedSize = await this.dctx.decompressAsync(result, buffer);
+      assert.equal(decompressedSize, contentSize);
+      return result;
     }
 
-    // Concatenate the decompressed chunks (copies everything)
-    return Buffer.concat(resultChunks);
+    // Fall back to streaming decompression, see decompress for details
+    const output = new GrowableOutput(buffer, options);
+    let remainingInput = buffer;
+    this.dctx.reset(binding.ResetDirective.sessionOnly);
+    for (;;) {
+      const [ret, produced, consumed] = await this.dctx.decompressFramesAsync(
+        output.free,
+        remainingInput,
+      );
+      output.advance(produced);
+      remainingInput = remainingInput.subarray(consumed);
+      if (finishedStreaming(output, remainingInput, ret)) break;
+      output.grow();
+    }
+    return output.finish();
   }
 
   /**
-   * Load a compression dictionary from the provided buffer.
+   * Decompress the data in `buffer` directly into `dest`, without allocating.
+   *
+   * `dest` must be large enough to hold all of the uncompressed data, or an
+   * error is thrown.
+   *
+   * @param dest - Buffer to write the uncompressed data into
+   * @param buffer - Compressed data
+   * @returns The number of bytes written to `dest`
+   */
+  decompressInto(dest: Uint8Array, buffer: Uint8Array): number {
+    return this.dctx.decompress(dest, buffer);
+  }
+
+  /**
+   * Asynchronously decompress the data in `buffer` directly into `dest`.
+   *
+   * Works like {@link decompressInto}, but runs on the libuv threadpool. The
+   * same restrictions as {@link decompressAsync} apply, and `dest` must not be
+   * read or modified until the returned promise settles.
+   *
+   * @param dest - Buffer to write the uncompressed data into
+   * @param buffer - Compressed data
+   * @returns A promise resolving to the number of bytes written to `dest`
+   */
+  decompressIntoAsync(dest: Uint8Array, buffer: Uint8Array): Promise<number> {
+    return this.dctx.decompressAsync(dest, buffer);
+  }
+
+  /**
+   * Load a compression dictionary from the provided buffer or prepared
+   * dictionary.
    *
    * The loaded dictionary will be used for all future {@link decompress} calls
    * until removed or replaced. Passing an empty buffer to this function will
    * remove a previously loaded dictionary.
+   *
+   * If the {@link DecompressParameters.refMultipleDDicts} parameter is set,
+   * prepared dictionaries don't replace each other. Instead, each frame is
+   * decompressed with the one matching its dictionary ID.
    */
-  loadDictionary(data: Uint8Array): void {
-    this.dctx.loadDictionary(data);
+  loadDictionary(data: DecompressDictionary): void {
+    loadDCtxDictionary(this.dctx, data);
   }
 
   /**
@@ -142,12 +448,117 @@ export class Decompressor {
   }
 }
 
+const SKIPPABLE_MAGIC_SIZE = 4;
+const EMPTY = Buffer.alloc(0);
+
+function isSkippableMagic(magic: number): boolean {
+  return (
+    (magic & binding.MAGIC_SKIPPABLE_MASK) >>> 0 ===
+    binding.MAGIC_SKIPPABLE_START
+  );
+}
+
+/**
+ * Splits skippable frames off the front of a decompression stream's input,
+ * reassembling them when they span several chunks.
+ */
+class SkippableFrameSplitter {
+  private header = Buffer.alloc(binding.SKIPPABLEHEADERSIZE);
+  private headerLength = 0;
+  private payload: Buffer[] = [];
+  // Negative while not inside a frame's contents
+  private payloadLeft = -1;
+  private magicVariant = 0;
+
+  constructor(
+    private readonly onFrame: (payload: Buffer, magicVariant: number) => void,
+  ) {}
+
+  /** Whether a skippable frame has been started but not finished. */
+  get pending(): boolean {
+    return this.headerLength > 0 || this.payloadLeft >= 0;
+  }
+
+  /**
+   * Consumes skippable frames at the start of `input`, returning the rest.
+   *
+   * The result is empty if all of `input` was consumed, and otherwise starts
+   * with something other than a skippable frame.
+   */
+  split(input: Buffer): Buffer {
+    const { header } = this;
+    for (;;) {
+      if (this.payloadLeft >= 0) {
+        const length = Math.min(this.payloadLeft, input.length);
+        if (length > 0) this.payload.push(input.subarray(0, length));
+        input = input.subarray(length);
+        this.payloadLeft -= length;
+        if (this.payloadLeft > 0) return EMPTY;
+        const { payload } = this;
+        this.payload = [];
+        this.payloadLeft = -1;
+        this.onFrame(
+          payload.length === 1 ? (payload[0] ?? EMPTY) : Buffer.concat(payload),
+          this.magicVariant,
+        );
+        continue;
+      }
+
+      if (this.headerLength === 0) {
+        // Fast path, avoiding copies when the header is within the chunk
+        if (input.length < SKIPPABLE_MAGIC_SIZE) {
+          if (input.length === 0) return input;
+        } else if (!isSkippableMagic(input.readUInt32LE(0))) {
+          return input;
+        } else if (input.length >= header.length) {
+          this.startPayload(input);
+          input = input.subarray(header.length);
+          continue;
+        }
+      }
+
+      // Accumulate a header which was split between chunks
+      const wanted =
+        this.headerLength < SKIPPABLE_MAGIC_SIZE
+          ? SKIPPABLE_MAGIC_SIZE
+          : header.length;
+      const copied = input.copy(
+        header,
+        this.headerLength,
+        0,
+        wanted - this.headerLength,
+      );
+      this.headerLength += copied;
+      input = input.subarray(copied);
+      if (this.headerLength < wanted) return EMPTY;
+      if (!isSkippableMagic(header.readUInt32LE(0))) {
+        const held = Buffer.from(header.subarray(0, this.headerLength));
+        this.headerLength = 0;
+        return Buffer.concat([held, input]);
+      }
+      if (this.headerLength === header.length) {
+        this.startPayload(header);
+        this.headerLength = 0;
+      }
+    }
+  }
+
+  private startPayload(header: Buffer): void {
+    this.magicVariant = header.readUInt32LE(0) - binding.MAGIC_SKIPPABLE_START;
+    this.payloadLeft = header.readUInt32LE(SKIPPABLE_MAGIC_SIZE);
+  }
+}
+
 /**
  * High-level interface for streaming Zstandard decompression.
  *
  * Implements the standard Node stream transformer interface, so can be used
  * with `.pipe` or any other streaming interface.
  *
+ * With the `skippableFrames` option set, emits a `'skippableFrame'` event with
+ * the contents and magic number variant of each skippable frame in the input.
+ * The contents may be a view of an input chunk rather than a copy.
+ *
  * @example Basic usage
  * ```
  * import { pipeline } from 'stream/promises';
@@ -161,18 +572,110 @@ export class Decompressor {
 export class DecompressStream extends Transform {
   private dctx = new binding.DCtx();
   private inFrame = false;
+  private atFrameStart = true;
+  private output = new OutputSlab(BUF_SIZE);
+  private result = new Float64Array(3);
+  private outputLeft: number;
+  private splitter: SkippableFrameSplitter | undefined;
+  private readonly offload: boolean;
 
-  // TODO: Allow user to specify a dictionary
   /**
    * Create a new streaming decompressor with the specified parameters.
    *
    * @param parameters - Decompression parameters
+   * @param options - Stream options
    */
-  constructor(parameters: DecompressParameters = {}) {
+  constructor(
+    parameters: DecompressParameters = {},
+    options: DecompressStreamOptions = {},
+  ) {
     // TODO: autoDestroy doesn't really work on Transform, we should consider
     // calling .destroy ourselves when necessary.
     super({ autoDestroy: true });
     updateDCtxParameters(this.dctx, parameters);
+
+    const {
+      dictionary,
+      maxOutputSize = Infinity,
+      skippableFrames,
+      offload = false,
+    } = options;
+    this.outputLeft = maxOutputSize;
+    this.offload = offload;
+    loadStreamDictionary(this.dctx, dictionary);
+    if (skippableFrames) {
+      this.splitter = new SkippableFrameSplitter((payload, magicVariant) => {
+        this.emit('skippableFrame', payload, magicVariant);
+      });
+    }
+  }
+
+  /**
+   * Returns the input for the next call, after splitting off any skippable
+   * frames, or `undefined` if there's nothing left to do.
+   */
+  private nextInput(srcBuf: Buffer): Buffer | undefined {
+    const { splitter } = this;
+    if (splitter !== undefined && this.atFrameStart) {
+      srcBuf = splitter.split(srcBuf);
+      if (srcBuf.length === 0) {
+        this.inFrame = false;
+        return undefined;
+      }
+    }
+    return srcBuf;
+  }
+
+  private nextOutput(): Buffer {
+    const dstBuf = this.output.free;
+    if (this.outputLeft < dstBuf.length) {
+      // Leave room for one byte too many, to detect going over the limit
+      // without decompressing any more than that
+      return dstBuf.subarray(0, this.outputLeft + 1);
+    }
+    return dstBuf;
+  }
+
+  /**
+   * Handles the {@link result} of decompressing `srcBuf` into `dstBuf`,
+   * returning the input for the next call, or `undefined` if there's nothing
+   * left to do.
+   */
+  private decompressed(srcBuf: Buffer, dstBuf: Buffer): Buffer | undefined {
+    const { output, result } = this;
+    const ret = result[0] ?? 0;
+    const produced = result[1] ?? 0;
+    const consumed = result[2] ?? 0;
+    this.outputLeft -= produced;
+    if (this.outputLeft < 0) throw maxOutputSizeError();
+    if (produced > 0) this.push(output.take(produced));
+    // Calls without progress report the size of the next frame header
+    if (produced > 0 || consumed > 0) this.atFrameStart = ret === 0;
+
+    srcBuf = srcBuf.subarray(consumed);
+    if (srcBuf.length === 0 && (produced < dstBuf.length || ret === 0)) {
+      this.inFrame = ret !== 0;
+      return undefined;
+    }
+    return this.nextInput(srcBuf);
+  }
+
+  private doDecompress(chunk: Buffer): void {
+    let srcBuf = this.nextInput(chunk);
+    while (srcBuf !== undefined) {
+      const dstBuf = this.nextOutput();
+      this.dctx.decompressStreamInto(dstBuf, srcBuf, this.result);
+      srcBuf = this.decompressed(srcBuf, dstBuf);
+    }
+  }
+
+  private async doDecompressAsync(chunk: Buffer): Promise<void> {
+    let srcBuf = this.nextInput(chunk);
+    while (srcBuf !== undefined) {
+      const dstBuf = this.nextOutput();
+      this.result.set(await this.dctx.decompressStreamAsync(dstBuf, srcBuf));
+      srcBuf = this.decompressed(srcBuf, dstBuf);
+    }
   }
 
   /** @internal */
@@ -182,25 +685,121 @@ export class DecompressStream extends Transform {
     done: TransformCallback,
   ): void {
     // TODO: Optimize this by looking at the frame header
+    // The Writable machinery is responsible for converting to a Buffer
+    assert(chunk instanceof Buffer);
+    if (this.offload) {
+      this.doDecompressAsync(chunk).then(
+        () => done(),
+        (err: unknown) => done(err as Error),
+      );
+      return;
+    }
+    try {
+      this.doDecompress(chunk);
+    } catch (err) {
+      done(err as Error);
+      return;
+    }
+    done();
+    return;
+  }
+
+  /** @internal */
+  override _flush(done: TransformCallback): void {
+    if (this.inFrame) {
+      done(new Error('Stream ended in middle of compressed data frame'));
+      return;
+    }
+    if (this.splitter?.pending) {
+      done(new Error('Stream ended in middle of skippable frame'));
+      return;
+    }
+    done();
+    return;
+  }
+}
+
+/**
+ * Options for {@link DecompressIntoStream}.
+ */
+export type DecompressIntoStreamOptions = Pick<
+  DecompressStreamOptions,
+  'dictionary'
+>;
+
+/**
+ * Writable stream that decompresses its input into a single fixed buffer.
+ *
+ * For compressed data that arrives in chunks, but whose decompressed size is
+ * known up front (e.g. from the frame header, see
+ * {@link binding.getFrameContentSize}). Output is written directly into the
+ * destination buffer with {@link DecompressParameters.stableOutBuffer} set, so
+ * the decompressor doesn't allocate a window buffer of its own, saving both
+ * its memory and a copy of every block.
+ *
+ * Writing more output than fits in the destination buffer fails the stream.
+ *
+ * @example Basic usage
+ * ```
+ * import { pipeline } from 'stream/promises';
+ * const dest = Buffer.allocUnsafe(size);
+ * const stream = new DecompressIntoStream(dest);
+ * await pipeline(fs.createReadStream('data.txt.zst'), stream);
+ * const result = dest.subarray(0, stream.bytesWritten);
+ * ```
+ */
+export class DecompressIntoStream extends Writable {
+  private dctx = new binding.DCtx();
+  private inFrame = false;
+  private result = new Float64Array(3);
+  private readonly dest: Uint8Array;
+  private pos = 0;
+
+  /**
+   * Create a new streaming decompressor writing into `dest`.
+   *
+   * @param dest - Buffer to decompress into
+   * @param parameters - Decompression parameters
+   * @param options - Stream options
+   */
+  constructor(
+    dest: Uint8Array,
+    parameters: DecompressParameters = {},
+    options: DecompressIntoStreamOptions = {},
+  ) {
+    super({ autoDestroy: true });
+    this.dest = dest;
+    updateDCtxParameters(this.dctx, { ...parameters, stableOutBuffer: true });
+    loadStreamDictionary(this.dctx, options.dictionary);
+  }
+
+  /** Number of decompressed bytes written to the destination buffer so far. */
+  get bytesWritten(): number {
+    return this.pos;
+  }
+
+  /** @internal */
+  override _write(
+    chunk: unknown,
+    _encoding: string,
+    done: (error?: Error | null) => void,
+  ): void {
     try {
       // The Writable machinery is responsible for converting to a Buffer
       assert(chunk instanceof Buffer);
       let srcBuf = chunk;
+      const { dest, result } = this;
 
-      for (;;) {
-        const dstBuf = Buffer.allocUnsafe(BUF_SIZE);
-        const [ret, produced, consumed] = this.dctx.decompressStream(
-          dstBuf,
-          srcBuf,
-        );
-        if (produced > 0) this.push(dstBuf.subarray(0, produced));
-
-        srcBuf = srcBuf.subarray(consumed);
-        if (srcBuf.length === 0 && (produced < dstBuf.length || ret === 0)) {
-          this.inFrame = ret !== 0;
-          break;
-        }
+      // Output is never held back with a stable output buffer, so the only
+      // reason to stop early is the end of a frame
+      let ret = 0;
+      while (srcBuf.length > 0) {
+        this.dctx.decompressStreamInto(dest, srcBuf, result, this.pos);
+        ret = result[0] ?? 0;
+        this.pos = result[1] ?? 0;
+        srcBuf = srcBuf.subarray(result[2] ?? 0);
       }
+      if (chunk.length > 0) this.inFrame = ret !== 0;
     } catch (err) {
       done(err as Error);
       return;
@@ -210,7 +809,7 @@ export class DecompressStream extends Transform {
   }
 
   /** @internal */
-  override _flush(done: TransformCallback): void {
+  override _final(done: (error?: Error | null) => void): void {
     if (this.inFrame) {
       done(new Error('Stream ended in middle of compressed data frame'));
       return;
@@ -0,0 +1,168 @@
+import { strict as assert } from 'assert';
+
+import binding = require('../binding');
+import { CompressParameters, updateCCtxParameters } from './compress';
+import {
+  DecompressOptions,
+  DecompressParameters,
+  findContentSize,
+  updateDCtxParameters,
+} from './decompress';
+import { compressBound, trimBuffer } from './util';
+
+// Same default limit as libzstd, which frames from any other source may rely on
+const DEFAULT_WINDOW_LOG_MAX = 27;
+
+// Smallest window that lets the end of the data reach back to the start of
+// the reference
+function windowLogFor(size: number, bounds: binding.Bounds): number {
+  const log = Math.ceil(Math.log2(Math.max(size, 1)));
+  return Math.min(Math.max(log, bounds.lowerBound), bounds.upperBound);
+}
+
+function prepareDeltaCCtx(
+  reference: Uint8Array,
+  dataLength: number,
+  parameters: CompressParameters,
+): binding.CCtx {
+  const bounds = binding.cParamGetBounds(binding.CParameter.windowLog);
+  const cctx = new binding.CCtx();
+  updateCCtxParameters(cctx, {
+    windowLog: windowLogFor(reference.length + dataLength, bounds),
+    enableLongDistanceMatching: true,
+    ...parameters,
+  });
+  cctx.refPrefix(reference);
+  return cctx;
+}
+
+function prepareDeltaDCtx(
+  reference: Uint8Array,
+  patch: Uint8Array,
+  parameters: DecompressParameters,
+  options: DecompressOptions,
+): [binding.DCtx, number] {
+  const contentSize = findContentSize(patch, options);
+  if (contentSize === null) {
+    throw new Error('Patch does not record its decompressed size');
+  }
+
+  const bounds = binding.dParamGetBounds(binding.DParameter.windowLogMax);
+  const windowLog = windowLogFor(reference.length + contentSize, bounds);
+  const dctx = new binding.DCtx();
+  updateDCtxParameters(dctx, {
+    windowLogMax: Math.max(windowLog, DEFAULT_WINDOW_LOG_MAX),
+    ...parameters,
+  });
+  dctx.refPrefix(reference);
+  return [dctx, contentSize];
+}
+
+/**
+ * Compress `data` as a patch against `reference`, typically a previous version
+ * of the same content.
+ *
+ * The reference is used in place as a raw-content prefix, without being copied
+ * or digested like a dictionary, so it's cheap even when large. The window size
+ * is picked to cover both the reference and `data`, and long-distance matching
+ * is enabled to find matches that far back; either can be overridden with
+ * `parameters`.
+ *
+ * The patch can only be decompressed with {@link decompressDelta} (or
+ * {@link decompressDeltaAsync}) and the same reference.
+ *
+ * @param reference - Content the patch is relative to
+ * @param data - Buffer containing data to compress
+ * @param parameters - Optional compression parameters
+ * @returns Compressed patch
+ */
+export function compressDelta(
+  reference: Uint8Array,
+  data: Uint8Array,
+  parameters: CompressParameters = {},
+): Buffer {
+  const cctx = prepareDeltaCCtx(reference, data.length, parameters);
+  const dest = Buffer.allocUnsafe(compressBound(data.length));
+  return trimBuffer(dest, cctx.compress2(dest, data));
+}
+
+/**
+ * Asynchronously compress `data` as a patch against `reference`.
+ *
+ * Works like {@link compressDelta}, but compression runs on the libuv
+ * threadpool instead of blocking the event loop. The contents of `reference`
+ * and `data` must not be modified until the returned promise settles.
+ *
+ * @param reference - Content the patch is relative to
+ * @param data - Buffer containing data to compress
+ * @param parameters - Optional compression parameters
+ * @returns A promise resolving to the compressed patch
+ */
+export async function compressDeltaAsync(
+  reference: Uint8Array,
+  data: Uint8Array,
+  parameters: CompressParameters = {},
+): Promise<Buffer> {
+  const cctx = prepareDeltaCCtx(reference, data.length, parameters);
+  const dest = Buffer.allocUnsafe(compressBound(data.length));
+  return trimBuffer(dest, await cctx.compress2Async(dest, data));
+}
+
+/**
+ * Decompress a patch created by {@link compressDelta}.
+ *
+ * `reference` must be identical to the one the patch was created with. The
+ * window size limit is raised as needed to cover it.
+ *
+ * @param reference - Content the patch is relative to
+ * @param patch - Buffer containing the compressed patch
+ * @param parameters - Optional decompression parameters
+ * @param options - Optional decompression options
+ * @returns Decompressed data
+ */
+export function decompressDelta(
+  reference: Uint8Array,
+  patch: Uint8Array,
+  parameters: DecompressParameters = {},
+  options: DecompressOptions = {},
+): Buffer {
+  const [dctx, contentSize] = prepareDeltaDCtx(
+    reference,
+    patch,
+    parameters,
+    options,
+  );
+  const result = Buffer.allocUnsafe(contentSize);
+  assert.equal(dctx.decompress(result, patch), contentSize);
+  return result;
+}
+
+/**
+ * Asynchronously decompress a patch created by {@link compressDelta}.
+ *
+ * Works like {@link decompressDelta}, but decompression runs on the libuv
+ * threadpool instead of blocking the event loop. The contents of `reference`
+ * and `patch` must not be modified until the returned promise settles.
+ *
+ * @param reference - Content the patch is relative to
+ * @param patch - Buffer containing the compressed patch
+ * @param parameters - Optional decompression parameters
+ * @param options - Optional decompression options
+ * @returns A promise resolving to the decompressed data
+ */
+export async function decompressDeltaAsync(
+  reference: Uint8Array,
+  patch: Uint8Array,
+  parameters: DecompressParameters = {},
+  options: DecompressOptions = {},
+): Promise<Buffer> {
+  const [dctx, contentSize] = prepareDeltaDCtx(
+    reference,
+    patch,
+    parameters,
+    options,
+  );
+  const result = Buffer.allocUnsafe(contentSize);
+  assert.equal(await dctx.decompressAsync(result, patch), contentSize);
+  return result;
+}
@@ -0,0 +1,175 @@
+import binding = require('../binding');
+
+// Same default as the zstd CLI
+const DEFAULT_MAX_SIZE = 112640;
+
+// Comfortably larger than the header and entropy tables written before the
+// content of a finalized dictionary
+const DICT_HEADER_MAX_SIZE = 4096;
+
+/**
+ * Options for {@link trainDictionary}.
+ *
+ * Any tuning parameters left unset are selected automatically.
+ */
+export interface TrainDictionaryOptions {
+  /**
+   * Maximum size of the dictionary in bytes, defaulting to 110 KiB (the same
+   * default as the `zstd` command-line tool).
+   */
+  maxSize?: number | undefined;
+  /**
+   * Training algorithm to use, defaulting to `fastCover`.
+   *
+   * The `cover` algorithm is much slower, but may produce slightly better
+   * dictionaries.
+   */
+  algorithm?: 'cover' | 'fastCover' | undefined;
+  /**
+   * Number of threads to train with, defaulting to 1.
+   *
+   * Training runs in the background either way, but more threads make it
+   * finish sooner.
+   */
+  threads?: number | undefined;
+  /** Compression level the dictionary will be used with. */
+  compressionLevel?: number | undefined;
+  /** Dictionary ID to use, defaulting to a random ID. */
+  dictID?: number | undefined;
+
+  /** @category Advanced training options */
+  k?: number | undefined;
+  /** @category Advanced training options */
+  d?: number | undefined;
+  /** @category Advanced training options */
+  steps?: number | undefined;
+  /** @category Advanced training options */
+  splitPoint?: number | undefined;
+  /**
+   * Only used by the `fastCover` algorithm.
+   *
+   * @category Advanced training options
+   */
+  f?: number | undefined;
+  /**
+   * Only used by the `fastCover` algorithm.
+   *
+   * @category Advanced training options
+   */
+  accel?: number | undefined;
+}
+
+/**
+ * Options for {@link finalizeDictionary}.
+ */
+export interface FinalizeDictionaryOptions {
+  /**
+   * Maximum size of the dictionary in bytes. If the content doesn't fit, it's
+   * trimmed from the start. Defaults to the size of the content plus enough
+   * room for the dictionary header.
+   */
+  maxSize?: number | undefined;
+  /** Compression level the dictionary will be used with. */
+  compressionLevel?: number | undefined;
+  /** Dictionary ID to use, defaulting to a random ID. */
+  dictID?: number | undefined;
+}
+
+/** Packs samples into the format used by the dictionary builder bindings. */
+function packSamples(samples: readonly Uint8Array[]): [Buffer, Uint32Array] {
+  const sizes = new Uint32Array(samples.length);
+  let total = 0;
+  samples.forEach((sample, i) => {
+    sizes[i] = sample.length;
+    total += sample.length;
+  });
+  return [Buffer.concat(samples, total), sizes];
+}
+
+/**
+ * Train a Zstandard dictionary from a set of samples.
+ *
+ * Dictionaries greatly improve compression of small inputs that share common
+ * content, such as individual records or messages. The samples should be
+ * representative of the data the dictionary will be used to compress, and
+ * there should be plenty of them: a few thousand is typical, and the total
+ * size should be around 100 times the dictionary size.
+ *
+ * Training runs on the libuv threadpool, so it doesn't block the event loop.
+ * The samples are copied before this function returns.
+ *
+ * @example
+ * ```
+ * const dict = await trainDictionary(samples);
+ * const cmp = new Compressor();
+ * cmp.loadDictionary(dict);
+ * ```
+ *
+ * @param samples - Training samples
+ * @param options - Training options
+ * @returns A promise resolving to a new Buffer containing the dictionary
+ */
+export async function trainDictionary(
+  samples: readonly Uint8Array[],
+  options: TrainDictionaryOptions = {},
+): Promise<Buffer> {
+  const {
+    maxSize = DEFAULT_MAX_SIZE,
+    algorithm = 'fastCover',
+    threads = 1,
+    ...params
+  } = options;
+  const [samplesBuf, sampleSizes] = packSamples(samples);
+  const dict = Buffer.allocUnsafe(maxSize);
+  const trainParams = { ...params, nbThreads: threads };
+  const { dictSize } =
+    algorithm === 'cover'
+      ? await binding.optimizeTrainFromBufferCover(
+          dict,
+          samplesBuf,
+          sampleSizes,
+          trainParams,
+        )
+      : await binding.optimizeTrainFromBufferFastCover(
+          dict,
+          samplesBuf,
+          sampleSizes,
+          trainParams,
+        );
+  return dict.subarray(0, dictSize);
+}
+
+/**
+ * Build a Zstandard dictionary from hand-picked content.
+ *
+ * This is an alternative to {@link trainDictionary} for when the content most
+ * likely to appear in inputs is already known. The samples are only used to
+ * compute the dictionary's entropy tables, so fewer are needed than for
+ * training.
+ *
+ * Runs on the libuv threadpool, so it doesn't block the event loop. The
+ * content and samples are copied before this function returns.
+ *
+ * @param content - Dictionary content
+ * @param samples - Samples of data the dictionary will be used to compress
+ * @param options - Dictionary options
+ * @returns A promise resolving to a new Buffer containing the dictionary
+ */
+export async function finalizeDictionary(
+  content: Uint8Array,
+  samples: readonly Uint8Array[],
+  options: FinalizeDictionaryOptions = {},
+): Promise<Buffer> {
+  const { maxSize = content.length + DICT_HEADER_MAX_SIZE, ...params } =
+    options;
+  const [samplesBuf, sampleSizes] = packSamples(samples);
+  const dict = Buffer.allocUnsafe(maxSize);
+  const dictSize = await binding.finalizeDictionary(
+    dict,
+    Buffer.from(content),
+    samplesBuf,
+    sampleSizes,
+    params,
+  );
+  return dict.subarray(0, dictSize);
+}
@@ -4,11 +4,23 @@
  * this is the right place to start!
  *
  * - The {@link compress} and {@link decompress} functions are the simplest,
- *   single-pass (in-memory) interface.
+ *   single-pass (in-memory) interface. {@link compressAsync} and
+ *   {@link decompressAsync} do the same work off the main thread, and
+ *   {@link decompressParallelAsync} spreads multi-frame data across cores.
+ *   {@link compressFile} and {@link decompressFile} work on whole files.
  * - The {@link Compressor} and {@link Decompressor} classes provide a
  *   single-pass interface with dictionary support.
  * - The {@link CompressStream} and {@link DecompressStream} classes provide
- *   a streaming interface.
+ *   a streaming interface, and {@link DecompressIntoStream} streams into a
+ *   single buffer when the decompressed size is known up front.
+ * - The {@link ZstdCompressionStream} and {@link ZstdDecompressionStream}
+ *   classes provide the same streaming interface for Web Streams.
+ * - The {@link trainDictionary} and {@link finalizeDictionary} functions build
+ *   dictionaries for use with the classes above.
+ * - The {@link compressDelta} and {@link decompressDelta} functions compress
+ *   data as a small patch against a previous version of it.
+ * - The {@link SeekableCompressStream} and {@link SeekableDecompressor} classes
+ *   provide random access to large compressed files.
  *
  * If you're looking for low-level bindings to the native Zstandard library,
  * see the {@link "binding" | binding module}.
@@ -16,10 +28,57 @@
  * @module index
  */
 
-export { CompressStream, Compressor } from './compress';
-export type { CompressParameters } from './compress';
+export {
+  CompressStream,
+  Compressor,
+  prepareCompressDictionary,
+} from './compress';
+export type {
+  AdaptiveLevelOptions,
+  CompressDictionary,
+  CompressParameters,
+  CompressStreamOptions,
+  PrepareDictionaryOptions,
+} from './compress';
 
-export { DecompressStream, Decompressor } from './decompress';
-export type { DecompressParameters } from './decompress';
+export {
+  DecompressIntoStream,
+  DecompressStream,
+  Decompressor,
+} from './decompress';
+export type {
+  DecompressDictionary,
+  DecompressIntoStreamOptions,
+  DecompressOptions,
+  DecompressParameters,
+  DecompressStreamOptions,
+} from './decompress';
 
-export { compress, decompress } from './simple';
+export {
+  compressDelta,
+  compressDeltaAsync,
+  decompressDelta,
+  decompressDeltaAsync,
+} from './delta';
+
+export { finalizeDictionary, trainDictionary } from './dictionary';
+export type {
+  FinalizeDictionaryOptions,
+  TrainDictionaryOptions,
+} from './dictionary';
+
+export { SeekableCompressStream, SeekableDecompressor } from './seekable';
+export type { SeekableCompressStreamOptions, SeekableSource } from './seekable';
+
+export {
+  compress,
+  compressAsync,
+  compressFile,
+  decompress,
+  decompressAsync,
+  decompressFile,
+  decompressParallelAsync,
+} from './simple';
+export type { ParallelDecompressOptions } from './simple';
+
+export { ZstdCompressionStream, ZstdDecompressionStream } from './web';
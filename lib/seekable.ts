@@ -0,0 +1,359 @@
+import { strict as assert } from 'assert';
+import { FileHandle } from 'fs/promises';
+import { Transform, TransformCallback } from 'stream';
+
+import binding = require('../binding');
+import { CompressParameters, updateCCtxParameters } from './compress';
+import { OutputSlab } from './util';
+
+// From the seekable format specification in zstd's contrib/seekable_format
+const SEEK_TABLE_MAGIC = 0x184d2a5e;
+const SEEKABLE_MAGIC = 0x8f92eab1;
+const SEEK_TABLE_FOOTER_SIZE = 9;
+const SKIPPABLE_HEADER_SIZE = 8;
+const CHECKSUM_FLAG = 0x80;
+const MAX_FRAME_SIZE = 0x40000000;
+const MAX_FRAMES = 0x8000000;
+
+const DEFAULT_MAX_FRAME_SIZE = 1024 * 1024;
+
+const BUF_SIZE = binding.cStreamOutSize();
+
+const dummyEndBuffer = Buffer.alloc(0);
+
+/**
+ * Options for {@link SeekableCompressStream}.
+ */
+export interface SeekableCompressStreamOptions {
+  /**
+   * Maximum uncompressed size of each frame, defaulting to 1 MiB.
+   *
+   * Smaller frames make reading small ranges cheaper, since only whole frames
+   * can be decompressed, but they compress less well. Limited to 1 GiB by the
+   * seekable format, which also allows at most 2^27 frames: the stream fails if
+   * the input would need any more.
+   */
+  maxFrameSize?: number | undefined;
+}
+
+/**
+ * Streaming compressor producing the Zstandard seekable format.
+ *
+ * Input is split into independently compressed frames of at most
+ * {@link SeekableCompressStreamOptions.maxFrameSize} bytes, and a seek table
+ * recording the size of each frame is appended when the stream ends. With it,
+ * {@link SeekableDecompressor} can decompress any range of the data by only
+ * decompressing the frames overlapping it.
+ *
+ * The seek table is stored in a skippable frame, so the output is also a
+ * regular Zstandard file that any decompressor can read in full. If the
+ * `checksumFlag` parameter is set, the frame checksums are also recorded in the
+ * seek table, as the format allows.
+ *
+ * @example
+ * ```
+ * import { pipeline } from 'stream/promises';
+ * await pipeline(
+ *   fs.createReadStream('data.log'),
+ *   new SeekableCompressStream(),
+ *   fs.createWriteStream('data.log.zst'),
+ * );
+ * ```
+ */
+export class SeekableCompressStream extends Transform {
+  private cctx = new binding.CCtx();
+  private output = new OutputSlab(BUF_SIZE);
+  private result = new Float64Array(3);
+  private readonly maxFrameSize: number;
+  private readonly checksums: boolean;
+  // Seek table entry fields for each completed frame
+  private entries: number[] = [];
+  private numFrames = 0;
+  private frameCompressedSize = 0;
+  private frameDecompressedSize = 0;
+  // Last bytes of output, which hold the checksum once a frame is complete
+  private tail = Buffer.alloc(4);
+
+  /**
+   * Create a new seekable compressor with the specified parameters.
+   *
+   * @param parameters - Compression parameters
+   * @param options - Stream options
+   */
+  constructor(
+    parameters: CompressParameters = {},
+    options: SeekableCompressStreamOptions = {},
+  ) {
+    super({ autoDestroy: true });
+    const { maxFrameSize = DEFAULT_MAX_FRAME_SIZE } = options;
+    if (
+      !Number.isInteger(maxFrameSize) ||
+      maxFrameSize < 1 ||
+      maxFrameSize > MAX_FRAME_SIZE
+    ) {
+      throw new RangeError('maxFrameSize must be between 1 byte and 1 GiB');
+    }
+    this.maxFrameSize = maxFrameSize;
+    this.checksums = parameters.checksumFlag === true;
+    updateCCtxParameters(this.cctx, parameters);
+  }
+
+  /**
+   * End the current frame early, without ending the stream.
+   *
+   * Useful to align frame boundaries with records in the data, so they can be
+   * read without decompressing their neighbors.
+   *
+   * The optional `callback` is invoked with the same semantics as it is for a
+   * stream write.
+   */
+  endFrame(callback?: (error?: Error | null) => void): void {
+    this.write(dummyEndBuffer, callback);
+  }
+
+  private pushOutput(output: Buffer): void {
+    this.frameCompressedSize += output.length;
+    if (output.length >= this.tail.length) {
+      output.copy(this.tail, 0, output.length - this.tail.length);
+    } else {
+      this.tail.copyWithin(0, output.length);
+      output.copy(this.tail, this.tail.length - output.length);
+    }
+    this.push(output);
+  }
+
+  private doCompress(chunk: Buffer, endType: binding.EndDirective): void {
+    const ending = endType === binding.EndDirective.end;
+    const { output, result } = this;
+    for (;;) {
+      this.cctx.compressStream2Into(output.free, chunk, endType, result);
+      const ret = result[0] ?? 0;
+      const produced = result[1] ?? 0;
+      const consumed = result[2] ?? 0;
+      if (produced > 0) this.pushOutput(output.take(produced));
+      chunk = chunk.subarray(consumed);
+      if (chunk.length == 0 && (!ending || ret == 0)) return;
+    }
+  }
+
+  private finishFrame(): void {
+    if (this.frameDecompressedSize === 0) return;
+    this.doCompress(dummyEndBuffer, binding.EndDirective.end);
+    this.entries.push(this.frameCompressedSize, this.frameDecompressedSize);
+    if (this.checksums) this.entries.push(this.tail.readUInt32LE(0));
+    this.numFrames++;
+    this.frameCompressedSize = 0;
+    this.frameDecompressedSize = 0;
+  }
+
+  private makeSeekTable(): Buffer {
+    const { numFrames } = this;
+    const entrySize = this.checksums ? 12 : 8;
+    const table = Buffer.allocUnsafe(
+      SKIPPABLE_HEADER_SIZE + numFrames * entrySize + SEEK_TABLE_FOOTER_SIZE,
+    );
+    let pos = table.writeUInt32LE(SEEK_TABLE_MAGIC, 0);
+    pos = table.writeUInt32LE(table.length - SKIPPABLE_HEADER_SIZE, pos);
+    for (const value of this.entries) {
+      pos = table.writeUInt32LE(value, pos);
+    }
+    pos = table.writeUInt32LE(numFrames, pos);
+    pos = table.writeUInt8(this.checksums ? CHECKSUM_FLAG : 0, pos);
+    table.writeUInt32LE(SEEKABLE_MAGIC, pos);
+    return table;
+  }
+
+  /** @internal */
+  override _transform(
+    chunk: unknown,
+    _encoding: string,
+    done: TransformCallback,
+  ): void {
+    try {
+      // The Writable machinery is responsible for converting to a Buffer
+      assert(chunk instanceof Buffer);
+
+      if (Object.is(chunk, dummyEndBuffer)) {
+        this.finishFrame();
+      }
+      let input = chunk;
+      while (input.length > 0) {
+        if (this.frameDecompressedSize === 0 && this.numFrames === MAX_FRAMES) {
+          throw new Error('Too many frames for the seekable format');
+        }
+        const room = this.maxFrameSize - this.frameDecompressedSize;
+        const part = input.subarray(0, room);
+        this.doCompress(part, binding.EndDirective.continue);
+        this.frameDecompressedSize += part.length;
+        input = input.subarray(part.length);
+        if (this.frameDecompressedSize === this.maxFrameSize) {
+          this.finishFrame();
+        }
+      }
+    } catch (err) {
+      done(err as Error);
+      return;
+    }
+    done();
+    return;
+  }
+
+  /** @internal */
+  override _flush(done: TransformCallback): void {
+    try {
+      this.finishFrame();
+      this.push(this.makeSeekTable());
+    } catch (err) {
+      done(err as Error);
+      return;
+    }
+    done();
+    return;
+  }
+}
+
+/**
+ * Compressed data in the seekable format, either in memory or in an open file.
+ *
+ * Files are read on demand, so only the seek table and the frames needed for
+ * each read are ever loaded into memory.
+ */
+export type SeekableSource = Uint8Array | FileHandle;
+
+async function getSourceSize(source: SeekableSource): Promise<number> {
+  if (source instanceof Uint8Array) return source.length;
+  return (await source.stat()).size;
+}
+
+async function readSource(
+  source: SeekableSource,
+  position: number,
+  length: number,
+): Promise<Uint8Array> {
+  if (source instanceof Uint8Array) {
+    return source.subarray(position, position + length);
+  }
+  const buffer = Buffer.allocUnsafe(length);
+  let offset = 0;
+  while (offset < length) {
+    const { bytesRead } = await source.read(
+      buffer,
+      offset,
+      length - offset,
+      position + offset,
+    );
+    if (bytesRead === 0) throw new Error('Unexpected end of file');
+    offset += bytesRead;
+  }
+  return buffer;
+}
+
+/**
+ * Random-access decompressor for the Zstandard seekable format.
+ *
+ * Reads ranges of the decompressed data from a source produced by
+ * {@link SeekableCompressStream} (or any other seekable format writer), only
+ * reading and decompressing the frames that overlap each range.
+ *
+ * @example
+ * ```
+ * const file = await fs.promises.open('data.log.zst');
+ * const dec = await SeekableDecompressor.open(file);
+ * const chunk = await dec.read(1_000_000_000, 1_000_001_000);
+ * ```
+ */
+export class SeekableDecompressor {
+  /** Total size of the decompressed data. */
+  readonly size: number;
+
+  private readonly source: SeekableSource;
+  private readonly reader: binding.SeekableReader;
+
+  private constructor(source: SeekableSource, reader: binding.SeekableReader) {
+    this.source = source;
+    this.reader = reader;
+    this.size = reader.getFrameDecompressedOffset(reader.getNumFrames());
+  }
+
+  /**
+   * Read the seek table from `source` and create a decompressor for it.
+   *
+   * A file handle stays owned by the caller, and must be kept open for as long
+   * as the decompressor is in use.
+   *
+   * @param source - Compressed data in the seekable format
+   * @returns A promise resolving to the new decompressor
+   */
+  static async open(source: SeekableSource): Promise<SeekableDecompressor> {
+    const sourceSize = await getSourceSize(source);
+    const footerSize = Math.min(sourceSize, SEEK_TABLE_FOOTER_SIZE);
+    const footer = await readSource(
+      source,
+      sourceSize - footerSize,
+      footerSize,
+    );
+    const tableSize = binding.seekTableSize(footer);
+    if (tableSize > sourceSize) {
+      throw new Error('Seek table is larger than the compressed data');
+    }
+    const dataSize = sourceSize - tableSize;
+    const reader = new binding.SeekableReader(
+      await readSource(source, dataSize, tableSize),
+    );
+    if (reader.getFrameCompressedOffset(reader.getNumFrames()) !== dataSize) {
+      throw new Error('Seek table does not match the compressed data');
+    }
+    return new SeekableDecompressor(source, reader);
+  }
+
+  /**
+   * Decompress the data from offset `start` up to (but not including) `end`.
+   *
+   * Only the frames overlapping the range are read and decompressed, each as a
+   * separate job on the libuv threadpool, so large ranges are decompressed in
+   * parallel. The range is clamped to the size of the data.
+   *
+   * @param start - Decompressed offset to start at
+   * @param end - Decompressed offset to end at, defaulting to the end of the
+   * data
+   * @returns A promise resolving to a new buffer with the decompressed data
+   */
+  async read(start: number, end: number = this.size): Promise<Buffer> {
+    if (
+      !Number.isSafeInteger(start) ||
+      !Number.isSafeInteger(end) ||
+      start < 0 ||
+      end < start
+    ) {
+      throw new RangeError('Invalid range');
+    }
+    end = Math.min(end, this.size);
+    if (start >= end) return Buffer.alloc(0);
+
+    const { reader } = this;
+    const first = reader.offsetToFrameIndex(start);
+    const last = reader.offsetToFrameIndex(end - 1);
+    const srcStart = reader.getFrameCompressedOffset(first);
+    const srcEnd = reader.getFrameCompressedOffset(last + 1);
+    const src = await readSource(this.source, srcStart, srcEnd - srcStart);
+
+    const result = Buffer.allocUnsafe(end - start);
+    const calls: Promise<number>[] = [];
+    for (let i = first; i <= last; i++) {
+      const frameStart = Math.max(start, reader.getFrameDecompressedOffset(i));
+      const frameEnd = Math.min(end, reader.getFrameDecompressedOffset(i + 1));
+      const frameSrc = src.subarray(
+        reader.getFrameCompressedOffset(i) - srcStart,
+      );
+      calls.push(
+        reader.decompressAsync(
+          result.subarray(frameStart - start, frameEnd - start),
+          frameSrc,
+          frameStart,
+        ),
+      );
+    }
+    await Promise.all(calls);
+    return result;
+  }
+}
@@ -1,15 +1,25 @@
-import { Compressor, CompressParameters } from './compress';
-import { Decompressor, DecompressParameters } from './decompress';
+import { strict as assert } from 'assert';
 
-let defaultCompressor: Compressor | undefined;
+import binding = require('../binding');
+import { CompressParameters, packCompressParameters } from './compress';
+import {
+  DecompressOptions,
+  Decompressor,
+  DecompressParameters,
+  findContentSize,
+  packDecompressParameters,
+} from './decompress';
+import { compressBound, CompressScratch, trimBuffer } from './util';
+
+let defaultScratch: CompressScratch | undefined;
 let defaultDecompressor: Decompressor | undefined;
 
 /**
  * Compress `data` with Zstandard.
  *
- * Under the hood, this uses a shared, lazily-initialized {@link Compressor},
- * which minimizes overhead. If you need dictionary support, create your own
- * instance of that class.
+ * Under the hood, this uses a native pool of compression contexts, which
+ * minimizes overhead. If you need dictionary support, create your own
+ * {@link Compressor}.
  *
  * @param data - Buffer containing data to compress
  * @param parameters - Optional compression parameters
@@ -19,27 +29,201 @@ export function compress(
   data: Uint8Array,
   parameters: CompressParameters = {},
 ): Buffer {
-  defaultCompressor ??= new Compressor();
-  defaultCompressor.setParameters(parameters);
-  return defaultCompressor.compress(data);
+  const params = packCompressParameters(parameters);
+  defaultScratch ??= new CompressScratch();
+  return defaultScratch.compress(data, (dest) =>
+    binding.compressPooled(dest, data, params),
+  );
+}
+
+/**
+ * Asynchronously compress `data` with Zstandard.
+ *
+ * Works like {@link compress}, but compression runs on the libuv threadpool
+ * instead of blocking the event loop. Any number of calls may be in progress at
+ * once. The contents of `data` must not be modified until the returned promise
+ * settles.
+ *
+ * @param data - Buffer containing data to compress
+ * @param parameters - Optional compression parameters
+ * @returns A promise resolving to the compressed data
+ */
+export async function compressAsync(
+  data: Uint8Array,
+  parameters: CompressParameters = {},
+): Promise<Buffer> {
+  const params = packCompressParameters(parameters);
+  const dest = Buffer.allocUnsafe(compressBound(data.length));
+  const length = await binding.compressPooledAsync(dest, data, params);
+  return trimBuffer(dest, length);
 }
 
 /**
  * Decompress Zstandard-compressed `data`.
  *
- * Under the hood, this uses a shared, lazily-initialized {@link Decompressor},
- * which minimizes overhead. If you need dictionary support, create your own
- * instance of that class.
+ * Under the hood, this uses a native pool of decompression contexts, which
+ * minimizes overhead. If you need dictionary support, create your own
+ * {@link Decompressor}.
  *
  * @param data - Buffer containing compressed data
  * @param parameters - Optional decompression parameters
+ * @param options - Optional decompression options
  * @returns Decompressed data
  */
 export function decompress(
   data: Uint8Array,
   parameters: DecompressParameters = {},
+  options: DecompressOptions = {},
 ): Buffer {
+  const params = packDecompressParameters(parameters);
+  const contentSize = findContentSize(data, options);
+  if (contentSize !== null) {
+    const result = Buffer.allocUnsafe(contentSize);
+    const decompressedSize = binding.decompressPooled(result, data, params);
+    assert.equal(decompressedSize, contentSize);
+    return result;
+  }
+
+  // Without a content size we have to stream, which needs a dedicated context
   defaultDecompressor ??= new Decompressor();
   defaultDecompressor.setParameters(parameters);
-  return defaultDecompressor.decompress(data);
+  return defaultDecompressor.decompress(data, options);
+}
+
+/**
+ * Asynchronously decompress Zstandard-compressed `data`.
+ *
+ * Works like {@link decompress}, but decompression runs on the libuv
+ * threadpool instead of blocking the event loop. Any number of calls may be in
+ * progress at once. The contents of `data` must not be modified until the
+ * returned promise settles.
+ *
+ * @param data - Buffer containing compressed data
+ * @param parameters - Optional decompression parameters
+ * @param options - Optional decompression options
+ * @returns A promise resolving to the decompressed data
+ */
+export async function decompressAsync(
+  data: Uint8Array,
+  parameters: DecompressParameters = {},
+  options: DecompressOptions = {},
+): Promise<Buffer> {
+  const params = packDecompressParameters(parameters);
+  const contentSize = findContentSize(data, options);
+  if (contentSize !== null) {
+    const result = Buffer.allocUnsafe(contentSize);
+    const decompressedSize = await binding.decompressPooledAsync(
+      result,
+      data,
+      params,
+    );
+    assert.equal(decompressedSize, contentSize);
+    return result;
+  }
+
+  // Concurrent calls can't share a streaming context, so use a fresh one
+  const decompressor = new Decompressor();
+  decompressor.updateParameters(parameters);
+  return decompressor.decompressAsync(data, options);
+}
+
+/**
+ * Options for {@link decompressParallelAsync}.
+ */
+export interface ParallelDecompressOptions extends DecompressOptions {
+  /**
+   * Maximum number of threads to decompress on, defaulting to one per CPU
+   * core. No more threads are used than there are frames in the data.
+   */
+  threads?: number | undefined;
+}
+
+/**
+ * Asynchronously decompress multi-frame Zstandard `data`, decompressing frames
+ * in parallel.
+ *
+ * A single frame can only be decompressed by one thread, but data made of many
+ * frames (as written by {@link CompressStream.endFrame} or
+ * {@link SeekableCompressStream}) can be spread across all cores. If every
+ * frame records its decompressed size, the output is allocated up front and
+ * each frame is decompressed straight into its slice of it on a separate
+ * thread. Otherwise, this falls back to {@link decompressAsync}.
+ *
+ * The contents of `data` must not be modified until the returned promise
+ * settles.
+ *
+ * @param data - Buffer containing compressed data
+ * @param parameters - Optional decompression parameters
+ * @param options - Optional decompression options
+ * @returns A promise resolving to the decompressed data
+ */
+export async function decompressParallelAsync(
+  data: Uint8Array,
+  parameters: DecompressParameters = {},
+  options: ParallelDecompressOptions = {},
+): Promise<Buffer> {
+  const { threads = 0 } = options;
+  if (!Number.isInteger(threads) || threads < 0) {
+    throw new RangeError('threads must be a non-negative integer');
+  }
+  const contentSize = findContentSize(data, options);
+  if (contentSize === null) {
+    return decompressAsync(data, parameters, options);
+  }
+
+  const params = packDecompressParameters(parameters);
+  const result = Buffer.allocUnsafe(contentSize);
+  const decompressedSize = await binding.decompressParallelAsync(
+    result,
+    data,
+    params,
+    threads,
+  );
+  assert.equal(decompressedSize, contentSize);
+  return result;
+}
+
+/**
+ * Compress the file at `srcPath` into a new file at `dstPath`.
+ *
+ * The whole job runs natively on the libuv threadpool, without streaming the
+ * data through JS. Where possible, the input is mapped into memory and
+ * compressed in place, and output is written in large blocks. Set the
+ * `nbWorkers` parameter to compress on several threads, like `zstd -T`.
+ *
+ * An existing file at `dstPath` is replaced, and removed if compression fails.
+ * The input file must not be modified until the returned promise settles.
+ *
+ * @param srcPath - Path of the file to compress
+ * @param dstPath - Path to write the compressed file to
+ * @param parameters - Optional compression parameters
+ * @returns A promise resolving to the size of the compressed file
+ */
+export function compressFile(
+  srcPath: string,
+  dstPath: string,
+  parameters: CompressParameters = {},
+): Promise<number> {
+  const params = packCompressParameters(parameters);
+  return binding.compressFile(srcPath, dstPath, params);
+}
+
+/**
+ * Decompress the file at `srcPath` into a new file at `dstPath`.
+ *
+ * Works like {@link compressFile}. If the input records its decompressed size,
+ * space for the output is reserved up front where the platform supports it.
+ *
+ * @param srcPath - Path of the file to decompress
+ * @param dstPath - Path to write the decompressed file to
+ * @param parameters - Optional decompression parameters
+ * @returns A promise resolving to the size of the decompressed file
+ */
+export function decompressFile(
+  srcPath: string,
+  dstPath: string,
+  parameters: DecompressParameters = {},
+): Promise<number> {
+  const params = packDecompressParameters(parameters);
+  return binding.decompressFile(srcPath, dstPath, params);
 }
@@ -64,3 +64,141 @@ export function mapParameters<
   }
   return result;
 }
+
+// Zero-length, so safe to share between every caller without parameters
+const NO_PARAMETERS = new Int32Array(0);
+
+export function packParameters<K extends number>(
+  params: Map<K, number>,
+): Int32Array {
+  if (params.size === 0) return NO_PARAMETERS;
+  const result = new Int32Array(params.size * 2);
+  let i = 0;
+  for (const [param, value] of params) {
+    result[i++] = param;
+    result[i++] = value;
+  }
+  return result;
+}
+
+/** Returns the first `length` bytes of `dest`, trimming it if too wasteful. */
+export function trimBuffer(dest: Buffer, length: number): Buffer {
+  if (length < 0.75 * dest.length) {
+    // Destination buffer is too wasteful, trim by copying
+    return Buffer.from(dest.subarray(0, length));
+  }
+  return dest.subarray(0, length);
+}
+
+/**
+ * Destination buffers for single-pass compression, reusing one when possible.
+ *
+ * Destinations are sized for the worst case, so the result usually has to be
+ * trimmed by copying. Instead of being discarded, a small enough destination is
+ * kept as scratch space for later calls whose input fits.
+ *
+ * @internal
+ */
+export class CompressScratch {
+  private scratchBuf: Buffer | null = null;
+  private scratchLen = -1;
+
+  /**
+   * Compresses `buffer` with `compressInto`, which writes into the destination
+   * it's given and returns the compressed length.
+   */
+  compress(buffer: Uint8Array, compressInto: (dest: Buffer) => number): Buffer {
+    let dest: Buffer;
+    if (this.scratchBuf && buffer.length <= this.scratchLen) {
+      dest = this.scratchBuf;
+    } else {
+      dest = Buffer.allocUnsafe(compressBound(buffer.length));
+    }
+
+    const length = compressInto(dest);
+    let result;
+    if (length < 0.75 * dest.length) {
+      // Destination buffer is too wasteful, trim by copying
+      result = Buffer.from(dest.subarray(0, length));
+
+      // Save the old buffer for scratch if it's small enough
+      if (dest.length <= 128 * 1024 && buffer.length > this.scratchLen) {
+        this.scratchBuf = dest;
+        this.scratchLen = buffer.length;
+      }
+    } else {
+      // Destination buffer is about the right size, return it directly
+      result = dest.subarray(0, length);
+
+      // Make sure we don't re-use the scratch buffer if we're returning it
+      if (Object.is(dest, this.scratchBuf)) {
+        this.scratchBuf = null;
+        this.scratchLen = -1;
+      }
+    }
+    return result;
+  }
+}
+
+// Same as ZSTD_COMPRESSBOUND, without a native call. Division stands in for
+// the shifts, which would truncate sizes to 32 bits.
+const SMALL_INPUT_LIMIT = 128 * 1024;
+
+/**
+ * Returns the maximum compressed size of `size` bytes of input in a single
+ * frame, like `binding.compressBound`.
+ *
+ * @internal
+ */
+export function compressBound(size: number): number {
+  const margin =
+    size < SMALL_INPUT_LIMIT
+      ? Math.floor((SMALL_INPUT_LIMIT - size) / 2048)
+      : 0;
+  return size + Math.floor(size / 256) + margin;
+}
+
+/**
+ * Output space for streams, carved out of larger shared slabs.
+ *
+ * Streams push the output they produce downstream, and can't know when it's
+ * safe to reuse. Rather than allocating a new buffer for every chunk, output is
+ * written to the unused tail of the current slab, and each chunk claims its
+ * part of it. A slab is freed by the garbage collector once every chunk taken
+ * from it is.
+ *
+ * @internal
+ */
+export class OutputSlab {
+  private readonly minSize: number;
+  private readonly slabSize: number;
+  private slab: Buffer;
+  private offset = 0;
+  private view: Buffer | undefined;
+
+  constructor(minSize: number, slabSize: number = 4 * minSize) {
+    this.minSize = minSize;
+    this.slabSize = Math.max(slabSize, minSize);
+    this.slab = Buffer.allocUnsafe(this.slabSize);
+  }
+
+  /** Unclaimed space to write output to, of at least `minSize` bytes. */
+  get free(): Buffer {
+    if (this.view === undefined) {
+      if (this.slab.length - this.offset < this.minSize) {
+        this.slab = Buffer.allocUnsafe(this.slabSize);
+        this.offset = 0;
+      }
+      this.view = this.slab.subarray(this.offset);
+    }
+    return this.view;
+  }
+
+  /** Claims the first `length` bytes of {@link free} as a chunk of output. */
+  take(length: number): Buffer {
+    const chunk = this.slab.subarray(this.offset, this.offset + length);
+    this.offset += length;
+    this.view = undefined;
+    return chunk;
+  }
+}
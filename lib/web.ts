@@ -0,0 +1,289 @@
+import { strict as assert } from 'assert';
+import type {
+  ReadableByteStreamController,
+  ReadableStream,
+  WritableStream,
+  WritableStreamDefaultController,
+} from 'stream/web';
+
+import binding = require('../binding');
+import {
+  CompressParameters,
+  CompressStreamOptions,
+  loadCCtxDictionary,
+  updateCCtxParameters,
+} from './compress';
+import {
+  DecompressParameters,
+  DecompressStreamOptions,
+  loadStreamDictionary,
+  maxOutputSizeError,
+  updateDCtxParameters,
+} from './decompress';
+
+const EMPTY = new Uint8Array(0);
+
+/**
+ * Loads `stream/web` on first use, so that the rest of the package still works
+ * on Node versions without it (before 16.5).
+ */
+function loadWebStreams(): typeof import('stream/web') {
+  // eslint-disable-next-line @typescript-eslint/no-require-imports -- lazy
+  return require('stream/web') as typeof import('stream/web');
+}
+
+interface Waiter {
+  resolve(): void;
+  reject(reason: unknown): void;
+}
+
+function toUint8Array(chunk: ArrayBufferView | ArrayBuffer): Uint8Array {
+  if (ArrayBuffer.isView(chunk)) {
+    return new Uint8Array(chunk.buffer, chunk.byteOffset, chunk.byteLength);
+  }
+  return new Uint8Array(chunk);
+}
+
+/**
+ * Readable/writable pair running a streaming (de)compressor, for use as a Web
+ * Streams `TransformStream`.
+ *
+ * Work is driven by the readable side: each chunk written is held until reads
+ * have consumed all of it, with output going straight into the buffer of the
+ * read that asked for it. Written chunks must not be modified until their write
+ * has completed.
+ */
+abstract class ZstdWebStream {
+  /** Readable side, a byte stream which supports BYOB readers. */
+  readonly readable: ReadableStream<Uint8Array>;
+  /** Writable side, accepting any `ArrayBuffer` or view of one. */
+  readonly writable: WritableStream<ArrayBufferView | ArrayBuffer>;
+
+  /** Input written but not yet consumed. */
+  protected input: Uint8Array = EMPTY;
+  protected readonly result = new Float64Array(3);
+  private ended = false;
+  private inputWaiter: Waiter | undefined;
+  private drainWaiter: Waiter | undefined;
+  private readableController: ReadableByteStreamController | undefined;
+  private writableController: WritableStreamDefaultController | undefined;
+
+  constructor(chunkSize: number) {
+    const { ReadableStream, WritableStream } = loadWebStreams();
+    this.readable = new ReadableStream({
+      type: 'bytes',
+      // Guarantees a BYOB request for every pull, even from default readers
+      autoAllocateChunkSize: chunkSize,
+      start: (controller) => {
+        this.readableController = controller;
+      },
+      pull: (controller) => this.pull(controller),
+      cancel: (reason) => {
+        this.fail(reason);
+      },
+    });
+    this.writable = new WritableStream({
+      start: (controller) => {
+        this.writableController = controller;
+      },
+      write: (chunk) => this.write(toUint8Array(chunk)),
+      close: () => {
+        this.ended = true;
+        this.wakeReader();
+      },
+      abort: (reason) => {
+        this.fail(reason);
+      },
+    });
+  }
+
+  /**
+   * Processes {@link input} into `dst`, returning the number of bytes written.
+   *
+   * Only returns 0 once all input so far has been consumed and there is no
+   * more output to produce from it.
+   */
+  protected abstract process(dst: Uint8Array, end: boolean): number;
+
+  /** Marks `length` bytes of {@link input} as consumed. */
+  protected consume(length: number): void {
+    this.input = this.input.subarray(length);
+    if (this.input.length === 0 && this.drainWaiter !== undefined) {
+      const waiter = this.drainWaiter;
+      this.drainWaiter = undefined;
+      waiter.resolve();
+    }
+  }
+
+  private write(chunk: Uint8Array): Promise<void> {
+    if (chunk.length === 0) return Promise.resolve();
+    this.input = chunk;
+    const drained = new Promise<void>((resolve, reject) => {
+      this.drainWaiter = { resolve, reject };
+    });
+    this.wakeReader();
+    return drained;
+  }
+
+  private wakeReader(): void {
+    if (this.inputWaiter !== undefined) {
+      const waiter = this.inputWaiter;
+      this.inputWaiter = undefined;
+      waiter.resolve();
+    }
+  }
+
+  private async pull(controller: ReadableByteStreamController): Promise<void> {
+    try {
+      const request = controller.byobRequest;
+      assert(request?.view);
+      const { view } = request;
+      const dst = new Uint8Array(view.buffer, view.byteOffset, view.byteLength);
+      for (;;) {
+        const produced = this.process(dst, this.ended);
+        if (produced > 0) {
+          request.respond(produced);
+          return;
+        }
+        if (this.ended) {
+          controller.close();
+          request.respond(0);
+          return;
+        }
+        await new Promise<void>((resolve, reject) => {
+          this.inputWaiter = { resolve, reject };
+        });
+      }
+    } catch (err) {
+      this.fail(err);
+      throw err;
+    }
+  }
+
+  private fail(reason: unknown): void {
+    // Both of these are no-ops on streams which have already closed or failed
+    this.readableController?.error(reason);
+    this.writableController?.error(reason);
+    for (const waiter of [this.inputWaiter, this.drainWaiter]) {
+      waiter?.reject(reason);
+    }
+    this.inputWaiter = undefined;
+    this.drainWaiter = undefined;
+  }
+}
+
+/**
+ * Web Streams compressor, a drop-in alternative to `CompressionStream`.
+ *
+ * Its readable side is a byte stream, so BYOB readers can have compressed data
+ * written directly into buffers of their own.
+ *
+ * @example Basic usage
+ * ```
+ * const response = await fetch(url);
+ * const compressed = response.body.pipeThrough(new ZstdCompressionStream());
+ * ```
+ */
+export class ZstdCompressionStream extends ZstdWebStream {
+  private cctx = new binding.CCtx();
+  private finished = false;
+
+  /**
+   * Create a new streaming compressor with the specified parameters.
+   *
+   * @param parameters - Compression parameters
+   * @param options - Stream options
+   */
+  constructor(
+    parameters: CompressParameters = {},
+    options: Pick<CompressStreamOptions, 'dictionary'> = {},
+  ) {
+    super(binding.cStreamOutSize());
+    updateCCtxParameters(this.cctx, parameters);
+    if (options.dictionary !== undefined) {
+      loadCCtxDictionary(this.cctx, options.dictionary);
+    }
+  }
+
+  protected override process(dst: Uint8Array, end: boolean): number {
+    if (this.finished) return 0;
+    const { result } = this;
+    const endOp = end
+      ? binding.EndDirective.end
+      : binding.EndDirective.continue;
+    for (;;) {
+      this.cctx.compressStream2Into(dst, this.input, endOp, result);
+      const ret = result[0] ?? 0;
+      const produced = result[1] ?? 0;
+      this.consume(result[2] ?? 0);
+      // Ending again would start a new frame
+      if (end && ret === 0) this.finished = true;
+      if (produced > 0) return produced;
+      if (this.input.length === 0 && (!end || ret === 0)) return 0;
+    }
+  }
+}
+
+/**
+ * Web Streams decompressor, a drop-in alternative to `DecompressionStream`.
+ *
+ * Its readable side is a byte stream, so BYOB readers can have decompressed
+ * data written directly into buffers of their own.
+ *
+ * @example Basic usage
+ * ```
+ * const response = await fetch(url);
+ * const reader = response.body
+ *   .pipeThrough(new ZstdDecompressionStream())
+ *   .getReader({ mode: 'byob' });
+ * const { value } = await reader.read(new Uint8Array(65536));
+ * ```
+ */
+export class ZstdDecompressionStream extends ZstdWebStream {
+  private dctx = new binding.DCtx();
+  private inFrame = false;
+  private outputLeft: number;
+
+  /**
+   * Create a new streaming decompressor with the specified parameters.
+   *
+   * @param parameters - Decompression parameters
+   * @param options - Stream options
+   */
+  constructor(
+    parameters: DecompressParameters = {},
+    options: Pick<DecompressStreamOptions, 'dictionary' | 'maxOutputSize'> = {},
+  ) {
+    super(binding.dStreamOutSize());
+    updateDCtxParameters(this.dctx, parameters);
+    const { dictionary, maxOutputSize = Infinity } = options;
+    this.outputLeft = maxOutputSize;
+    loadStreamDictionary(this.dctx, dictionary);
+  }
+
+  protected override process(dst: Uint8Array, end: boolean): number {
+    const { result } = this;
+    if (this.outputLeft < dst.length) {
+      // Leave room for one byte too many, to detect going over the limit
+      // without decompressing any more than that
+      dst = dst.subarray(0, this.outputLeft + 1);
+    }
+    for (;;) {
+      this.dctx.decompressStreamInto(dst, this.input, result);
+      const ret = result[0] ?? 0;
+      const produced = result[1] ?? 0;
+      const consumed = result[2] ?? 0;
+      this.consume(consumed);
+      // Calls without progress report the size of the next frame header
+      if (produced > 0 || consumed > 0) this.inFrame = ret !== 0;
+      this.outputLeft -= produced;
+      if (this.outputLeft < 0) throw maxOutputSizeError();
+      if (produced > 0) return produced;
+      if (this.input.length === 0) break;
+    }
+    if (end && this.inFrame) {
+      throw new Error('Stream ended in middle of compressed data frame');
+    }
+    return 0;
+  }
+}
@@ -0,0 +1,128 @@
+#ifndef ASYNC_WORKER_H
+#define ASYNC_WORKER_H
+
+#include <napi.h>
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "object_wrap_helper.h"
+#include "util.h"
+#include "zstd.h"
+
+// Runs a libzstd call on the libuv threadpool and settles a Promise with the
+// result. JS keeps running while the call is in progress, so everything it
+// touches must be pinned (and any context locked) before it's queued.
+class ZstdAsyncWorker : public Napi::AsyncWorker {
+ public:
+  ZstdAsyncWorker(Napi::Env env)
+      : Napi::AsyncWorker(env, "zstd-napi"),
+        deferred(Napi::Promise::Deferred::New(env)) {}
+
+  // Keeps a JS object (usually a buffer) alive until the call completes
+  void pin(Napi::Value value) {
+    pinned.push_back(Napi::Persistent(value.As<Napi::Object>()));
+  }
+
+  // Pins a native object and rejects any other use until the call completes
+  template <typename T>
+  void lock(ObjectWrapHelper<T>* owner) {
+    owner->beginAsync(Env());
+    pin(owner->Value());
+    unlock = [owner](Napi::Env env) { owner->endAsync(env); };
+  }
+
+  static Napi::Value queue(std::unique_ptr<ZstdAsyncWorker> worker) {
+    Napi::Promise promise = worker->deferred.Promise();
+    // Ownership passes to node-addon-api, which deletes the worker once the
+    // completion callback has run
+    worker.release()->Queue();
+    return promise;
+  }
+
+ protected:
+  size_t ret = 0;
+
+  virtual size_t run() = 0;
+  virtual Napi::Value makeResult(Napi::Env env) {
+    return Napi::Number::New(env, ret);
+  }
+
+  void Execute() override {
+    ret = run();
+    if (ZSTD_isError(ret))
+      SetError(ZSTD_getErrorName(ret));
+  }
+
+  void OnOK() override {
+    Napi::Env env = Env();
+    if (unlock)
+      unlock(env);
+    deferred.Resolve(makeResult(env));
+  }
+
+  void OnError(const Napi::Error& err) override {
+    if (unlock)
+      unlock(Env());
+    deferred.Reject(err.Value());
+  }
+
+ private:
+  Napi::Promise::Deferred deferred;
+  std::vector<Napi::ObjectReference> pinned;
+  std::function<void(Napi::Env)> unlock;
+};
+
+template <typename F>
+class ZstdAsyncCall : public ZstdAsyncWorker {
+ public:
+  ZstdAsyncCall(Napi::Env env, F fn)
+      : ZstdAsyncWorker(env), fn(std::move(fn)) {}
+
+ protected:
+  size_t run() override { return fn(); }
+
+ private:
+  F fn;
+};
+
+// Streaming calls report progress through their in/out buffers in addition to
+// the return value, so they resolve to a StreamResult instead
+template <typename F>
+class ZstdAsyncStreamCall : public ZstdAsyncWorker {
+ public:
+  ZstdAsyncStreamCall(Napi::Env env,
+                      ZSTD_outBuffer outBuf,
+                      ZSTD_inBuffer inBuf,
+                      F fn)
+      : ZstdAsyncWorker(env), outBuf(outBuf), inBuf(inBuf), fn(std::move(fn)) {}
+
+ protected:
+  size_t run() override { return fn(&outBuf, &inBuf); }
+  Napi::Value makeResult(Napi::Env env) override {
+    return makeStreamResult(env, ret, outBuf, inBuf);
+  }
+
+ private:
+  ZSTD_outBuffer outBuf;
+  ZSTD_inBuffer inBuf;
+  F fn;
+};
+
+template <typename F>
+std::unique_ptr<ZstdAsyncWorker> makeAsyncCall(Napi::Env env, F fn) {
+  return std::make_unique<ZstdAsyncCall<F>>(env, std::move(fn));
+}
+
+template <typename F>
+std::unique_ptr<ZstdAsyncWorker> makeAsyncStreamCall(Napi::Env env,
+                                                     ZSTD_outBuffer outBuf,
+                                                     ZSTD_inBuffer inBuf,
+                                                     F fn) {
+  return std::make_unique<ZstdAsyncStreamCall<F>>(env, outBuf, inBuf,
+                                                  std::move(fn));
+}
+
+#endif
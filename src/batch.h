@@ -0,0 +1,77 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <napi.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "zstd.h"
+
+// A batch of independent inputs, stored back-to-back in one source buffer and
+// delimited by an offsets table with one more entry than there are inputs.
+// Outputs are written back-to-back into one destination buffer, with their
+// boundaries recorded in a second offsets table of the same length.
+struct Batch {
+  uint8_t* dst;
+  size_t dstCapacity;
+  const uint8_t* src;
+  // Copied, so JS can't change the offsets out from under an async operation
+  std::vector<uint32_t> srcOffsets;
+  uint32_t* dstOffsets;
+};
+
+static inline Batch makeBatch(Napi::Env env,
+                              Napi::Uint8Array& dstBuf,
+                              Napi::Uint8Array& srcBuf,
+                              Napi::Uint32Array& srcOffsets,
+                              Napi::Uint32Array& dstOffsets) {
+  size_t count = srcOffsets.ElementLength();
+  if (count == 0 || dstOffsets.ElementLength() != count) {
+    throw Napi::RangeError::New(
+        env, "Offset arrays must have the same, non-zero length");
+  }
+
+  Batch batch;
+  batch.dst = dstBuf.Data();
+  // Output offsets are 32-bit, so don't let the output grow any larger
+  batch.dstCapacity = std::min<size_t>(dstBuf.ByteLength(),
+                                       std::numeric_limits<uint32_t>::max());
+  batch.src = srcBuf.Data();
+  batch.srcOffsets.assign(srcOffsets.Data(), srcOffsets.Data() + count);
+  batch.dstOffsets = dstOffsets.Data();
+
+  if (!std::is_sorted(batch.srcOffsets.begin(), batch.srcOffsets.end()) ||
+      batch.srcOffsets.back() > srcBuf.ByteLength()) {
+    throw Napi::RangeError::New(env, "Invalid source offsets");
+  }
+  return batch;
+}
+
+// Total size of the batch's inputs
+static inline size_t batchInputSize(const Batch& batch) {
+  return batch.srcOffsets.back() - batch.srcOffsets.front();
+}
+
+// Calls `fn` for each input in the batch, stopping at the first error. Returns
+// the total output size, or the error.
+template <typename F>
+size_t runBatch(Batch& batch, F fn) {
+  size_t pos = 0;
+  batch.dstOffsets[0] = 0;
+  for (size_t i = 0; i + 1 < batch.srcOffsets.size(); i++) {
+    size_t srcStart = batch.srcOffsets[i];
+    size_t srcSize = batch.srcOffsets[i + 1] - srcStart;
+    size_t ret = fn(batch.dst + pos, batch.dstCapacity - pos,
+                    batch.src + srcStart, srcSize);
+    if (ZSTD_isError(ret))
+      return ret;
+    pos += ret;
+    batch.dstOffsets[i + 1] = static_cast<uint32_t>(pos);
+  }
+  return pos;
+}
+
+#endif
@@ -1,12 +1,23 @@
 #include <napi.h>
 
 #include <cstdio>
+#include <exception>
+#include <utility>
 
+#include "async_worker.h"
 #include "cctx.h"
 #include "cdict.h"
 #include "constants.h"
+#include "context_pool.h"
 #include "dctx.h"
 #include "ddict.h"
+#include "dict_builder.h"
+#include "files.h"
+#include "frames.h"
+#include "parallel.h"
+#include "seekable.h"
+#include "stats.h"
+#include "thread_pool.h"
 #include "util.h"
 
 using namespace Napi;
@@ -67,6 +78,181 @@ Value wrapFindFrameCompressedSize(const CallbackInfo& info) {
                                     frameBuf.Data(), frameBuf.ByteLength()));
 }
 
+Value wrapFindDecompressedSize(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 1);
+
+  Uint8Array srcBuf = info[0].As<Uint8Array>();
+  unsigned long long size =
+      ZSTD_findDecompressedSize(srcBuf.Data(), srcBuf.ByteLength());
+  if (size == ZSTD_CONTENTSIZE_UNKNOWN)
+    return env.Null();
+  if (size == ZSTD_CONTENTSIZE_ERROR)
+    throw Error::New(env, "Could not parse Zstandard frames");
+  return Number::New(env, size);
+}
+
+Value wrapDecompressBound(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 1);
+
+  Uint8Array srcBuf = info[0].As<Uint8Array>();
+  unsigned long long bound =
+      ZSTD_decompressBound(srcBuf.Data(), srcBuf.ByteLength());
+  if (bound == ZSTD_CONTENTSIZE_ERROR)
+    throw Error::New(env, "Could not parse Zstandard frames");
+  return Number::New(env, bound);
+}
+
+Value wrapCheckDecompressedSize(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 2);
+  double maxOutputSize = info[1].ToNumber().DoubleValue();
+
+  Uint8Array srcBuf = info[0].As<Uint8Array>();
+  unsigned long long size =
+      ZSTD_findDecompressedSize(srcBuf.Data(), srcBuf.ByteLength());
+  if (size == ZSTD_CONTENTSIZE_UNKNOWN)
+    return env.Null();
+  if (size == ZSTD_CONTENTSIZE_ERROR)
+    throw Error::New(env, "Could not parse Zstandard frames");
+  if (static_cast<double>(size) > maxOutputSize)
+    throw RangeError::New(env, "Decompressed size exceeds maxOutputSize");
+  // Frame headers are trusted by ZSTD_findDecompressedSize, so a tiny frame
+  // can claim an enormous size to make the caller allocate it
+  if (!isPlausibleContentSize(size, srcBuf.ByteLength()))
+    throw Error::New(env, "Frame content size is larger than its data allows");
+  return Number::New(env, size);
+}
+
+// Pooled contexts
+Value wrapCompressPooled(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 3);
+  ParamList params = readParamList(env, info[2]);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  size_t result = compressPooled(params, dstBuf.Data(), dstBuf.ByteLength(),
+                                 srcBuf.Data(), srcBuf.ByteLength());
+  return convertZstdResult(env, result);
+}
+
+Value wrapCompressPooledAsync(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 3);
+  ParamList params = readParamList(env, info[2]);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  void* dst = dstBuf.Data();
+  size_t dstSize = dstBuf.ByteLength();
+  const void* src = srcBuf.Data();
+  size_t srcSize = srcBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    return compressPooled(params, dst, dstSize, src, srcSize);
+  });
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+Value wrapDecompressPooled(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 3);
+  ParamList params = readParamList(env, info[2]);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  size_t result = decompressPooled(params, dstBuf.Data(), dstBuf.ByteLength(),
+                                   srcBuf.Data(), srcBuf.ByteLength());
+  return convertZstdResult(env, result);
+}
+
+Value wrapDecompressPooledAsync(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 3);
+  ParamList params = readParamList(env, info[2]);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  void* dst = dstBuf.Data();
+  size_t dstSize = dstBuf.ByteLength();
+  const void* src = srcBuf.Data();
+  size_t srcSize = srcBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    return decompressPooled(params, dst, dstSize, src, srcSize);
+  });
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+// Parallel decompression
+Value wrapDecompressParallel(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 4);
+  ParamList params = readParamList(env, info[2]);
+  unsigned threads = info[3].ToNumber().Uint32Value();
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  size_t result;
+  try {
+    result =
+        decompressParallel(params, threads, dstBuf.Data(), dstBuf.ByteLength(),
+                           srcBuf.Data(), srcBuf.ByteLength());
+  } catch (const std::exception& e) {
+    throw Error::New(env, e.what());
+  }
+  return convertZstdResult(env, result);
+}
+
+Value wrapDecompressParallelAsync(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 4);
+  ParamList params = readParamList(env, info[2]);
+  unsigned threads = info[3].ToNumber().Uint32Value();
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  void* dst = dstBuf.Data();
+  size_t dstSize = dstBuf.ByteLength();
+  const void* src = srcBuf.Data();
+  size_t srcSize = srcBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    return decompressParallel(params, threads, dst, dstSize, src, srcSize);
+  });
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+// File compression
+Value wrapCompressFile(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 3);
+  std::string srcPath = info[0].ToString();
+  std::string dstPath = info[1].ToString();
+  ParamList params = readParamList(env, info[2]);
+
+  auto worker = makeAsyncCall(
+      env, [=]() { return compressFile(params, srcPath, dstPath); });
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+Value wrapDecompressFile(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 3);
+  std::string srcPath = info[0].ToString();
+  std::string dstPath = info[1].ToString();
+  ParamList params = readParamList(env, info[2]);
+
+  auto worker = makeAsyncCall(
+      env, [=]() { return decompressFile(params, srcPath, dstPath); });
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
 // Helper functions
 Value wrapCompressBound(const CallbackInfo& info) {
   Env env = info.Env();
@@ -172,6 +358,8 @@ Object ModuleInit(Env env, Object exports) {
   CDict::Init(env, exports);
   DCtx::Init(env, exports);
   DDict::Init(env, exports);
+  SeekableReader::Init(env, exports);
+  ThreadPool::Init(env, exports);
 
   createConstants(env, exports);
   createEnums(env, exports);
@@ -189,6 +377,34 @@ Object ModuleInit(Env env, Object exports) {
           env, exports, "getFrameContentSize", napi_default_jsproperty),
       propertyDescFunction<wrapFindFrameCompressedSize>(
           env, exports, "findFrameCompressedSize", napi_default_jsproperty),
+      propertyDescFunction<wrapFindDecompressedSize>(
+          env, exports, "findDecompressedSize", napi_default_jsproperty),
+      propertyDescFunction<wrapDecompressBound>(
+          env, exports, "decompressBound", napi_default_jsproperty),
+      propertyDescFunction<wrapCheckDecompressedSize>(
+          env, exports, "checkDecompressedSize", napi_default_jsproperty),
+      propertyDescFunction<wrapScanFrames>(env, exports, "scanFrames",
+                                           napi_default_jsproperty),
+      propertyDescFunction<wrapWriteSkippableFrame>(
+          env, exports, "writeSkippableFrame", napi_default_jsproperty),
+      propertyDescFunction<wrapReadSkippableFrame>(
+          env, exports, "readSkippableFrame", napi_default_jsproperty),
+      propertyDescFunction<wrapCompressPooled>(env, exports, "compressPooled",
+                                               napi_default_jsproperty),
+      propertyDescFunction<wrapCompressPooledAsync>(
+          env, exports, "compressPooledAsync", napi_default_jsproperty),
+      propertyDescFunction<wrapDecompressPooled>(
+          env, exports, "decompressPooled", napi_default_jsproperty),
+      propertyDescFunction<wrapDecompressPooledAsync>(
+          env, exports, "decompressPooledAsync", napi_default_jsproperty),
+      propertyDescFunction<wrapDecompressParallel>(
+          env, exports, "decompressParallel", napi_default_jsproperty),
+      propertyDescFunction<wrapDecompressParallelAsync>(
+          env, exports, "decompressParallelAsync", napi_default_jsproperty),
+      propertyDescFunction<wrapCompressFile>(env, exports, "compressFile",
+                                             napi_default_jsproperty),
+      propertyDescFunction<wrapDecompressFile>(env, exports, "decompressFile",
+                                               napi_default_jsproperty),
       propertyDescFunction<wrapCompressBound>(env, exports, "compressBound",
                                               napi_default_jsproperty),
       propertyDescFunction<wrapMinCLevel>(env, exports, "minCLevel",
@@ -213,6 +429,22 @@ Object ModuleInit(Env env, Object exports) {
           env, exports, "getDictIDFromDict", napi_default_jsproperty),
       propertyDescFunction<wrapGetDictIDFromFrame>(
           env, exports, "getDictIDFromFrame", napi_default_jsproperty),
+      propertyDescFunction<wrapTrainFromBuffer>(
+          env, exports, "trainFromBuffer", napi_default_jsproperty),
+      propertyDescFunction<wrapOptimizeTrainFromBufferCover>(
+          env, exports, "optimizeTrainFromBufferCover",
+          napi_default_jsproperty),
+      propertyDescFunction<wrapOptimizeTrainFromBufferFastCover>(
+          env, exports, "optimizeTrainFromBufferFastCover",
+          napi_default_jsproperty),
+      propertyDescFunction<wrapFinalizeDictionary>(
+          env, exports, "finalizeDictionary", napi_default_jsproperty),
+      propertyDescFunction<wrapSeekTableSize>(env, exports, "seekTableSize",
+                                              napi_default_jsproperty),
+      propertyDescFunction<wrapSetStatsEnabled>(
+          env, exports, "setStatsEnabled", napi_default_jsproperty),
+      propertyDescFunction<wrapGetStats>(env, exports, "getStats",
+                                         napi_default_jsproperty),
   });
 
   return exports;
@@ -1,6 +1,10 @@
 #include "cctx.h"
 
+#include "async_worker.h"
+#include "batch.h"
 #include "cdict.h"
+#include "sequence_producer.h"
+#include "thread_pool.h"
 
 using namespace Napi;
 
@@ -15,6 +19,8 @@ void CCtx::Init(Napi::Env env, Napi::Object exports) {
                                                        napi_default_method),
           InstanceMethod<&CCtx::wrapCompressUsingCDict>("compressUsingCDict",
                                                         napi_default_method),
+          InstanceMethod<&CCtx::wrapCompressUsingCDictAsync>(
+              "compressUsingCDictAsync", napi_default_method),
           InstanceMethod<&CCtx::wrapSetParameter>("setParameter",
                                                   napi_default_method),
           InstanceMethod<&CCtx::wrapSetPledgedSrcSize>("setPledgedSrcSize",
@@ -22,10 +28,36 @@ void CCtx::Init(Napi::Env env, Napi::Object exports) {
           InstanceMethod<&CCtx::wrapReset>("reset", napi_default_method),
           InstanceMethod<&CCtx::wrapCompress2>("compress2",
                                                napi_default_method),
+          InstanceMethod<&CCtx::wrapCompress2Async>("compress2Async",
+                                                    napi_default_method),
           InstanceMethod<&CCtx::wrapCompressStream2>("compressStream2",
                                                      napi_default_method),
+          InstanceMethod<&CCtx::wrapCompressStream2Async>(
+              "compressStream2Async", napi_default_method),
+          InstanceMethod<&CCtx::wrapCompressStream2Into>(
+              "compressStream2Into", napi_default_method),
+          InstanceMethod<&CCtx::wrapCompressBatch>("compressBatch",
+                                                   napi_default_method),
+          InstanceMethod<&CCtx::wrapCompressBatchAsync>("compressBatchAsync",
+                                                        napi_default_method),
+          InstanceMethod<&CCtx::wrapCompressSequences>("compressSequences",
+                                                       napi_default_method),
+          InstanceMethod<&CCtx::wrapCompressSequencesAsync>(
+              "compressSequencesAsync", napi_default_method),
+          InstanceMethod<&CCtx::wrapRegisterSequenceProducer>(
+              "registerSequenceProducer", napi_default_method),
           InstanceMethod<&CCtx::wrapLoadDictionary>("loadDictionary",
                                                     napi_default_method),
+          InstanceMethod<&CCtx::wrapRefCDict>("refCDict", napi_default_method),
+          InstanceMethod<&CCtx::wrapRefThreadPool>("refThreadPool",
+                                                   napi_default_method),
+          InstanceMethod<&CCtx::wrapRefPrefix>("refPrefix",
+                                               napi_default_method),
+          InstanceMethod<&CCtx::wrapGetFrameProgression>(
+              "getFrameProgression", napi_default_method),
+          InstanceMethod<&CCtx::wrapGetStats>("getStats", napi_default_method),
+          InstanceMethod<&CCtx::wrapToFlushNow>("toFlushNow",
+                                                napi_default_method),
       });
   exports.Set("CCtx", func);
 }
@@ -40,13 +72,16 @@ CCtx::CCtx(const Napi::CallbackInfo& info) : ObjectWrapHelper<CCtx>(info) {
 Napi::Value CCtx::wrapCompress(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 3);
+  checkIdle(env);
   int32_t level = info[2].ToNumber();
 
   Uint8Array dstBuf = info[0].As<Uint8Array>();
   Uint8Array srcBuf = info[1].As<Uint8Array>();
+  uint64_t start = beginStats();
   size_t result =
       ZSTD_compressCCtx(cctx.get(), dstBuf.Data(), dstBuf.ByteLength(),
                         srcBuf.Data(), srcBuf.ByteLength(), level);
+  endStats(&stats, cctx.get(), start, srcBuf.ByteLength(), resultSize(result));
   adjustMemory(env);
   return convertZstdResult(env, result);
 }
@@ -54,14 +89,17 @@ Napi::Value CCtx::wrapCompress(const Napi::CallbackInfo& info) {
 Napi::Value CCtx::wrapCompressUsingDict(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 4);
+  checkIdle(env);
   int32_t level = info[3].ToNumber();
 
   Uint8Array dstBuf = info[0].As<Uint8Array>();
   Uint8Array srcBuf = info[1].As<Uint8Array>();
   Uint8Array dictBuf = info[2].As<Uint8Array>();
+  uint64_t start = beginStats();
   size_t result = ZSTD_compress_usingDict(
       cctx.get(), dstBuf.Data(), dstBuf.ByteLength(), srcBuf.Data(),
       srcBuf.ByteLength(), dictBuf.Data(), dictBuf.ByteLength(), level);
+  endStats(&stats, cctx.get(), start, srcBuf.ByteLength(), resultSize(result));
   adjustMemory(env);
   return convertZstdResult(env, result);
 }
@@ -69,20 +107,53 @@ Napi::Value CCtx::wrapCompressUsingDict(const Napi::CallbackInfo& info) {
 Napi::Value CCtx::wrapCompressUsingCDict(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 3);
+  checkIdle(env);
   CDict* cdictObj = CDict::Unwrap(info[2].As<Object>());
 
   Uint8Array dstBuf = info[0].As<Uint8Array>();
   Uint8Array srcBuf = info[1].As<Uint8Array>();
+  uint64_t start = beginStats();
   size_t result = ZSTD_compress_usingCDict(
       cctx.get(), dstBuf.Data(), dstBuf.ByteLength(), srcBuf.Data(),
-      srcBuf.ByteLength(), cdictObj->cdict.get());
+      srcBuf.ByteLength(), cdictObj->get());
+  endStats(&stats, cctx.get(), start, srcBuf.ByteLength(), resultSize(result));
   adjustMemory(env);
   return convertZstdResult(env, result);
 }
 
+Napi::Value CCtx::wrapCompressUsingCDictAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 3);
+  Object cdictWrapper = info[2].As<Object>();
+  CDict* cdictObj = CDict::Unwrap(cdictWrapper);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  ZSTD_CCtx* cctxPtr = cctx.get();
+  Stats* statsPtr = &stats;
+  const ZSTD_CDict* cdictPtr = cdictObj->get();
+  void* dst = dstBuf.Data();
+  size_t dstSize = dstBuf.ByteLength();
+  const void* src = srcBuf.Data();
+  size_t srcSize = srcBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    uint64_t start = beginStats();
+    size_t ret = ZSTD_compress_usingCDict(cctxPtr, dst, dstSize, src, srcSize,
+                                          cdictPtr);
+    endStats(statsPtr, cctxPtr, start, srcSize, resultSize(ret));
+    return ret;
+  });
+  worker->lock(this);
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  worker->pin(cdictWrapper);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
 void CCtx::wrapSetParameter(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 2);
+  checkIdle(env);
   ZSTD_cParameter param =
       static_cast<ZSTD_cParameter>(info[0].ToNumber().Int32Value());
   int value = info[1].ToNumber();
@@ -95,6 +166,7 @@ void CCtx::wrapSetParameter(const Napi::CallbackInfo& info) {
 void CCtx::wrapSetPledgedSrcSize(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 1);
+  checkIdle(env);
   unsigned long long srcSize = info[0].ToNumber().Int64Value();
 
   size_t result = ZSTD_CCtx_setPledgedSrcSize(cctx.get(), srcSize);
@@ -105,29 +177,60 @@ void CCtx::wrapSetPledgedSrcSize(const Napi::CallbackInfo& info) {
 void CCtx::wrapReset(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 1);
+  checkIdle(env);
   ZSTD_ResetDirective reset =
       static_cast<ZSTD_ResetDirective>(info[0].ToNumber().Int32Value());
 
   size_t result = ZSTD_CCtx_reset(cctx.get(), reset);
   adjustMemory(env);
   checkZstdError(env, result);
+  if (reset != ZSTD_reset_session_only)
+    cdictRef.reset();
 }
 
 Napi::Value CCtx::wrapCompress2(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 2);
+  checkIdle(env);
 
   Uint8Array dstBuf = info[0].As<Uint8Array>();
   Uint8Array srcBuf = info[1].As<Uint8Array>();
+  uint64_t start = beginStats();
   size_t result = ZSTD_compress2(cctx.get(), dstBuf.Data(), dstBuf.ByteLength(),
                                  srcBuf.Data(), srcBuf.ByteLength());
+  endStats(&stats, cctx.get(), start, srcBuf.ByteLength(), resultSize(result));
   adjustMemory(env);
   return convertZstdResult(env, result);
 }
 
+Napi::Value CCtx::wrapCompress2Async(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 2);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  ZSTD_CCtx* cctxPtr = cctx.get();
+  Stats* statsPtr = &stats;
+  void* dst = dstBuf.Data();
+  size_t dstSize = dstBuf.ByteLength();
+  const void* src = srcBuf.Data();
+  size_t srcSize = srcBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    uint64_t start = beginStats();
+    size_t ret = ZSTD_compress2(cctxPtr, dst, dstSize, src, srcSize);
+    endStats(statsPtr, cctxPtr, start, srcSize, resultSize(ret));
+    return ret;
+  });
+  worker->lock(this);
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
 Napi::Value CCtx::wrapCompressStream2(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 3);
+  checkIdle(env);
   ZSTD_EndDirective endOp =
       static_cast<ZSTD_EndDirective>(info[2].ToNumber().Int32Value());
 
@@ -135,18 +238,271 @@ Napi::Value CCtx::wrapCompressStream2(const Napi::CallbackInfo& info) {
   Uint8Array srcBuf = info[1].As<Uint8Array>();
   ZSTD_outBuffer zstdOut = makeZstdOutBuffer(dstBuf);
   ZSTD_inBuffer zstdIn = makeZstdInBuffer(srcBuf);
+  uint64_t start = beginStats();
   size_t ret = ZSTD_compressStream2(cctx.get(), &zstdOut, &zstdIn, endOp);
+  endStats(&stats, cctx.get(), start, zstdIn.pos, zstdOut.pos);
   adjustMemory(env);
   return makeStreamResult(env, ret, zstdOut, zstdIn);
 }
 
+Napi::Value CCtx::wrapCompressStream2Async(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 3);
+  ZSTD_EndDirective endOp =
+      static_cast<ZSTD_EndDirective>(info[2].ToNumber().Int32Value());
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  ZSTD_CCtx* cctxPtr = cctx.get();
+  Stats* statsPtr = &stats;
+  auto worker = makeAsyncStreamCall(
+      env, makeZstdOutBuffer(dstBuf), makeZstdInBuffer(srcBuf),
+      [=](ZSTD_outBuffer* zstdOut, ZSTD_inBuffer* zstdIn) {
+        uint64_t start = beginStats();
+        size_t ret = ZSTD_compressStream2(cctxPtr, zstdOut, zstdIn, endOp);
+        endStats(statsPtr, cctxPtr, start, zstdIn->pos, zstdOut->pos);
+        return ret;
+      });
+  worker->lock(this);
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+void CCtx::wrapCompressStream2Into(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 4, 6);
+  checkIdle(env);
+  ZSTD_EndDirective endOp =
+      static_cast<ZSTD_EndDirective>(info[2].ToNumber().Int32Value());
+  double* result = getStreamResultArray(env, info[3]);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  ZSTD_outBuffer zstdOut = makeZstdOutBuffer(dstBuf);
+  ZSTD_inBuffer zstdIn = makeZstdInBuffer(srcBuf);
+  zstdOut.pos = getBufferPos(env, info[4], zstdOut.size);
+  zstdIn.pos = getBufferPos(env, info[5], zstdIn.size);
+  size_t dstPos = zstdOut.pos;
+  size_t srcPos = zstdIn.pos;
+  uint64_t start = beginStats();
+  size_t ret = ZSTD_compressStream2(cctx.get(), &zstdOut, &zstdIn, endOp);
+  endStats(&stats, cctx.get(), start, zstdIn.pos - srcPos,
+           zstdOut.pos - dstPos);
+  adjustMemory(env);
+  storeStreamResult(env, result, ret, zstdOut, zstdIn);
+}
+
+Napi::Value CCtx::wrapCompressBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 4);
+  checkIdle(env);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  Uint32Array srcOffsets = info[2].As<Uint32Array>();
+  Uint32Array dstOffsets = info[3].As<Uint32Array>();
+  Batch batch = makeBatch(env, dstBuf, srcBuf, srcOffsets, dstOffsets);
+  uint64_t start = beginStats();
+  size_t result = runBatch(batch, [&](void* dst, size_t dstCapacity,
+                                      const void* src, size_t srcSize) {
+    return ZSTD_compress2(cctx.get(), dst, dstCapacity, src, srcSize);
+  });
+  endStats(&stats, cctx.get(), start, batchInputSize(batch),
+           resultSize(result));
+  adjustMemory(env);
+  return convertZstdResult(env, result);
+}
+
+Napi::Value CCtx::wrapCompressBatchAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 4);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  Uint32Array srcOffsets = info[2].As<Uint32Array>();
+  Uint32Array dstOffsets = info[3].As<Uint32Array>();
+  Batch batch = makeBatch(env, dstBuf, srcBuf, srcOffsets, dstOffsets);
+  ZSTD_CCtx* cctxPtr = cctx.get();
+  Stats* statsPtr = &stats;
+  auto worker = makeAsyncCall(env, [=]() mutable {
+    uint64_t start = beginStats();
+    size_t ret = runBatch(batch, [=](void* dst, size_t dstCapacity,
+                                     const void* src, size_t srcSize) {
+      return ZSTD_compress2(cctxPtr, dst, dstCapacity, src, srcSize);
+    });
+    endStats(statsPtr, cctxPtr, start, batchInputSize(batch), resultSize(ret));
+    return ret;
+  });
+  worker->lock(this);
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  worker->pin(dstOffsets);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+// Sequences are packed as (offset, litLength, matchLength, rep) quadruples,
+// which is exactly the layout of ZSTD_Sequence, so they're passed through
+// without copying
+static_assert(sizeof(ZSTD_Sequence) == 4 * sizeof(uint32_t),
+              "ZSTD_Sequence must be four packed 32-bit fields");
+
+static const ZSTD_Sequence* getSequences(Napi::Env env,
+                                         Uint32Array& seqBuf,
+                                         size_t& count) {
+  if (seqBuf.ElementLength() % 4 != 0)
+    throw RangeError::New(env, "Sequences must have 4 elements each");
+  count = seqBuf.ElementLength() / 4;
+  return reinterpret_cast<const ZSTD_Sequence*>(seqBuf.Data());
+}
+
+Napi::Value CCtx::wrapCompressSequences(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 3);
+  checkIdle(env);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint32Array seqBuf = info[1].As<Uint32Array>();
+  Uint8Array srcBuf = info[2].As<Uint8Array>();
+  size_t numSeqs;
+  const ZSTD_Sequence* seqs = getSequences(env, seqBuf, numSeqs);
+  uint64_t start = beginStats();
+  size_t result = ZSTD_compressSequences(cctx.get(), dstBuf.Data(),
+                                         dstBuf.ByteLength(), seqs, numSeqs,
+                                         srcBuf.Data(), srcBuf.ByteLength());
+  endStats(&stats, cctx.get(), start, srcBuf.ByteLength(), resultSize(result));
+  adjustMemory(env);
+  return convertZstdResult(env, result);
+}
+
+Napi::Value CCtx::wrapCompressSequencesAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 3);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint32Array seqBuf = info[1].As<Uint32Array>();
+  Uint8Array srcBuf = info[2].As<Uint8Array>();
+  size_t numSeqs;
+  const ZSTD_Sequence* seqs = getSequences(env, seqBuf, numSeqs);
+  ZSTD_CCtx* cctxPtr = cctx.get();
+  Stats* statsPtr = &stats;
+  void* dst = dstBuf.Data();
+  size_t dstSize = dstBuf.ByteLength();
+  const void* src = srcBuf.Data();
+  size_t srcSize = srcBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    uint64_t start = beginStats();
+    size_t ret = ZSTD_compressSequences(cctxPtr, dst, dstSize, seqs, numSeqs,
+                                        src, srcSize);
+    endStats(statsPtr, cctxPtr, start, srcSize, resultSize(ret));
+    return ret;
+  });
+  worker->lock(this);
+  worker->pin(dstBuf);
+  worker->pin(seqBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+void CCtx::wrapRegisterSequenceProducer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+  checkIdle(env);
+
+  if (info[0].IsNull()) {
+    ZSTD_registerSequenceProducer(cctx.get(), nullptr, nullptr);
+    seqProducerRef.Reset();
+    return;
+  }
+  if (!info[0].IsExternal())
+    throw TypeError::New(env, "Expected a sequence producer");
+  auto external = info[0].As<External<ZstdNapiSequenceProducer>>();
+  if (!external.CheckTypeTag(&kSequenceProducerTypeTag))
+    throw TypeError::New(env, "Native object tag mismatch");
+
+  const ZstdNapiSequenceProducer* producer = external.Data();
+  ZSTD_registerSequenceProducer(cctx.get(), producer->state,
+                                producer->producer);
+  seqProducerRef = Persistent(info[0]);
+}
+
 void CCtx::wrapLoadDictionary(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 1);
+  checkIdle(env);
 
   Uint8Array dictBuf = info[0].As<Uint8Array>();
   size_t result = ZSTD_CCtx_loadDictionary(cctx.get(), dictBuf.Data(),
                                            dictBuf.ByteLength());
   adjustMemory(env);
   checkZstdError(env, result);
+  cdictRef.reset();
+}
+
+void CCtx::wrapRefCDict(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+  checkIdle(env);
+  CDict* cdictObj = CDict::Unwrap(info[0].As<Object>());
+
+  size_t result = ZSTD_CCtx_refCDict(cctx.get(), cdictObj->get());
+  adjustMemory(env);
+  checkZstdError(env, result);
+  cdictRef = cdictObj->cdict;
+}
+
+void CCtx::wrapRefPrefix(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+  checkIdle(env);
+
+  Uint8Array prefixBuf = info[0].As<Uint8Array>();
+  size_t result = ZSTD_CCtx_refPrefix(cctx.get(), prefixBuf.Data(),
+                                      prefixBuf.ByteLength());
+  adjustMemory(env);
+  checkZstdError(env, result);
+  prefixRef = Persistent(prefixBuf.As<Object>());
+}
+
+void CCtx::wrapRefThreadPool(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+  checkIdle(env);
+  std::shared_ptr<ZSTD_threadPool> pool;
+  if (!info[0].IsNull())
+    pool = ThreadPool::Unwrap(info[0].As<Object>())->pool;
+
+  size_t result = ZSTD_CCtx_refThreadPool(cctx.get(), pool.get());
+  adjustMemory(env);
+  checkZstdError(env, result);
+  poolRef = std::move(pool);
+}
+
+Napi::Value CCtx::wrapGetFrameProgression(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 0);
+  checkIdle(env);
+
+  ZSTD_frameProgression progression = ZSTD_getFrameProgression(cctx.get());
+  Object result = Object::New(env);
+  result["ingested"] = static_cast<double>(progression.ingested);
+  result["consumed"] = static_cast<double>(progression.consumed);
+  result["produced"] = static_cast<double>(progression.produced);
+  result["flushed"] = static_cast<double>(progression.flushed);
+  result["currentJobID"] = progression.currentJobID;
+  result["nbActiveWorkers"] = progression.nbActiveWorkers;
+  return result;
+}
+
+Napi::Value CCtx::wrapToFlushNow(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 0);
+  checkIdle(env);
+
+  return convertZstdResult(env, ZSTD_toFlushNow(cctx.get()));
+}
+
+Napi::Value CCtx::wrapGetStats(const Napi::CallbackInfo& info) {
+  checkArgCount(info, 0);
+  return stats.toArray(info.Env());
 }
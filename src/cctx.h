@@ -3,7 +3,11 @@
 
 #include <napi.h>
 
+#include <memory>
+
+#include "dict_registry.h"
 #include "object_wrap_helper.h"
+#include "stats.h"
 #include "util.h"
 #include "zstd.h"
 
@@ -14,19 +18,45 @@ class CCtx : public ObjectWrapHelper<CCtx> {
   CCtx(const Napi::CallbackInfo& info);
 
  private:
+  // Declared before the context so they're only released after the context is
+  // freed, since multithreaded jobs may still be using them until then
+  std::shared_ptr<ZSTD_threadPool> poolRef;
+  Napi::Reference<Napi::Value> seqProducerRef;
+  // Keeps a referenced dictionary alive for as long as the context uses it,
+  // even if its wrapper is garbage collected
+  std::shared_ptr<const SharedCDict> cdictRef;
+  // Prefixes are referenced in place, so their buffers are kept alive until
+  // replaced
+  Napi::ObjectReference prefixRef;
   zstd_unique_ptr<ZSTD_CCtx, ZSTD_freeCCtx> cctx;
+  Stats stats;
 
   int64_t getCurrentSize() override { return ZSTD_sizeof_CCtx(cctx.get()); }
 
   Napi::Value wrapCompress(const Napi::CallbackInfo& info);
   Napi::Value wrapCompressUsingDict(const Napi::CallbackInfo& info);
   Napi::Value wrapCompressUsingCDict(const Napi::CallbackInfo& info);
+  Napi::Value wrapCompressUsingCDictAsync(const Napi::CallbackInfo& info);
   void wrapSetParameter(const Napi::CallbackInfo& info);
   void wrapSetPledgedSrcSize(const Napi::CallbackInfo& info);
   void wrapReset(const Napi::CallbackInfo& info);
   Napi::Value wrapCompress2(const Napi::CallbackInfo& info);
+  Napi::Value wrapCompress2Async(const Napi::CallbackInfo& info);
   Napi::Value wrapCompressStream2(const Napi::CallbackInfo& info);
+  Napi::Value wrapCompressStream2Async(const Napi::CallbackInfo& info);
+  void wrapCompressStream2Into(const Napi::CallbackInfo& info);
+  Napi::Value wrapCompressBatch(const Napi::CallbackInfo& info);
+  Napi::Value wrapCompressBatchAsync(const Napi::CallbackInfo& info);
+  Napi::Value wrapCompressSequences(const Napi::CallbackInfo& info);
+  Napi::Value wrapCompressSequencesAsync(const Napi::CallbackInfo& info);
+  void wrapRegisterSequenceProducer(const Napi::CallbackInfo& info);
   void wrapLoadDictionary(const Napi::CallbackInfo& info);
+  void wrapRefCDict(const Napi::CallbackInfo& info);
+  void wrapRefThreadPool(const Napi::CallbackInfo& info);
+  void wrapRefPrefix(const Napi::CallbackInfo& info);
+  Napi::Value wrapGetFrameProgression(const Napi::CallbackInfo& info);
+  Napi::Value wrapToFlushNow(const Napi::CallbackInfo& info);
+  Napi::Value wrapGetStats(const Napi::CallbackInfo& info);
 };
 
 #endif
@@ -1,5 +1,7 @@
 #include "cdict.h"
 
+#include "context_pool.h"
+
 using namespace Napi;
 
 const napi_type_tag CDict::typeTag = {0x9257fdef516e4f9c, 0x3efa685d51e7bb2b};
@@ -15,16 +17,54 @@ void CDict::Init(Napi::Env env, Napi::Object exports) {
 
 CDict::CDict(const Napi::CallbackInfo& info) : ObjectWrapHelper<CDict>(info) {
   Napi::Env env = info.Env();
+  if (info.Length() == 3) {
+    initAdvanced(info);
+    return;
+  }
   checkArgCount(info, 2);
   int32_t level = info[1].ToNumber();
 
   Uint8Array dictBuf = info[0].As<Uint8Array>();
-  cdict.reset(ZSTD_createCDict(dictBuf.Data(), dictBuf.ByteLength(), level));
+  cdict = getSharedCDict(dictBuf.Data(), dictBuf.ByteLength(), level);
   if (!cdict)
     throw Error::New(env, "Failed to create CDict");
   adjustMemory(env);
 }
 
+void CDict::initAdvanced(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ParamList params = readParamList(env, info[1]);
+  bool byRef = info[2].ToBoolean();
+
+  zstd_unique_ptr<ZSTD_CCtx_params, ZSTD_freeCCtxParams> cctxParams(
+      ZSTD_createCCtxParams());
+  if (!cctxParams)
+    throw Error::New(env, "Failed to create CDict");
+  for (size_t i = 0; i < params.size(); i += 2) {
+    ZSTD_cParameter param = static_cast<ZSTD_cParameter>(params[i]);
+    checkZstdError(env, ZSTD_CCtxParams_setParameter(cctxParams.get(), param,
+                                                     params[i + 1]));
+  }
+
+  // Tuned dictionaries aren't registered, since they'd only be shared with
+  // identically tuned ones; refCDict already shares them between contexts
+  Uint8Array dictBuf = info[0].As<Uint8Array>();
+  auto shared = std::make_shared<SharedCDict>();
+  if (byRef) {
+    // Keep the caller's buffer alive instead of copying it
+    shared->contentOwner =
+        std::make_shared<ObjectReference>(Persistent(dictBuf.As<Object>()));
+  }
+  shared->cdict.reset(ZSTD_createCDict_advanced2(
+      dictBuf.Data(), dictBuf.ByteLength(),
+      byRef ? ZSTD_dlm_byRef : ZSTD_dlm_byCopy, ZSTD_dct_auto,
+      cctxParams.get(), ZSTD_defaultCMem));
+  if (!shared->cdict)
+    throw Error::New(env, "Failed to create CDict");
+  cdict = std::move(shared);
+  adjustMemory(env);
+}
+
 Napi::Value CDict::wrapGetDictID(const Napi::CallbackInfo& info) {
-  return Number::New(info.Env(), ZSTD_getDictID_fromCDict(cdict.get()));
+  return Number::New(info.Env(), ZSTD_getDictID_fromCDict(get()));
 }
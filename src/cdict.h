@@ -3,6 +3,9 @@
 
 #include <napi.h>
 
+#include <memory>
+
+#include "dict_registry.h"
 #include "object_wrap_helper.h"
 #include "util.h"
 #include "zstd.h"
@@ -15,9 +18,13 @@ class CDict : public ObjectWrapHelper<CDict> {
 
  private:
   friend class CCtx;
-  zstd_unique_ptr<ZSTD_CDict, ZSTD_freeCDict> cdict;
+  std::shared_ptr<const SharedCDict> cdict;
 
-  int64_t getCurrentSize() { return ZSTD_sizeof_CDict(cdict.get()); }
+  void initAdvanced(const Napi::CallbackInfo& info);
+  const ZSTD_CDict* get() const { return cdict->cdict.get(); }
+  int64_t getCurrentSize() {
+    return ZSTD_sizeof_CDict(get()) + cdict->content.size();
+  }
 
   Napi::Value wrapGetDictID(const Napi::CallbackInfo& info);
 };
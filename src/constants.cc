@@ -1,5 +1,7 @@
 #include "constants.h"
 
+#include "frames.h"
+#include "stats.h"
 #include "zstd.h"
 
 using namespace Napi;
@@ -10,7 +12,9 @@ void createConstants(Env env, Object exports) {
   C(MAGIC_DICTIONARY);
   C(MAGIC_SKIPPABLE_START);
   C(MAGIC_SKIPPABLE_MASK);
+  C(SKIPPABLEHEADERSIZE);
 #undef C
+  exports["FRAME_FIELD_COUNT"] = Number::New(env, kFrameFieldCount);
 }
 
 void createEnums(Env env, Object exports) {
@@ -49,6 +53,7 @@ void createEnums(Env env, Object exports) {
   E(targetLength);
   E(strategy);
   E(targetCBlockSize);
+  E(maxBlockSize);
   E(enableLongDistanceMatching);
   E(ldmHashLog);
   E(ldmMinMatch);
@@ -60,9 +65,22 @@ void createEnums(Env env, Object exports) {
   E(nbWorkers);
   E(jobSize);
   E(overlapLog);
+  E(blockDelimiters);
+  E(validateSequences);
+  E(enableSeqProducerFallback);
+  E(stableInBuffer);
+  E(stableOutBuffer);
 #undef E
   exports["CParameter"] = cParameter;
 
+  // ZSTD_sequenceFormat_e
+  Object sequenceFormat = Object::New(env);
+#define E(name) ADD_ENUM_MEMBER(sequenceFormat, ZSTD_sf_, name, name)
+  E(noBlockDelimiters);
+  E(explicitBlockDelimiters);
+#undef E
+  exports["SequenceFormat"] = sequenceFormat;
+
   // ZSTD_ResetDirective
   Object resetDirective = Object::New(env);
 #define E(name, jname) ADD_ENUM_MEMBER(resetDirective, ZSTD_reset_, name, jname)
@@ -76,6 +94,9 @@ void createEnums(Env env, Object exports) {
   Object dParameter = Object::New(env);
 #define E(name) ADD_ENUM_MEMBER(dParameter, ZSTD_d_, name, name)
   E(windowLogMax);
+  E(refMultipleDDicts);
+  E(maxBlockSize);
+  E(stableOutBuffer);
 #undef E
   exports["DParameter"] = dParameter;
 
@@ -88,5 +109,30 @@ void createEnums(Env env, Object exports) {
 #undef E
   exports["EndDirective"] = endDirective;
 
+  // StatIndex
+  Object stat = Object::New(env);
+#define E(name, jname) ADD_ENUM_MEMBER(stat, kStat, name, jname)
+  E(Calls, calls);
+  E(BytesIn, bytesIn);
+  E(BytesOut, bytesOut);
+  E(Nanos, nanos);
+  E(PeakMemory, peakMemory);
+#undef E
+  exports["Stat"] = stat;
+
+  // FrameField
+  Object frameField = Object::New(env);
+#define E(name, jname) ADD_ENUM_MEMBER(frameField, kFrame, name, jname)
+  E(Offset, offset);
+  E(CompressedSize, compressedSize);
+  E(ContentSize, contentSize);
+  E(DecompressBound, decompressBound);
+  E(WindowSize, windowSize);
+  E(DictID, dictID);
+  E(ChecksumFlag, checksumFlag);
+  E(Type, frameType);
+#undef E
+  exports["FrameField"] = frameField;
+
 #undef ADD_ENUM_MEMBER
 }
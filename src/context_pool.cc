@@ -0,0 +1,78 @@
+#include "context_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "stats.h"
+
+using namespace Napi;
+
+// Enough to keep a context warm for each libuv threadpool thread (plus the
+// main thread) with a few distinct parameter sets in use
+static constexpr size_t kMaxIdleContexts = 16;
+
+// The pools are deliberately leaked, since threadpool jobs may still be
+// running while static destructors run at exit
+CCtxPool& cctxPool() {
+  static CCtxPool* pool = new CCtxPool(kMaxIdleContexts);
+  return *pool;
+}
+
+DCtxPool& dctxPool() {
+  static DCtxPool* pool = new DCtxPool(kMaxIdleContexts);
+  return *pool;
+}
+
+ParamList readParamList(Napi::Env env, Napi::Value value) {
+  Int32Array array = value.As<Int32Array>();
+  size_t length = array.ElementLength();
+  if (length % 2 != 0)
+    throw TypeError::New(env, "Parameter list must have an even length");
+
+  // Sort by parameter so equivalent lists map to the same pooled contexts
+  std::vector<std::pair<int, int>> pairs;
+  pairs.reserve(length / 2);
+  for (size_t i = 0; i < length; i += 2)
+    pairs.emplace_back(array[i], array[i + 1]);
+  std::stable_sort(
+      pairs.begin(), pairs.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  ParamList result;
+  result.reserve(length);
+  for (const auto& pair : pairs) {
+    result.push_back(pair.first);
+    result.push_back(pair.second);
+  }
+  return result;
+}
+
+size_t compressPooled(const ParamList& params,
+                      void* dst,
+                      size_t dstCapacity,
+                      const void* src,
+                      size_t srcSize) {
+  CCtxPool::Lease lease;
+  size_t ret = cctxPool().acquire(params, lease);
+  if (ZSTD_isError(ret))
+    return ret;
+  uint64_t start = beginStats();
+  ret = ZSTD_compress2(lease.get(), dst, dstCapacity, src, srcSize);
+  endStats(nullptr, lease.get(), start, srcSize, resultSize(ret));
+  return ret;
+}
+
+size_t decompressPooled(const ParamList& params,
+                        void* dst,
+                        size_t dstCapacity,
+                        const void* src,
+                        size_t srcSize) {
+  DCtxPool::Lease lease;
+  size_t ret = dctxPool().acquire(params, lease);
+  if (ZSTD_isError(ret))
+    return ret;
+  uint64_t start = beginStats();
+  ret = ZSTD_decompressDCtx(lease.get(), dst, dstCapacity, src, srcSize);
+  endStats(nullptr, lease.get(), start, srcSize, resultSize(ret));
+  return ret;
+}
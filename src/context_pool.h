@@ -0,0 +1,183 @@
+#ifndef CONTEXT_POOL_H
+#define CONTEXT_POOL_H
+
+#include <napi.h>
+
+#include <list>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.h"
+#include "util.h"
+#include "zstd.h"
+#include "zstd_errors.h"
+
+// Flattened (parameter, value) pairs, sorted by parameter. Pooled contexts are
+// keyed by the exact list of parameters applied to them.
+using ParamList = std::vector<int>;
+
+struct CCtxPoolTraits {
+  using Context = ZSTD_CCtx;
+  using Ptr = zstd_unique_ptr<ZSTD_CCtx, ZSTD_freeCCtx>;
+
+  static ZSTD_CCtx* create() { return ZSTD_createCCtx(); }
+  static size_t reset(ZSTD_CCtx* cctx) {
+    return ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+  }
+  static size_t setParameter(ZSTD_CCtx* cctx, int param, int value) {
+    if (param == ZSTD_c_nbWorkers && value > 0) {
+      // Share workers with every other context instead of starting private
+      // ones, which idle pooled contexts would otherwise keep alive
+      const SharedThreadPool& shared = sharedThreadPool();
+      if (shared.pool) {
+        size_t ret = ZSTD_CCtx_refThreadPool(cctx, shared.pool.get());
+        if (ZSTD_isError(ret))
+          return ret;
+      }
+    }
+    return ZSTD_CCtx_setParameter(cctx, static_cast<ZSTD_cParameter>(param),
+                                  value);
+  }
+};
+
+struct DCtxPoolTraits {
+  using Context = ZSTD_DCtx;
+  using Ptr = zstd_unique_ptr<ZSTD_DCtx, ZSTD_freeDCtx>;
+
+  static ZSTD_DCtx* create() { return ZSTD_createDCtx(); }
+  static size_t reset(ZSTD_DCtx* dctx) {
+    return ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+  }
+  static size_t setParameter(ZSTD_DCtx* dctx, int param, int value) {
+    return ZSTD_DCtx_setParameter(dctx, static_cast<ZSTD_dParameter>(param),
+                                  value);
+  }
+};
+
+// Thread-safe pool of idle contexts, shared by every caller in the process.
+// Callers get a context that already has the requested parameters applied
+// whenever one is available. Once more than maxIdle contexts are idle, the
+// least recently used ones are freed.
+template <typename Traits>
+class ContextPool {
+ public:
+  using Context = typename Traits::Context;
+  using Ptr = typename Traits::Ptr;
+
+  // Exclusive use of a pooled context, which goes back to the pool when the
+  // lease is destroyed
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(Lease&&) = default;
+    ~Lease() {
+      if (ctx)
+        pool->release(std::move(params), std::move(ctx));
+    }
+
+    Context* get() const { return ctx.get(); }
+
+   private:
+    friend class ContextPool;
+    ContextPool* pool = nullptr;
+    ParamList params;
+    Ptr ctx;
+  };
+
+  explicit ContextPool(size_t maxIdle) : maxIdle(maxIdle) {}
+
+  // Fills in `lease` with a context configured with exactly `params`. Returns
+  // a zstd error code if no context could be created or configured.
+  size_t acquire(const ParamList& params, Lease& lease);
+
+ private:
+  struct Entry {
+    ParamList params;
+    Ptr ctx;
+  };
+
+  std::mutex mutex;
+  // Most recently used contexts are at the front
+  std::list<Entry> idle;
+  size_t maxIdle;
+
+  void release(ParamList params, Ptr ctx);
+};
+
+template <typename Traits>
+size_t ContextPool<Traits>::acquire(const ParamList& params, Lease& lease) {
+  Ptr ctx;
+  bool configured = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = idle.begin(); it != idle.end(); ++it) {
+      if (it->params == params) {
+        ctx = std::move(it->ctx);
+        idle.erase(it);
+        configured = true;
+        break;
+      }
+    }
+    // No exact match, so repurpose the least recently used idle context
+    if (!ctx && !idle.empty()) {
+      ctx = std::move(idle.back().ctx);
+      idle.pop_back();
+    }
+  }
+
+  if (!ctx) {
+    ctx.reset(Traits::create());
+    if (!ctx)
+      return static_cast<size_t>(-ZSTD_error_memory_allocation);
+  }
+  if (!configured) {
+    // Contexts with a failed configuration are freed rather than pooled
+    size_t ret = Traits::reset(ctx.get());
+    if (ZSTD_isError(ret))
+      return ret;
+    for (size_t i = 0; i + 1 < params.size(); i += 2) {
+      ret = Traits::setParameter(ctx.get(), params[i], params[i + 1]);
+      if (ZSTD_isError(ret))
+        return ret;
+    }
+  }
+
+  lease.pool = this;
+  lease.params = params;
+  lease.ctx = std::move(ctx);
+  return 0;
+}
+
+template <typename Traits>
+void ContextPool<Traits>::release(ParamList params, Ptr ctx) {
+  // Declared before the lock so the context is freed after it's released
+  Ptr evicted;
+  std::lock_guard<std::mutex> lock(mutex);
+  idle.push_front(Entry{std::move(params), std::move(ctx)});
+  if (idle.size() > maxIdle) {
+    evicted = std::move(idle.back().ctx);
+    idle.pop_back();
+  }
+}
+
+using CCtxPool = ContextPool<CCtxPoolTraits>;
+using DCtxPool = ContextPool<DCtxPoolTraits>;
+
+CCtxPool& cctxPool();
+DCtxPool& dctxPool();
+
+ParamList readParamList(Napi::Env env, Napi::Value value);
+
+size_t compressPooled(const ParamList& params,
+                      void* dst,
+                      size_t dstCapacity,
+                      const void* src,
+                      size_t srcSize);
+size_t decompressPooled(const ParamList& params,
+                        void* dst,
+                        size_t dstCapacity,
+                        const void* src,
+                        size_t srcSize);
+
+#endif
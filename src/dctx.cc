@@ -1,9 +1,27 @@
 #include "dctx.h"
 
+#include <algorithm>
+
+#include "async_worker.h"
+#include "batch.h"
 #include "ddict.h"
 
 using namespace Napi;
 
+// ZSTD_decompressStream stops at the end of each frame, so this keeps calling
+// it until all of the input is consumed or the output is full. Always makes at
+// least one call, so data still buffered from a previous call gets flushed.
+static size_t decompressFrames(ZSTD_DCtx* dctx,
+                               ZSTD_outBuffer* zstdOut,
+                               ZSTD_inBuffer* zstdIn) {
+  size_t ret;
+  do {
+    ret = ZSTD_decompressStream(dctx, zstdOut, zstdIn);
+  } while (!ZSTD_isError(ret) && zstdIn->pos < zstdIn->size &&
+           zstdOut->pos < zstdOut->size);
+  return ret;
+}
+
 const napi_type_tag DCtx::typeTag = {0x1c73d7689d424a96, 0x45bc0e392233f8ca};
 
 void DCtx::Init(Napi::Env env, Napi::Object exports) {
@@ -12,8 +30,22 @@ void DCtx::Init(Napi::Env env, Napi::Object exports) {
       {
           InstanceMethod<&DCtx::wrapDecompress>("decompress",
                                                 napi_default_method),
+          InstanceMethod<&DCtx::wrapDecompressAsync>("decompressAsync",
+                                                     napi_default_method),
           InstanceMethod<&DCtx::wrapDecompressStream>("decompressStream",
                                                       napi_default_method),
+          InstanceMethod<&DCtx::wrapDecompressStreamAsync>(
+              "decompressStreamAsync", napi_default_method),
+          InstanceMethod<&DCtx::wrapDecompressStreamInto>(
+              "decompressStreamInto", napi_default_method),
+          InstanceMethod<&DCtx::wrapDecompressFrames>("decompressFrames",
+                                                      napi_default_method),
+          InstanceMethod<&DCtx::wrapDecompressFramesAsync>(
+              "decompressFramesAsync", napi_default_method),
+          InstanceMethod<&DCtx::wrapDecompressBatch>("decompressBatch",
+                                                     napi_default_method),
+          InstanceMethod<&DCtx::wrapDecompressBatchAsync>(
+              "decompressBatchAsync", napi_default_method),
           InstanceMethod<&DCtx::wrapDecompressUsingDict>("decompressUsingDict",
                                                          napi_default_method),
           InstanceMethod<&DCtx::wrapDecompressUsingDDict>(
@@ -23,6 +55,10 @@ void DCtx::Init(Napi::Env env, Napi::Object exports) {
           InstanceMethod<&DCtx::wrapReset>("reset", napi_default_method),
           InstanceMethod<&DCtx::wrapLoadDictionary>("loadDictionary",
                                                     napi_default_method),
+          InstanceMethod<&DCtx::wrapRefDDict>("refDDict", napi_default_method),
+          InstanceMethod<&DCtx::wrapRefPrefix>("refPrefix",
+                                               napi_default_method),
+          InstanceMethod<&DCtx::wrapGetStats>("getStats", napi_default_method),
       });
   exports.Set("DCtx", func);
 }
@@ -37,39 +73,199 @@ DCtx::DCtx(const Napi::CallbackInfo& info) : ObjectWrapHelper<DCtx>(info) {
 Napi::Value DCtx::wrapDecompress(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 2);
+  checkIdle(env);
 
   Uint8Array dstBuf = info[0].As<Uint8Array>();
   Uint8Array srcBuf = info[1].As<Uint8Array>();
+  uint64_t start = beginStats();
   size_t result =
       ZSTD_decompressDCtx(dctx.get(), dstBuf.Data(), dstBuf.ByteLength(),
                           srcBuf.Data(), srcBuf.ByteLength());
+  endStats(&stats, dctx.get(), start, srcBuf.ByteLength(), resultSize(result));
   adjustMemory(env);
   return convertZstdResult(env, result);
 }
 
+Napi::Value DCtx::wrapDecompressAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 2);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  ZSTD_DCtx* dctxPtr = dctx.get();
+  Stats* statsPtr = &stats;
+  void* dst = dstBuf.Data();
+  size_t dstSize = dstBuf.ByteLength();
+  const void* src = srcBuf.Data();
+  size_t srcSize = srcBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    uint64_t start = beginStats();
+    size_t ret = ZSTD_decompressDCtx(dctxPtr, dst, dstSize, src, srcSize);
+    endStats(statsPtr, dctxPtr, start, srcSize, resultSize(ret));
+    return ret;
+  });
+  worker->lock(this);
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
 Napi::Value DCtx::wrapDecompressStream(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 2);
+  checkIdle(env);
 
   Uint8Array dstBuf = info[0].As<Uint8Array>();
   Uint8Array srcBuf = info[1].As<Uint8Array>();
   ZSTD_outBuffer zstdOut = makeZstdOutBuffer(dstBuf);
   ZSTD_inBuffer zstdIn = makeZstdInBuffer(srcBuf);
+  uint64_t start = beginStats();
   size_t ret = ZSTD_decompressStream(dctx.get(), &zstdOut, &zstdIn);
+  endStats(&stats, dctx.get(), start, zstdIn.pos, zstdOut.pos);
+  adjustMemory(env);
+  return makeStreamResult(env, ret, zstdOut, zstdIn);
+}
+
+Napi::Value DCtx::wrapDecompressStreamAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 2);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  ZSTD_DCtx* dctxPtr = dctx.get();
+  Stats* statsPtr = &stats;
+  auto worker = makeAsyncStreamCall(
+      env, makeZstdOutBuffer(dstBuf), makeZstdInBuffer(srcBuf),
+      [=](ZSTD_outBuffer* zstdOut, ZSTD_inBuffer* zstdIn) {
+        uint64_t start = beginStats();
+        size_t ret = ZSTD_decompressStream(dctxPtr, zstdOut, zstdIn);
+        endStats(statsPtr, dctxPtr, start, zstdIn->pos, zstdOut->pos);
+        return ret;
+      });
+  worker->lock(this);
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+void DCtx::wrapDecompressStreamInto(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 3, 4);
+  checkIdle(env);
+  double* result = getStreamResultArray(env, info[2]);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  ZSTD_outBuffer zstdOut = makeZstdOutBuffer(dstBuf);
+  ZSTD_inBuffer zstdIn = makeZstdInBuffer(srcBuf);
+  zstdOut.pos = getBufferPos(env, info[3], zstdOut.size);
+  size_t dstPos = zstdOut.pos;
+  uint64_t start = beginStats();
+  size_t ret = ZSTD_decompressStream(dctx.get(), &zstdOut, &zstdIn);
+  endStats(&stats, dctx.get(), start, zstdIn.pos, zstdOut.pos - dstPos);
+  adjustMemory(env);
+  storeStreamResult(env, result, ret, zstdOut, zstdIn);
+}
+
+Napi::Value DCtx::wrapDecompressFrames(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 2);
+  checkIdle(env);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  ZSTD_outBuffer zstdOut = makeZstdOutBuffer(dstBuf);
+  ZSTD_inBuffer zstdIn = makeZstdInBuffer(srcBuf);
+  uint64_t start = beginStats();
+  size_t ret = decompressFrames(dctx.get(), &zstdOut, &zstdIn);
+  endStats(&stats, dctx.get(), start, zstdIn.pos, zstdOut.pos);
   adjustMemory(env);
   return makeStreamResult(env, ret, zstdOut, zstdIn);
 }
 
+Napi::Value DCtx::wrapDecompressFramesAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 2);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  ZSTD_DCtx* dctxPtr = dctx.get();
+  Stats* statsPtr = &stats;
+  auto worker = makeAsyncStreamCall(
+      env, makeZstdOutBuffer(dstBuf), makeZstdInBuffer(srcBuf),
+      [=](ZSTD_outBuffer* zstdOut, ZSTD_inBuffer* zstdIn) {
+        uint64_t start = beginStats();
+        size_t ret = decompressFrames(dctxPtr, zstdOut, zstdIn);
+        endStats(statsPtr, dctxPtr, start, zstdIn->pos, zstdOut->pos);
+        return ret;
+      });
+  worker->lock(this);
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+Napi::Value DCtx::wrapDecompressBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 4);
+  checkIdle(env);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  Uint32Array srcOffsets = info[2].As<Uint32Array>();
+  Uint32Array dstOffsets = info[3].As<Uint32Array>();
+  Batch batch = makeBatch(env, dstBuf, srcBuf, srcOffsets, dstOffsets);
+  uint64_t start = beginStats();
+  size_t result = runBatch(batch, [&](void* dst, size_t dstCapacity,
+                                      const void* src, size_t srcSize) {
+    return ZSTD_decompressDCtx(dctx.get(), dst, dstCapacity, src, srcSize);
+  });
+  endStats(&stats, dctx.get(), start, batchInputSize(batch),
+           resultSize(result));
+  adjustMemory(env);
+  return convertZstdResult(env, result);
+}
+
+Napi::Value DCtx::wrapDecompressBatchAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 4);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  Uint32Array srcOffsets = info[2].As<Uint32Array>();
+  Uint32Array dstOffsets = info[3].As<Uint32Array>();
+  Batch batch = makeBatch(env, dstBuf, srcBuf, srcOffsets, dstOffsets);
+  ZSTD_DCtx* dctxPtr = dctx.get();
+  Stats* statsPtr = &stats;
+  auto worker = makeAsyncCall(env, [=]() mutable {
+    uint64_t start = beginStats();
+    size_t ret = runBatch(batch, [=](void* dst, size_t dstCapacity,
+                                     const void* src, size_t srcSize) {
+      return ZSTD_decompressDCtx(dctxPtr, dst, dstCapacity, src, srcSize);
+    });
+    endStats(statsPtr, dctxPtr, start, batchInputSize(batch), resultSize(ret));
+    return ret;
+  });
+  worker->lock(this);
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  worker->pin(dstOffsets);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
 Napi::Value DCtx::wrapDecompressUsingDict(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 3);
+  checkIdle(env);
 
   Uint8Array dstBuf = info[0].As<Uint8Array>();
   Uint8Array srcBuf = info[1].As<Uint8Array>();
   Uint8Array dictBuf = info[2].As<Uint8Array>();
+  uint64_t start = beginStats();
   size_t result = ZSTD_decompress_usingDict(
       dctx.get(), dstBuf.Data(), dstBuf.ByteLength(), srcBuf.Data(),
       srcBuf.ByteLength(), dictBuf.Data(), dictBuf.ByteLength());
+  endStats(&stats, dctx.get(), start, srcBuf.ByteLength(), resultSize(result));
   adjustMemory(env);
   return convertZstdResult(env, result);
 }
@@ -77,13 +273,16 @@ Napi::Value DCtx::wrapDecompressUsingDict(const Napi::CallbackInfo& info) {
 Napi::Value DCtx::wrapDecompressUsingDDict(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 3);
+  checkIdle(env);
   DDict* ddictObj = DDict::Unwrap(info[2].As<Object>());
 
   Uint8Array dstBuf = info[0].As<Uint8Array>();
   Uint8Array srcBuf = info[1].As<Uint8Array>();
+  uint64_t start = beginStats();
   size_t result = ZSTD_decompress_usingDDict(
       dctx.get(), dstBuf.Data(), dstBuf.ByteLength(), srcBuf.Data(),
-      srcBuf.ByteLength(), ddictObj->ddict.get());
+      srcBuf.ByteLength(), ddictObj->get());
+  endStats(&stats, dctx.get(), start, srcBuf.ByteLength(), resultSize(result));
   adjustMemory(env);
   return convertZstdResult(env, result);
 }
@@ -91,6 +290,7 @@ Napi::Value DCtx::wrapDecompressUsingDDict(const Napi::CallbackInfo& info) {
 void DCtx::wrapSetParameter(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 2);
+  checkIdle(env);
   ZSTD_dParameter param =
       static_cast<ZSTD_dParameter>(info[0].ToNumber().Int32Value());
   int value = info[1].ToNumber();
@@ -103,21 +303,64 @@ void DCtx::wrapSetParameter(const Napi::CallbackInfo& info) {
 void DCtx::wrapReset(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 1);
+  checkIdle(env);
   ZSTD_ResetDirective reset =
       static_cast<ZSTD_ResetDirective>(info[0].ToNumber().Int32Value());
 
   size_t result = ZSTD_DCtx_reset(dctx.get(), reset);
   adjustMemory(env);
   checkZstdError(env, result);
+  if (reset != ZSTD_reset_session_only)
+    ddictRef.reset();
 }
 
 void DCtx::wrapLoadDictionary(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
   checkArgCount(info, 1);
+  checkIdle(env);
 
   Uint8Array dictBuf = info[0].As<Uint8Array>();
   size_t result = ZSTD_DCtx_loadDictionary(dctx.get(), dictBuf.Data(),
                                            dictBuf.ByteLength());
   adjustMemory(env);
   checkZstdError(env, result);
+  ddictRef.reset();
+}
+
+void DCtx::wrapRefDDict(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+  checkIdle(env);
+  DDict* ddictObj = DDict::Unwrap(info[0].As<Object>());
+
+  int multiple = 0;
+  checkZstdError(env, ZSTD_DCtx_getParameter(
+                          dctx.get(), ZSTD_d_refMultipleDDicts, &multiple));
+  size_t result = ZSTD_DCtx_refDDict(dctx.get(), ddictObj->get());
+  adjustMemory(env);
+  checkZstdError(env, result);
+  ddictRef = ddictObj->ddict;
+  if (multiple == ZSTD_rmd_refMultipleDDicts &&
+      std::find(ddictSetRefs.begin(), ddictSetRefs.end(), ddictRef) ==
+          ddictSetRefs.end()) {
+    ddictSetRefs.push_back(ddictRef);
+  }
+}
+
+void DCtx::wrapRefPrefix(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+  checkIdle(env);
+
+  Uint8Array prefixBuf = info[0].As<Uint8Array>();
+  size_t result = ZSTD_DCtx_refPrefix(dctx.get(), prefixBuf.Data(),
+                                      prefixBuf.ByteLength());
+  adjustMemory(env);
+  checkZstdError(env, result);
+  prefixRef = Persistent(prefixBuf.As<Object>());
+}
+
+Napi::Value DCtx::wrapGetStats(const Napi::CallbackInfo& info) {
+  checkArgCount(info, 0);
+  return stats.toArray(info.Env());
 }
@@ -3,7 +3,12 @@
 
 #include <napi.h>
 
+#include <memory>
+#include <vector>
+
+#include "dict_registry.h"
 #include "object_wrap_helper.h"
+#include "stats.h"
 #include "util.h"
 #include "zstd.h"
 
@@ -15,16 +20,36 @@ class DCtx : public ObjectWrapHelper<DCtx> {
 
  private:
   zstd_unique_ptr<ZSTD_DCtx, ZSTD_freeDCtx> dctx;
+  // Keep referenced dictionaries alive for as long as the context may use
+  // them. Dictionaries referenced in multiple-dictionary mode stay in
+  // libzstd's lookup table until the context is freed, so they're never
+  // released early.
+  std::shared_ptr<const SharedDDict> ddictRef;
+  std::vector<std::shared_ptr<const SharedDDict>> ddictSetRefs;
+  // Prefixes are referenced in place, so their buffers are kept alive until
+  // replaced
+  Napi::ObjectReference prefixRef;
+  Stats stats;
 
   int64_t getCurrentSize() { return ZSTD_sizeof_DCtx(dctx.get()); }
 
   Napi::Value wrapDecompress(const Napi::CallbackInfo& info);
+  Napi::Value wrapDecompressAsync(const Napi::CallbackInfo& info);
   Napi::Value wrapDecompressStream(const Napi::CallbackInfo& info);
+  Napi::Value wrapDecompressStreamAsync(const Napi::CallbackInfo& info);
+  void wrapDecompressStreamInto(const Napi::CallbackInfo& info);
+  Napi::Value wrapDecompressFrames(const Napi::CallbackInfo& info);
+  Napi::Value wrapDecompressFramesAsync(const Napi::CallbackInfo& info);
+  Napi::Value wrapDecompressBatch(const Napi::CallbackInfo& info);
+  Napi::Value wrapDecompressBatchAsync(const Napi::CallbackInfo& info);
   Napi::Value wrapDecompressUsingDict(const Napi::CallbackInfo& info);
   Napi::Value wrapDecompressUsingDDict(const Napi::CallbackInfo& info);
   void wrapSetParameter(const Napi::CallbackInfo& info);
   void wrapReset(const Napi::CallbackInfo& info);
   void wrapLoadDictionary(const Napi::CallbackInfo& info);
+  void wrapRefDDict(const Napi::CallbackInfo& info);
+  void wrapRefPrefix(const Napi::CallbackInfo& info);
+  Napi::Value wrapGetStats(const Napi::CallbackInfo& info);
 };
 
 #endif
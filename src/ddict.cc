@@ -18,12 +18,12 @@ DDict::DDict(const Napi::CallbackInfo& info) : ObjectWrapHelper<DDict>(info) {
   checkArgCount(info, 1);
 
   Uint8Array dictBuf = info[0].As<Uint8Array>();
-  ddict.reset(ZSTD_createDDict(dictBuf.Data(), dictBuf.ByteLength()));
+  ddict = getSharedDDict(dictBuf.Data(), dictBuf.ByteLength());
   if (!ddict)
     throw Error::New(env, "Failed to create DDict");
   adjustMemory(env);
 }
 
 Napi::Value DDict::wrapGetDictID(const Napi::CallbackInfo& info) {
-  return Number::New(info.Env(), ZSTD_getDictID_fromDDict(ddict.get()));
+  return Number::New(info.Env(), ZSTD_getDictID_fromDDict(get()));
 }
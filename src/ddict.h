@@ -3,6 +3,9 @@
 
 #include <napi.h>
 
+#include <memory>
+
+#include "dict_registry.h"
 #include "object_wrap_helper.h"
 #include "util.h"
 #include "zstd.h"
@@ -15,9 +18,12 @@ class DDict : public ObjectWrapHelper<DDict> {
 
  private:
   friend class DCtx;
-  zstd_unique_ptr<ZSTD_DDict, ZSTD_freeDDict> ddict;
+  std::shared_ptr<const SharedDDict> ddict;
 
-  int64_t getCurrentSize() { return ZSTD_sizeof_DDict(ddict.get()); }
+  const ZSTD_DDict* get() const { return ddict->ddict.get(); }
+  int64_t getCurrentSize() {
+    return ZSTD_sizeof_DDict(get()) + ddict->content.size();
+  }
 
   Napi::Value wrapGetDictID(const Napi::CallbackInfo& info);
 };
@@ -0,0 +1,218 @@
+#include "dict_builder.h"
+
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "async_worker.h"
+#include "util.h"
+
+#define ZDICT_STATIC_LINKING_ONLY
+#include "zdict.h"
+
+using namespace Napi;
+
+// Training samples are passed as a single buffer holding every sample
+// back-to-back, plus an array of their sizes, so large training sets don't need
+// a JS object per sample
+struct Samples {
+  const void* data;
+  // Copied (and widened), so JS can't change them during training
+  std::vector<size_t> sizes;
+};
+
+static Samples readSamples(Env env,
+                           Uint8Array& samplesBuf,
+                           Uint32Array& sampleSizes) {
+  Samples samples;
+  samples.data = samplesBuf.Data();
+  samples.sizes.assign(sampleSizes.Data(),
+                       sampleSizes.Data() + sampleSizes.ElementLength());
+  uint64_t total = std::accumulate(samples.sizes.begin(), samples.sizes.end(),
+                                   static_cast<uint64_t>(0));
+  if (total > samplesBuf.ByteLength())
+    throw RangeError::New(env, "Sample sizes exceed samples buffer length");
+  return samples;
+}
+
+static unsigned getUnsigned(Object params, const char* key) {
+  Value value = params.Get(key);
+  return value.IsUndefined() ? 0 : value.ToNumber().Uint32Value();
+}
+
+static ZDICT_params_t readZDictParams(Object params) {
+  ZDICT_params_t result = {};
+  Value level = params.Get("compressionLevel");
+  if (!level.IsUndefined())
+    result.compressionLevel = level.ToNumber().Int32Value();
+  result.dictID = getUnsigned(params, "dictID");
+  return result;
+}
+
+template <typename P>
+static void readCommonCoverParams(Object params, P& result) {
+  result.k = getUnsigned(params, "k");
+  result.d = getUnsigned(params, "d");
+  result.steps = getUnsigned(params, "steps");
+  result.nbThreads = getUnsigned(params, "nbThreads");
+  Value splitPoint = params.Get("splitPoint");
+  if (!splitPoint.IsUndefined())
+    result.splitPoint = splitPoint.ToNumber().DoubleValue();
+  result.shrinkDict = params.Get("shrinkDict").ToBoolean() ? 1 : 0;
+  result.shrinkDictMaxRegression =
+      getUnsigned(params, "shrinkDictMaxRegression");
+  result.zParams = readZDictParams(params);
+}
+
+static ZDICT_cover_params_t readCoverParams(Value value) {
+  ZDICT_cover_params_t result = {};
+  readCommonCoverParams(value.As<Object>(), result);
+  return result;
+}
+
+static ZDICT_fastCover_params_t readFastCoverParams(Value value) {
+  Object params = value.As<Object>();
+  ZDICT_fastCover_params_t result = {};
+  readCommonCoverParams(params, result);
+  result.f = getUnsigned(params, "f");
+  result.accel = getUnsigned(params, "accel");
+  return result;
+}
+
+static void setTunedParams(Object& result, const ZDICT_cover_params_t& params) {
+  result["k"] = params.k;
+  result["d"] = params.d;
+  result["steps"] = params.steps;
+  result["splitPoint"] = params.splitPoint;
+}
+
+static void setTunedParams(Object& result,
+                           const ZDICT_fastCover_params_t& params) {
+  result["k"] = params.k;
+  result["d"] = params.d;
+  result["f"] = params.f;
+  result["steps"] = params.steps;
+  result["splitPoint"] = params.splitPoint;
+  result["accel"] = params.accel;
+}
+
+// The optimizing trainers write back the parameters they settled on, so these
+// resolve to those alongside the dictionary size
+template <typename P, typename F>
+class OptimizeTrainCall : public ZstdAsyncWorker {
+ public:
+  OptimizeTrainCall(Napi::Env env, P params, F fn)
+      : ZstdAsyncWorker(env), params(params), fn(std::move(fn)) {}
+
+ protected:
+  size_t run() override { return fn(&params); }
+  Napi::Value makeResult(Napi::Env env) override {
+    Object result = Object::New(env);
+    result["dictSize"] = ret;
+    setTunedParams(result, params);
+    return result;
+  }
+
+ private:
+  P params;
+  F fn;
+};
+
+template <typename P, typename F>
+static std::unique_ptr<ZstdAsyncWorker> makeOptimizeTrainCall(Napi::Env env,
+                                                              P params,
+                                                              F fn) {
+  return std::make_unique<OptimizeTrainCall<P, F>>(env, params,
+                                                   std::move(fn));
+}
+
+Value wrapTrainFromBuffer(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 3);
+
+  Uint8Array dictBuf = info[0].As<Uint8Array>();
+  Uint8Array samplesBuf = info[1].As<Uint8Array>();
+  Uint32Array sampleSizes = info[2].As<Uint32Array>();
+  Samples samples = readSamples(env, samplesBuf, sampleSizes);
+  void* dict = dictBuf.Data();
+  size_t dictCapacity = dictBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    return ZDICT_trainFromBuffer(dict, dictCapacity, samples.data,
+                                 samples.sizes.data(),
+                                 static_cast<unsigned>(samples.sizes.size()));
+  });
+  worker->pin(dictBuf);
+  worker->pin(samplesBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+Value wrapOptimizeTrainFromBufferCover(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 4);
+
+  Uint8Array dictBuf = info[0].As<Uint8Array>();
+  Uint8Array samplesBuf = info[1].As<Uint8Array>();
+  Uint32Array sampleSizes = info[2].As<Uint32Array>();
+  Samples samples = readSamples(env, samplesBuf, sampleSizes);
+  ZDICT_cover_params_t params = readCoverParams(info[3]);
+  void* dict = dictBuf.Data();
+  size_t dictCapacity = dictBuf.ByteLength();
+  auto worker = makeOptimizeTrainCall(
+      env, params, [=](ZDICT_cover_params_t* tuned) {
+        return ZDICT_optimizeTrainFromBuffer_cover(
+            dict, dictCapacity, samples.data, samples.sizes.data(),
+            static_cast<unsigned>(samples.sizes.size()), tuned);
+      });
+  worker->pin(dictBuf);
+  worker->pin(samplesBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+Value wrapOptimizeTrainFromBufferFastCover(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 4);
+
+  Uint8Array dictBuf = info[0].As<Uint8Array>();
+  Uint8Array samplesBuf = info[1].As<Uint8Array>();
+  Uint32Array sampleSizes = info[2].As<Uint32Array>();
+  Samples samples = readSamples(env, samplesBuf, sampleSizes);
+  ZDICT_fastCover_params_t params = readFastCoverParams(info[3]);
+  void* dict = dictBuf.Data();
+  size_t dictCapacity = dictBuf.ByteLength();
+  auto worker = makeOptimizeTrainCall(
+      env, params, [=](ZDICT_fastCover_params_t* tuned) {
+        return ZDICT_optimizeTrainFromBuffer_fastCover(
+            dict, dictCapacity, samples.data, samples.sizes.data(),
+            static_cast<unsigned>(samples.sizes.size()), tuned);
+      });
+  worker->pin(dictBuf);
+  worker->pin(samplesBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+Value wrapFinalizeDictionary(const CallbackInfo& info) {
+  Env env = info.Env();
+  checkArgCount(info, 5);
+
+  Uint8Array dictBuf = info[0].As<Uint8Array>();
+  Uint8Array contentBuf = info[1].As<Uint8Array>();
+  Uint8Array samplesBuf = info[2].As<Uint8Array>();
+  Uint32Array sampleSizes = info[3].As<Uint32Array>();
+  Samples samples = readSamples(env, samplesBuf, sampleSizes);
+  ZDICT_params_t params = readZDictParams(info[4].As<Object>());
+  void* dict = dictBuf.Data();
+  size_t dictCapacity = dictBuf.ByteLength();
+  const void* content = contentBuf.Data();
+  size_t contentSize = contentBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    return ZDICT_finalizeDictionary(dict, dictCapacity, content, contentSize,
+                                    samples.data, samples.sizes.data(),
+                                    static_cast<unsigned>(samples.sizes.size()),
+                                    params);
+  });
+  worker->pin(dictBuf);
+  worker->pin(contentBuf);
+  worker->pin(samplesBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
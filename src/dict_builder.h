@@ -0,0 +1,12 @@
+#ifndef DICT_BUILDER_H
+#define DICT_BUILDER_H
+
+#include <napi.h>
+
+Napi::Value wrapTrainFromBuffer(const Napi::CallbackInfo& info);
+Napi::Value wrapOptimizeTrainFromBufferCover(const Napi::CallbackInfo& info);
+Napi::Value wrapOptimizeTrainFromBufferFastCover(
+    const Napi::CallbackInfo& info);
+Napi::Value wrapFinalizeDictionary(const Napi::CallbackInfo& info);
+
+#endif
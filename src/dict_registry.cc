@@ -0,0 +1,108 @@
+#include "dict_registry.h"
+
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+// Tracks the digested dictionaries currently in use, without keeping them
+// alive: each is freed as soon as the last context or wrapper referencing it
+// lets go. Entries are keyed by dictionary ID (and level), but always matched
+// on the full content, so raw-content dictionaries are handled correctly.
+template <typename Entry>
+class DictRegistry {
+ public:
+  using Ptr = std::shared_ptr<const Entry>;
+
+  template <typename Create>
+  Ptr get(uint64_t key, const void* dict, size_t dictSize, Create create) {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      if (Ptr entry = find(key, dict, dictSize))
+        return entry;
+    }
+
+    // Digesting can be slow, so don't block other lookups while it runs
+    std::shared_ptr<Entry> created = create();
+    if (!created)
+      return nullptr;
+
+    std::lock_guard<std::mutex> guard(mutex);
+    // Another thread may have created the same dictionary in the meantime
+    if (Ptr entry = find(key, dict, dictSize))
+      return entry;
+    sweep();
+    entries.emplace(key, created);
+    return created;
+  }
+
+ private:
+  std::mutex mutex;
+  std::unordered_multimap<uint64_t, std::weak_ptr<const Entry>> entries;
+
+  Ptr find(uint64_t key, const void* dict, size_t dictSize) {
+    auto range = entries.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+      Ptr entry = it->second.lock();
+      if (entry && entry->content.size() == dictSize &&
+          (dictSize == 0 ||
+           std::memcmp(entry->content.data(), dict, dictSize) == 0)) {
+        return entry;
+      }
+    }
+    return nullptr;
+  }
+
+  void sweep() {
+    for (auto it = entries.begin(); it != entries.end();) {
+      if (it->second.expired())
+        it = entries.erase(it);
+      else
+        ++it;
+    }
+  }
+};
+
+// The registries are deliberately leaked, for the same reason as the context
+// pools
+static DictRegistry<SharedCDict>& cdictRegistry() {
+  static DictRegistry<SharedCDict>* registry = new DictRegistry<SharedCDict>();
+  return *registry;
+}
+
+static DictRegistry<SharedDDict>& ddictRegistry() {
+  static DictRegistry<SharedDDict>* registry = new DictRegistry<SharedDDict>();
+  return *registry;
+}
+
+std::shared_ptr<const SharedCDict> getSharedCDict(const void* dict,
+                                                  size_t dictSize,
+                                                  int level) {
+  uint32_t dictID = ZSTD_getDictID_fromDict(dict, dictSize);
+  uint64_t key =
+      (static_cast<uint64_t>(dictID) << 32) | static_cast<uint32_t>(level);
+  return cdictRegistry().get(key, dict, dictSize, [&]() {
+    auto entry = std::make_shared<SharedCDict>();
+    const uint8_t* bytes = static_cast<const uint8_t*>(dict);
+    entry->content.assign(bytes, bytes + dictSize);
+    entry->cdict.reset(ZSTD_createCDict_byReference(entry->content.data(),
+                                                    dictSize, level));
+    if (!entry->cdict)
+      return std::shared_ptr<SharedCDict>();
+    return entry;
+  });
+}
+
+std::shared_ptr<const SharedDDict> getSharedDDict(const void* dict,
+                                                  size_t dictSize) {
+  uint64_t key = ZSTD_getDictID_fromDict(dict, dictSize);
+  return ddictRegistry().get(key, dict, dictSize, [&]() {
+    auto entry = std::make_shared<SharedDDict>();
+    const uint8_t* bytes = static_cast<const uint8_t*>(dict);
+    entry->content.assign(bytes, bytes + dictSize);
+    entry->ddict.reset(
+        ZSTD_createDDict_byReference(entry->content.data(), dictSize));
+    if (!entry->ddict)
+      return std::shared_ptr<SharedDDict>();
+    return entry;
+  });
+}
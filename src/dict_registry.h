@@ -0,0 +1,37 @@
+#ifndef DICT_REGISTRY_H
+#define DICT_REGISTRY_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "util.h"
+#include "zstd.h"
+
+// Digested dictionaries are read-only once created, so identical ones are
+// shared by every context (and worker thread) in the process instead of being
+// digested again. Each owns a copy of its content, which the native dictionary
+// references rather than copying again.
+struct SharedCDict {
+  std::vector<uint8_t> content;
+  // Set instead of `content` for dictionaries that reference caller-owned
+  // memory in place. These are never registered, so they stay on the thread
+  // that created them.
+  std::shared_ptr<void> contentOwner;
+  zstd_unique_ptr<ZSTD_CDict, ZSTD_freeCDict> cdict;
+};
+
+struct SharedDDict {
+  std::vector<uint8_t> content;
+  zstd_unique_ptr<ZSTD_DDict, ZSTD_freeDDict> ddict;
+};
+
+// Returns the digested dictionary for the given content (and compression
+// level), creating it if it isn't already in use. Returns null on failure.
+std::shared_ptr<const SharedCDict> getSharedCDict(const void* dict,
+                                                  size_t dictSize,
+                                                  int level);
+std::shared_ptr<const SharedDDict> getSharedDDict(const void* dict,
+                                                  size_t dictSize);
+
+#endif
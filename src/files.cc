@@ -0,0 +1,414 @@
+#include "files.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "stats.h"
+#include "util.h"
+
+// Output is written in whole blocks of this size (a multiple of any filesystem
+// block size), except at the end of the file
+static constexpr size_t kWriteSize = 1 << 20;
+// Input that can't be mapped is read in chunks of this size
+static constexpr size_t kReadSize = 1 << 20;
+
+[[noreturn]] static void throwErrno(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Identifies a file independently of the path used to open it
+struct FileId {
+  uint64_t device = 0;
+  uint64_t inode = 0;
+
+  bool operator==(const FileId& other) const {
+    return device == other.device && inode == other.inode;
+  }
+};
+
+#ifdef _WIN32
+// Paths come from JS as UTF-8, which the narrow CRT functions don't accept
+static std::wstring widen(const std::string& path) {
+  int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  std::wstring result(length, L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &result[0], length);
+  return result;
+}
+
+static int openFile(const std::string& path, int flags) {
+  return _wopen(widen(path).c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+static int removeFile(const std::string& path) {
+  return _wunlink(widen(path).c_str());
+}
+
+static int64_t getFileSize(int fd) {
+  struct _stat64 st;
+  if (_fstat64(fd, &st) != 0 || !(st.st_mode & _S_IFREG))
+    return -1;
+  return st.st_size;
+}
+
+// st_ino is always zero on Windows, so ask for the volume and file index
+static FileId getFileId(int fd) {
+  BY_HANDLE_FILE_INFORMATION info;
+  HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+  if (!GetFileInformationByHandle(handle, &info))
+    throw std::system_error(static_cast<int>(GetLastError()),
+                            std::system_category(), "Could not stat file");
+  return FileId{info.dwVolumeSerialNumber,
+                (uint64_t(info.nFileIndexHigh) << 32) | info.nFileIndexLow};
+}
+
+static int truncateFile(int fd, uint64_t size) {
+  return _chsize_s(fd, size);
+}
+
+static int64_t readFile(int fd, void* buf, size_t size) {
+  return _read(fd, buf, static_cast<unsigned>(size));
+}
+
+static int64_t writeFile(int fd, const void* buf, size_t size) {
+  return _write(fd, buf, static_cast<unsigned>(size));
+}
+
+static int closeFile(int fd) {
+  return _close(fd);
+}
+#else
+static int openFile(const std::string& path, int flags) {
+  return open(path.c_str(), flags | O_CLOEXEC, 0666);
+}
+
+static int removeFile(const std::string& path) {
+  return unlink(path.c_str());
+}
+
+static int64_t getFileSize(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    return -1;
+  return st.st_size;
+}
+
+static FileId getFileId(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    throwErrno("Could not stat file");
+  return FileId{static_cast<uint64_t>(st.st_dev),
+                static_cast<uint64_t>(st.st_ino)};
+}
+
+static int truncateFile(int fd, uint64_t size) {
+  return ftruncate(fd, size);
+}
+
+static int64_t readFile(int fd, void* buf, size_t size) {
+  return read(fd, buf, size);
+}
+
+static int64_t writeFile(int fd, const void* buf, size_t size) {
+  return write(fd, buf, size);
+}
+
+static int closeFile(int fd) {
+  return close(fd);
+}
+#endif
+
+// Input file, mapped into memory where possible so libzstd can read all of it
+// in place, and otherwise read in chunks
+class InputFile {
+ public:
+  explicit InputFile(const std::string& path) {
+    fd = openFile(path, O_RDONLY);
+    if (fd < 0)
+      throwErrno("Could not open input file");
+    try {
+      fileId = getFileId(fd);
+    } catch (...) {
+      closeFile(fd);
+      throw;
+    }
+    fileSize = getFileSize(fd);
+#ifndef _WIN32
+    if (fileSize > 0 && static_cast<uint64_t>(fileSize) <= SIZE_MAX) {
+      void* addr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        map = addr;
+        madvise(map, fileSize, MADV_SEQUENTIAL);
+      }
+    }
+#endif
+    if (!map)
+      buffer.reset(new char[kReadSize]);
+  }
+
+  ~InputFile() {
+#ifndef _WIN32
+    if (map)
+      munmap(map, fileSize);
+#endif
+    closeFile(fd);
+  }
+
+  InputFile(const InputFile&) = delete;
+  InputFile& operator=(const InputFile&) = delete;
+
+  const FileId& id() const { return fileId; }
+  // Contents of the file, if it's mapped
+  const void* data() const { return map; }
+  // Size of the file, or -1 if it isn't a regular file
+  int64_t size() const { return fileSize; }
+  bool eof() const { return atEnd; }
+
+  // Points `in` at the next part of the file. A mapped file is read in one go.
+  void read(ZSTD_inBuffer& in) {
+    if (map) {
+      in = {map, static_cast<size_t>(fileSize), 0};
+      atEnd = true;
+      return;
+    }
+    int64_t length;
+    do {
+      length = readFile(fd, buffer.get(), kReadSize);
+    } while (length < 0 && errno == EINTR);
+    if (length < 0)
+      throwErrno("Could not read input file");
+    in = {buffer.get(), static_cast<size_t>(length), 0};
+    atEnd = length == 0;
+  }
+
+ private:
+  int fd = -1;
+  FileId fileId;
+  int64_t fileSize = -1;
+  void* map = nullptr;
+  std::unique_ptr<char[]> buffer;
+  bool atEnd = false;
+};
+
+// Output file, which libzstd writes to through `out`. Unless it's successfully
+// closed, the file is removed again.
+class OutputFile {
+ public:
+  ZSTD_outBuffer out;
+
+  OutputFile(std::string path, const InputFile& input)
+      : path(std::move(path)), buffer(new char[kWriteSize]) {
+    out = {buffer.get(), kWriteSize, 0};
+    // Only truncated once it's known not to be the input, which would
+    // otherwise be destroyed (and then removed)
+    int newFd = openFile(this->path, O_WRONLY | O_CREAT);
+    if (newFd < 0)
+      throwErrno("Could not open output file");
+    try {
+      if (getFileId(newFd) == input.id())
+        throw std::runtime_error("Input and output are the same file");
+      if (truncateFile(newFd, 0) != 0)
+        throwErrno("Could not write output file");
+    } catch (...) {
+      closeFile(newFd);
+      throw;
+    }
+    fd = newFd;
+  }
+
+  ~OutputFile() {
+    if (fd >= 0) {
+      closeFile(fd);
+      removeFile(path);
+    }
+  }
+
+  OutputFile(const OutputFile&) = delete;
+  OutputFile& operator=(const OutputFile&) = delete;
+
+  // Reserves space for `size` bytes of output up front, where supported. Only
+  // a hint, so failure is ignored.
+  void preallocate(uint64_t size) {
+#ifdef __linux__
+    preallocated = posix_fallocate(fd, 0, size) == 0;
+#else
+    (void)size;
+#endif
+  }
+
+  // Writes out the contents of `out`, leaving it empty
+  void flush() {
+    const char* data = buffer.get();
+    size_t left = out.pos;
+    while (left > 0) {
+      int64_t length = writeFile(fd, data, left);
+      if (length < 0) {
+        if (errno == EINTR)
+          continue;
+        throwErrno("Could not write output file");
+      }
+      data += length;
+      left -= length;
+    }
+    written += out.pos;
+    out.pos = 0;
+  }
+
+  // Writes out any remaining output and closes the file, returning its size
+  uint64_t close() {
+    flush();
+#ifdef __linux__
+    // Drop any space reserved beyond the actual output
+    if (preallocated && truncateFile(fd, written) != 0)
+      throwErrno("Could not write output file");
+#endif
+    int ret = closeFile(fd);
+    fd = -1;
+    if (ret != 0) {
+      removeFile(path);
+      throwErrno("Could not write output file");
+    }
+    return written;
+  }
+
+ private:
+  std::string path;
+  std::unique_ptr<char[]> buffer;
+  int fd = -1;
+  uint64_t written = 0;
+  bool preallocated = false;
+};
+
+// Returns `params` with `param` set to `value`, keeping it sorted by parameter
+static ParamList withParam(const ParamList& params, int param, int value) {
+  ParamList result;
+  result.reserve(params.size() + 2);
+  bool added = false;
+  for (size_t i = 0; i + 1 < params.size(); i += 2) {
+    if (!added && params[i] >= param) {
+      result.push_back(param);
+      result.push_back(value);
+      added = true;
+    }
+    if (params[i] != param) {
+      result.push_back(params[i]);
+      result.push_back(params[i + 1]);
+    }
+  }
+  if (!added) {
+    result.push_back(param);
+    result.push_back(value);
+  }
+  return result;
+}
+
+size_t compressFile(const ParamList& params,
+                    const std::string& srcPath,
+                    const std::string& dstPath) {
+  InputFile input(srcPath);
+  OutputFile output(dstPath, input);
+
+  // A mapped file is passed whole to every call, so libzstd can reference it
+  // in place instead of copying it into a window buffer of its own
+  CCtxPool::Lease lease;
+  size_t ret = cctxPool().acquire(
+      input.data() ? withParam(params, ZSTD_c_stableInBuffer, 1) : params,
+      lease);
+  if (ZSTD_isError(ret))
+    return ret;
+  ZSTD_CCtx* cctx = lease.get();
+  // Pooled contexts aren't reset on release, so drop anything left over from
+  // a failed call
+  ZSTD_CCtx_reset(cctx, ZSTD_reset_session_only);
+  if (input.size() >= 0) {
+    ret = ZSTD_CCtx_setPledgedSrcSize(cctx, input.size());
+    if (ZSTD_isError(ret))
+      return ret;
+  }
+
+  uint64_t start = beginStats();
+  uint64_t bytesIn = 0;
+  ZSTD_inBuffer in = {nullptr, 0, 0};
+  for (;;) {
+    if (in.pos == in.size && !input.eof()) {
+      input.read(in);
+      bytesIn += in.size;
+    }
+    ZSTD_EndDirective endOp = input.eof() ? ZSTD_e_end : ZSTD_e_continue;
+    ret = ZSTD_compressStream2(cctx, &output.out, &in, endOp);
+    if (ZSTD_isError(ret))
+      return ret;
+    if (output.out.pos == output.out.size)
+      output.flush();
+    if (endOp == ZSTD_e_end && ret == 0)
+      break;
+  }
+  uint64_t written = output.close();
+  endStats(nullptr, cctx, start, bytesIn, written);
+  return written;
+}
+
+size_t decompressFile(const ParamList& params,
+                      const std::string& srcPath,
+                      const std::string& dstPath) {
+  InputFile input(srcPath);
+  OutputFile output(dstPath, input);
+
+  DCtxPool::Lease lease;
+  size_t ret = dctxPool().acquire(params, lease);
+  if (ZSTD_isError(ret))
+    return ret;
+  ZSTD_DCtx* dctx = lease.get();
+  ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only);
+
+  if (input.data()) {
+    size_t srcSize = input.size();
+    unsigned long long contentSize =
+        ZSTD_findDecompressedSize(input.data(), srcSize);
+    if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN &&
+        contentSize != ZSTD_CONTENTSIZE_ERROR &&
+        isPlausibleContentSize(contentSize, srcSize))
+      output.preallocate(contentSize);
+  }
+
+  uint64_t start = beginStats();
+  uint64_t bytesIn = 0;
+  ZSTD_inBuffer in = {nullptr, 0, 0};
+  // Whether the last call had room to spare, and so isn't holding any output
+  // back
+  bool drained = true;
+  ret = 0;
+  for (;;) {
+    if (in.pos == in.size && !input.eof()) {
+      input.read(in);
+      bytesIn += in.size;
+    }
+    if (in.pos == in.size && input.eof() && drained)
+      break;
+    ret = ZSTD_decompressStream(dctx, &output.out, &in);
+    if (ZSTD_isError(ret))
+      return ret;
+    drained = output.out.pos < output.out.size;
+    if (!drained)
+      output.flush();
+  }
+  if (ret != 0)
+    throw std::runtime_error("File ended in middle of compressed data frame");
+  uint64_t written = output.close();
+  endStats(nullptr, dctx, start, bytesIn, written);
+  return written;
+}
@@ -0,0 +1,22 @@
+#ifndef FILES_H
+#define FILES_H
+
+#include <string>
+
+#include "context_pool.h"
+
+// Compresses the file at `srcPath` into a new file at `dstPath`, using a pooled
+// context configured with `params`. Returns the compressed size, or a zstd
+// error code. I/O errors are thrown as std::system_error. Either way, the
+// output file is removed on failure.
+size_t compressFile(const ParamList& params,
+                    const std::string& srcPath,
+                    const std::string& dstPath);
+
+// Decompresses the file at `srcPath` into a new file at `dstPath`, with the
+// same conventions as compressFile. Returns the decompressed size.
+size_t decompressFile(const ParamList& params,
+                      const std::string& srcPath,
+                      const std::string& dstPath);
+
+#endif
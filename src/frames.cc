@@ -0,0 +1,98 @@
+#include "frames.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "util.h"
+
+using namespace Napi;
+
+static void throwParseError(Napi::Env env) {
+  throw Error::New(env, "Could not parse Zstandard frames");
+}
+
+Value wrapScanFrames(const CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+
+  Uint8Array srcBuf = info[0].As<Uint8Array>();
+  const uint8_t* src = srcBuf.Data();
+  size_t srcSize = srcBuf.ByteLength();
+
+  std::vector<double> table;
+  size_t pos = 0;
+  while (pos < srcSize) {
+    const uint8_t* frame = src + pos;
+    size_t remaining = srcSize - pos;
+    ZSTD_frameHeader header;
+    // Non-zero (but not an error) if the header itself is truncated
+    if (ZSTD_getFrameHeader(&header, frame, remaining) != 0)
+      throwParseError(env);
+    size_t frameSize = ZSTD_findFrameCompressedSize(frame, remaining);
+    if (ZSTD_isError(frameSize))
+      throwParseError(env);
+
+    double row[kFrameFieldCount];
+    row[kFrameOffset] = static_cast<double>(pos);
+    row[kFrameCompressedSize] = static_cast<double>(frameSize);
+    if (header.frameType == ZSTD_skippableFrame) {
+      // The header reports the size of the skippable payload as its content
+      // size, but it doesn't decompress to anything
+      row[kFrameContentSize] = 0;
+      row[kFrameDecompressBound] = 0;
+      row[kFrameWindowSize] = 0;
+    } else if (header.frameContentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+      // Only walk the blocks again when the header doesn't give the size
+      unsigned long long bound = ZSTD_decompressBound(frame, frameSize);
+      if (bound == ZSTD_CONTENTSIZE_ERROR)
+        throwParseError(env);
+      row[kFrameContentSize] = -1;
+      row[kFrameDecompressBound] = static_cast<double>(bound);
+      row[kFrameWindowSize] = static_cast<double>(header.windowSize);
+    } else {
+      row[kFrameContentSize] = static_cast<double>(header.frameContentSize);
+      row[kFrameDecompressBound] = row[kFrameContentSize];
+      row[kFrameWindowSize] = static_cast<double>(header.windowSize);
+    }
+    // For skippable frames, this is the low 4 bits of the magic number
+    row[kFrameDictID] = header.dictID;
+    row[kFrameChecksumFlag] = header.checksumFlag;
+    row[kFrameType] = header.frameType;
+    table.insert(table.end(), row, row + kFrameFieldCount);
+    pos += frameSize;
+  }
+
+  Float64Array result = Float64Array::New(env, table.size());
+  std::copy(table.begin(), table.end(), result.Data());
+  return result;
+}
+
+Value wrapWriteSkippableFrame(const CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 3);
+  uint32_t magicVariant = info[2].ToNumber().Uint32Value();
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  return convertZstdResult(
+      env, ZSTD_writeSkippableFrame(dstBuf.Data(), dstBuf.ByteLength(),
+                                    srcBuf.Data(), srcBuf.ByteLength(),
+                                    magicVariant));
+}
+
+Value wrapReadSkippableFrame(const CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 2);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  unsigned magicVariant = 0;
+  size_t ret =
+      ZSTD_readSkippableFrame(dstBuf.Data(), dstBuf.ByteLength(), &magicVariant,
+                              srcBuf.Data(), srcBuf.ByteLength());
+  checkZstdError(env, ret);
+  Array result = Array::New(env, 2);
+  result[uint32_t(0)] = Number::New(env, ret);
+  result[uint32_t(1)] = Number::New(env, magicVariant);
+  return result;
+}
@@ -0,0 +1,24 @@
+#ifndef FRAMES_H
+#define FRAMES_H
+
+#include <napi.h>
+
+// Columns of the table returned by scanFrames, exported to JS as the
+// FrameField enum
+enum FrameField {
+  kFrameOffset,
+  kFrameCompressedSize,
+  kFrameContentSize,
+  kFrameDecompressBound,
+  kFrameWindowSize,
+  kFrameDictID,
+  kFrameChecksumFlag,
+  kFrameType,
+  kFrameFieldCount,
+};
+
+Napi::Value wrapScanFrames(const Napi::CallbackInfo& info);
+Napi::Value wrapWriteSkippableFrame(const Napi::CallbackInfo& info);
+Napi::Value wrapReadSkippableFrame(const Napi::CallbackInfo& info);
+
+#endif
@@ -20,11 +20,18 @@ class ObjectWrapHelper : public Napi::ObjectWrap<T> {
     return Napi::ObjectWrap<T>::Unwrap(wrapper);
   }
 
+  // Native state can't be shared with the threadpool, so objects in use by an
+  // asynchronous operation reject all other use until it completes
+  void beginAsync(Napi::Env env);
+  void endAsync(Napi::Env env);
+
  protected:
   void adjustMemory(Napi::Env env);
+  void checkIdle(Napi::Env env);
 
  private:
   int64_t lastSize = 0;
+  bool asyncBusy = false;
 
   virtual int64_t getCurrentSize() = 0;
 };
@@ -35,6 +42,18 @@ void ObjectWrapHelper<T>::Finalize(Napi::Env env) {
   lastSize = 0;
 }
 
+template <typename T>
+void ObjectWrapHelper<T>::beginAsync(Napi::Env env) {
+  checkIdle(env);
+  asyncBusy = true;
+}
+
+template <typename T>
+void ObjectWrapHelper<T>::endAsync(Napi::Env env) {
+  asyncBusy = false;
+  adjustMemory(env);
+}
+
 template <typename T>
 void ObjectWrapHelper<T>::adjustMemory(Napi::Env env) {
   int64_t newSize = getCurrentSize();
@@ -44,4 +63,12 @@ void ObjectWrapHelper<T>::adjustMemory(Napi::Env env) {
   }
 }
 
+template <typename T>
+void ObjectWrapHelper<T>::checkIdle(Napi::Env env) {
+  if (asyncBusy) {
+    throw Napi::Error::New(env,
+                           "Object is in use by an asynchronous operation");
+  }
+}
+
 #endif
@@ -0,0 +1,125 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "zstd_errors.h"
+
+struct FrameSlice {
+  size_t srcOffset;
+  size_t srcSize;
+  size_t dstOffset;
+  size_t dstSize;
+};
+
+// Finds the position of every frame in `src`, and of its output in `dst`.
+// Returns the total decompressed size, or a zstd error code.
+static size_t indexFrames(const uint8_t* src,
+                          size_t srcSize,
+                          size_t dstCapacity,
+                          std::vector<FrameSlice>& frames) {
+  size_t srcPos = 0;
+  size_t dstPos = 0;
+  while (srcPos < srcSize) {
+    const uint8_t* frame = src + srcPos;
+    size_t frameSize = ZSTD_findFrameCompressedSize(frame, srcSize - srcPos);
+    if (ZSTD_isError(frameSize))
+      return frameSize;
+    unsigned long long contentSize =
+        ZSTD_getFrameContentSize(frame, frameSize);
+    if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN)
+      return static_cast<size_t>(-ZSTD_error_frameParameter_unsupported);
+    if (contentSize == ZSTD_CONTENTSIZE_ERROR)
+      return static_cast<size_t>(-ZSTD_error_corruption_detected);
+    if (contentSize > dstCapacity - dstPos)
+      return static_cast<size_t>(-ZSTD_error_dstSize_tooSmall);
+    frames.push_back(FrameSlice{srcPos, frameSize, dstPos,
+                                static_cast<size_t>(contentSize)});
+    srcPos += frameSize;
+    dstPos += contentSize;
+  }
+  return dstPos;
+}
+
+size_t decompressParallel(const ParamList& params,
+                          unsigned threads,
+                          void* dst,
+                          size_t dstCapacity,
+                          const void* src,
+                          size_t srcSize) {
+  std::vector<FrameSlice> frames;
+  size_t total = indexFrames(static_cast<const uint8_t*>(src), srcSize,
+                             dstCapacity, frames);
+  if (ZSTD_isError(total))
+    return total;
+
+  // Each thread takes the next frame until there are none left, so uneven
+  // frame sizes still keep every thread busy
+  std::atomic<size_t> nextFrame{0};
+  std::atomic<size_t> error{0};
+  // Exceptions can't propagate out of a thread, so the first one is kept and
+  // rethrown once every thread has finished
+  std::mutex exceptionMutex;
+  std::exception_ptr exception;
+  auto decompressFrames = [&]() {
+    DCtxPool::Lease lease;
+    size_t ret = dctxPool().acquire(params, lease);
+    while (!ZSTD_isError(ret) && error.load() == 0) {
+      size_t i = nextFrame++;
+      if (i >= frames.size())
+        return ret;
+      const FrameSlice& frame = frames[i];
+      ret = ZSTD_decompressDCtx(
+          lease.get(), static_cast<uint8_t*>(dst) + frame.dstOffset,
+          frame.dstSize, static_cast<const uint8_t*>(src) + frame.srcOffset,
+          frame.srcSize);
+      if (!ZSTD_isError(ret) && ret != frame.dstSize)
+        ret = static_cast<size_t>(-ZSTD_error_corruption_detected);
+    }
+    return ret;
+  };
+  auto work = [&]() {
+    size_t ret;
+    try {
+      ret = decompressFrames();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(exceptionMutex);
+      if (!exception)
+        exception = std::current_exception();
+      // Also stops the other threads from taking any more frames
+      ret = static_cast<size_t>(-ZSTD_error_GENERIC);
+    }
+    // Only the first error is reported
+    size_t noError = 0;
+    if (ZSTD_isError(ret))
+      error.compare_exchange_strong(noError, ret);
+  };
+
+  // Threads are started for each call, so never start more than there are
+  // frames to give them
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  threads = std::max<size_t>(1, std::min<size_t>(threads, frames.size()));
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (unsigned i = 1; i < threads; i++) {
+    // Carry on with fewer threads if no more can be created
+    try {
+      workers.emplace_back(work);
+    } catch (const std::system_error&) {
+      break;
+    }
+  }
+  work();
+  for (std::thread& worker : workers)
+    worker.join();
+
+  if (exception)
+    std::rethrow_exception(exception);
+  return error.load() != 0 ? error.load() : total;
+}
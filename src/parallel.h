@@ -0,0 +1,20 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "context_pool.h"
+
+// Decompresses every frame in `src` into `dst`, using up to `threads` threads
+// (or one per core, if zero, and never more than one per frame) with a pooled
+// context each. The calling thread is one of them, and the rest are started
+// for the call. Every frame must record its content size, so each one can be
+// written straight into its own slice of `dst`. Returns the total decompressed
+// size, or a zstd error code. Exceptions from any thread are rethrown on the
+// calling thread after all of them finish.
+size_t decompressParallel(const ParamList& params,
+                          unsigned threads,
+                          void* dst,
+                          size_t dstCapacity,
+                          const void* src,
+                          size_t srcSize);
+
+#endif
@@ -0,0 +1,276 @@
+#include "seekable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "async_worker.h"
+#include "context_pool.h"
+#include "zstd_errors.h"
+
+using namespace Napi;
+
+// See the seekable format specification in zstd's contrib/seekable_format
+static constexpr uint32_t kSeekTableMagic = ZSTD_MAGIC_SKIPPABLE_START | 0xE;
+static constexpr uint32_t kSeekableMagic = 0x8F92EAB1;
+static constexpr size_t kFooterSize = 9;
+static constexpr uint8_t kChecksumFlag = 0x80;
+static constexpr uint8_t kReservedBits = 0x7C;
+
+static uint32_t readLE32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+struct SeekTableLayout {
+  uint32_t numFrames;
+  size_t entrySize;
+  // Including the skippable frame header
+  uint64_t totalSize;
+};
+
+// Reads the footer at the end of `data`, throwing if it isn't a seek table
+static SeekTableLayout readFooter(Env env, const uint8_t* data, size_t size) {
+  if (size < kFooterSize || readLE32(data + size - 4) != kSeekableMagic)
+    throw Error::New(env, "Missing seek table");
+  const uint8_t* footer = data + size - kFooterSize;
+  uint8_t descriptor = footer[4];
+  if (descriptor & kReservedBits)
+    throw Error::New(env, "Corrupt seek table");
+
+  SeekTableLayout layout;
+  layout.numFrames = readLE32(footer);
+  layout.entrySize = (descriptor & kChecksumFlag) ? 12 : 8;
+  uint64_t entriesSize =
+      static_cast<uint64_t>(layout.numFrames) * layout.entrySize;
+  layout.totalSize = ZSTD_SKIPPABLEHEADERSIZE + entriesSize + kFooterSize;
+  return layout;
+}
+
+size_t SeekTable::frameIndex(uint64_t offset) const {
+  if (offset >= decompressedOffsets.back())
+    return numFrames();
+  auto it = std::upper_bound(decompressedOffsets.begin(),
+                             decompressedOffsets.end(), offset);
+  return (it - decompressedOffsets.begin()) - 1;
+}
+
+// Decompresses `dstSize` bytes starting at decompressed `offset`, stopping
+// early at the end of the data. `src` must start with the frame containing
+// `offset`, and include every frame needed after it. Returns the number of
+// bytes written, or a zstd error code.
+static size_t decompressRange(const SeekTable& table,
+                              uint8_t* dst,
+                              size_t dstSize,
+                              const uint8_t* src,
+                              size_t srcSize,
+                              uint64_t offset) {
+  DCtxPool::Lease lease;
+  size_t ret = dctxPool().acquire(ParamList(), lease);
+  if (ZSTD_isError(ret))
+    return ret;
+
+  size_t first = table.frameIndex(offset);
+  uint64_t srcBase = table.compressedOffsets[first];
+  std::vector<uint8_t> scratch;
+  size_t written = 0;
+  for (size_t i = first; i < table.numFrames() && written < dstSize; i++) {
+    uint64_t srcStart = table.compressedOffsets[i] - srcBase;
+    uint64_t srcEnd = table.compressedOffsets[i + 1] - srcBase;
+    if (srcEnd > srcSize)
+      return static_cast<size_t>(-ZSTD_error_srcSize_wrong);
+    uint64_t frameStart = table.decompressedOffsets[i];
+    size_t frameSize = table.decompressedOffsets[i + 1] - frameStart;
+    size_t skip = offset + written - frameStart;
+    size_t wanted = std::min(dstSize - written, frameSize - skip);
+
+    // Frames that are only partly wanted go through scratch space, the rest
+    // are decompressed in place
+    bool partial = wanted != frameSize;
+    if (partial) {
+      try {
+        scratch.resize(frameSize);
+      } catch (const std::bad_alloc&) {
+        return static_cast<size_t>(-ZSTD_error_memory_allocation);
+      }
+    }
+    uint8_t* frameDst = partial ? scratch.data() : dst + written;
+    ret = ZSTD_decompressDCtx(lease.get(), frameDst, frameSize, src + srcStart,
+                              srcEnd - srcStart);
+    if (ZSTD_isError(ret))
+      return ret;
+    if (ret != frameSize)
+      return static_cast<size_t>(-ZSTD_error_corruption_detected);
+    if (partial)
+      std::memcpy(dst + written, scratch.data() + skip, wanted);
+    written += wanted;
+  }
+  return written;
+}
+
+const napi_type_tag SeekableReader::typeTag = {0x3a5d1e0c7b9f4e21,
+                                               0x9c0b6f8a2d43e517};
+
+void SeekableReader::Init(Napi::Env env, Napi::Object exports) {
+  Function func = DefineClass(
+      env, "SeekableReader",
+      {
+          InstanceMethod<&SeekableReader::wrapGetNumFrames>(
+              "getNumFrames", napi_default_method),
+          InstanceMethod<&SeekableReader::wrapGetFrameCompressedOffset>(
+              "getFrameCompressedOffset", napi_default_method),
+          InstanceMethod<&SeekableReader::wrapGetFrameCompressedSize>(
+              "getFrameCompressedSize", napi_default_method),
+          InstanceMethod<&SeekableReader::wrapGetFrameDecompressedOffset>(
+              "getFrameDecompressedOffset", napi_default_method),
+          InstanceMethod<&SeekableReader::wrapGetFrameDecompressedSize>(
+              "getFrameDecompressedSize", napi_default_method),
+          InstanceMethod<&SeekableReader::wrapOffsetToFrameIndex>(
+              "offsetToFrameIndex", napi_default_method),
+          InstanceMethod<&SeekableReader::wrapDecompress>("decompress",
+                                                          napi_default_method),
+          InstanceMethod<&SeekableReader::wrapDecompressAsync>(
+              "decompressAsync", napi_default_method),
+      });
+  exports.Set("SeekableReader", func);
+}
+
+SeekableReader::SeekableReader(const Napi::CallbackInfo& info)
+    : ObjectWrapHelper<SeekableReader>(info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+
+  Uint8Array tableBuf = info[0].As<Uint8Array>();
+  const uint8_t* data = tableBuf.Data();
+  size_t size = tableBuf.ByteLength();
+  SeekTableLayout layout = readFooter(env, data, size);
+  if (layout.totalSize > size)
+    throw RangeError::New(env, "Buffer does not contain the whole seek table");
+  const uint8_t* start = data + size - layout.totalSize;
+  if (readLE32(start) != kSeekTableMagic ||
+      readLE32(start + 4) != layout.totalSize - ZSTD_SKIPPABLEHEADERSIZE) {
+    throw Error::New(env, "Corrupt seek table");
+  }
+
+  auto parsed = std::make_shared<SeekTable>();
+  parsed->compressedOffsets.reserve(layout.numFrames + 1);
+  parsed->decompressedOffsets.reserve(layout.numFrames + 1);
+  uint64_t compressedOffset = 0;
+  uint64_t decompressedOffset = 0;
+  const uint8_t* entry = start + ZSTD_SKIPPABLEHEADERSIZE;
+  for (uint32_t i = 0; i < layout.numFrames; i++) {
+    parsed->compressedOffsets.push_back(compressedOffset);
+    parsed->decompressedOffsets.push_back(decompressedOffset);
+    uint32_t compressedSize = readLE32(entry);
+    uint32_t decompressedSize = readLE32(entry + 4);
+    // Sizes are used to allocate scratch space, so don't trust them any further
+    // than the frame's blocks could actually decompress to
+    if (!isPlausibleContentSize(decompressedSize, compressedSize))
+      throw Error::New(env, "Corrupt seek table");
+    compressedOffset += compressedSize;
+    decompressedOffset += decompressedSize;
+    entry += layout.entrySize;
+  }
+  parsed->compressedOffsets.push_back(compressedOffset);
+  parsed->decompressedOffsets.push_back(decompressedOffset);
+  table = std::move(parsed);
+  adjustMemory(env);
+}
+
+size_t SeekableReader::readFrameIndex(const Napi::CallbackInfo& info,
+                                      bool allowEnd) {
+  checkArgCount(info, 1);
+  int64_t index = info[0].ToNumber().Int64Value();
+  int64_t limit = table->numFrames() + (allowEnd ? 1 : 0);
+  if (index < 0 || index >= limit)
+    throw RangeError::New(info.Env(), "Frame index out of range");
+  return index;
+}
+
+Napi::Value SeekableReader::wrapGetNumFrames(const Napi::CallbackInfo& info) {
+  return Number::New(info.Env(), table->numFrames());
+}
+
+Napi::Value SeekableReader::wrapGetFrameCompressedOffset(
+    const Napi::CallbackInfo& info) {
+  size_t index = readFrameIndex(info, true);
+  return Number::New(info.Env(), table->compressedOffsets[index]);
+}
+
+Napi::Value SeekableReader::wrapGetFrameCompressedSize(
+    const Napi::CallbackInfo& info) {
+  size_t index = readFrameIndex(info, false);
+  return Number::New(info.Env(), table->compressedOffsets[index + 1] -
+                                     table->compressedOffsets[index]);
+}
+
+Napi::Value SeekableReader::wrapGetFrameDecompressedOffset(
+    const Napi::CallbackInfo& info) {
+  size_t index = readFrameIndex(info, true);
+  return Number::New(info.Env(), table->decompressedOffsets[index]);
+}
+
+Napi::Value SeekableReader::wrapGetFrameDecompressedSize(
+    const Napi::CallbackInfo& info) {
+  size_t index = readFrameIndex(info, false);
+  return Number::New(info.Env(), table->decompressedOffsets[index + 1] -
+                                     table->decompressedOffsets[index]);
+}
+
+static uint64_t readOffset(Napi::Env env, Napi::Value value) {
+  int64_t offset = value.ToNumber().Int64Value();
+  if (offset < 0)
+    throw RangeError::New(env, "Offset must not be negative");
+  return offset;
+}
+
+Napi::Value SeekableReader::wrapOffsetToFrameIndex(
+    const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+  return Number::New(env, table->frameIndex(readOffset(env, info[0])));
+}
+
+Napi::Value SeekableReader::wrapDecompress(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 3);
+  uint64_t offset = readOffset(env, info[2]);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  size_t result = decompressRange(*table, dstBuf.Data(), dstBuf.ByteLength(),
+                                  srcBuf.Data(), srcBuf.ByteLength(), offset);
+  return convertZstdResult(env, result);
+}
+
+Napi::Value SeekableReader::wrapDecompressAsync(
+    const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 3);
+  uint64_t offset = readOffset(env, info[2]);
+
+  Uint8Array dstBuf = info[0].As<Uint8Array>();
+  Uint8Array srcBuf = info[1].As<Uint8Array>();
+  std::shared_ptr<const SeekTable> tablePtr = table;
+  uint8_t* dst = dstBuf.Data();
+  size_t dstSize = dstBuf.ByteLength();
+  const uint8_t* src = srcBuf.Data();
+  size_t srcSize = srcBuf.ByteLength();
+  auto worker = makeAsyncCall(env, [=]() {
+    return decompressRange(*tablePtr, dst, dstSize, src, srcSize, offset);
+  });
+  worker->pin(dstBuf);
+  worker->pin(srcBuf);
+  return ZstdAsyncWorker::queue(std::move(worker));
+}
+
+Napi::Value wrapSeekTableSize(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 1);
+
+  Uint8Array footerBuf = info[0].As<Uint8Array>();
+  SeekTableLayout layout =
+      readFooter(env, footerBuf.Data(), footerBuf.ByteLength());
+  return Number::New(env, layout.totalSize);
+}
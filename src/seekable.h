@@ -0,0 +1,55 @@
+#ifndef SEEKABLE_H
+#define SEEKABLE_H
+
+#include <napi.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "object_wrap_helper.h"
+#include "util.h"
+#include "zstd.h"
+
+// Index of the independently compressed frames in a file using the Zstandard
+// seekable format, read from the skippable frame at the end of the file
+struct SeekTable {
+  // Start offset of each frame, followed by the end offset of the last one
+  std::vector<uint64_t> compressedOffsets;
+  std::vector<uint64_t> decompressedOffsets;
+
+  size_t numFrames() const { return compressedOffsets.size() - 1; }
+  // Returns the frame containing decompressed `offset`, or numFrames() if it's
+  // past the end
+  size_t frameIndex(uint64_t offset) const;
+};
+
+class SeekableReader : public ObjectWrapHelper<SeekableReader> {
+ public:
+  static const napi_type_tag typeTag;
+  static void Init(Napi::Env env, Napi::Object exports);
+  SeekableReader(const Napi::CallbackInfo& info);
+
+ private:
+  // Never modified after construction, so asynchronous calls share it without
+  // locking the reader
+  std::shared_ptr<const SeekTable> table;
+
+  int64_t getCurrentSize() {
+    return sizeof(SeekTable) + 2 * sizeof(uint64_t) * (table->numFrames() + 1);
+  }
+  size_t readFrameIndex(const Napi::CallbackInfo& info, bool allowEnd);
+
+  Napi::Value wrapGetNumFrames(const Napi::CallbackInfo& info);
+  Napi::Value wrapGetFrameCompressedOffset(const Napi::CallbackInfo& info);
+  Napi::Value wrapGetFrameCompressedSize(const Napi::CallbackInfo& info);
+  Napi::Value wrapGetFrameDecompressedOffset(const Napi::CallbackInfo& info);
+  Napi::Value wrapGetFrameDecompressedSize(const Napi::CallbackInfo& info);
+  Napi::Value wrapOffsetToFrameIndex(const Napi::CallbackInfo& info);
+  Napi::Value wrapDecompress(const Napi::CallbackInfo& info);
+  Napi::Value wrapDecompressAsync(const Napi::CallbackInfo& info);
+};
+
+Napi::Value wrapSeekTableSize(const Napi::CallbackInfo& info);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef SEQUENCE_PRODUCER_H
+#define SEQUENCE_PRODUCER_H
+
+#include <napi.h>
+
+#include "zstd.h"
+
+// Plug-in point for external sequence producers (see
+// ZSTD_registerSequenceProducer in the Zstandard manual). Another addon can
+// wrap one of these in a napi_external, tag it with kSequenceProducerTypeTag,
+// and hand it to CCtx#registerSequenceProducer. The struct (and its state) must
+// remain valid until the external is finalized, and the producer must be safe
+// to call from the libuv threadpool.
+struct ZstdNapiSequenceProducer {
+  void* state;
+  ZSTD_sequenceProducer_F producer;
+};
+
+static constexpr napi_type_tag kSequenceProducerTypeTag = {0x2b8e4c7d91a05f36,
+                                                           0xd05a97e3c1f4286b};
+
+#endif
@@ -0,0 +1,87 @@
+#include "stats.h"
+
+#include "util.h"
+
+using namespace Napi;
+
+std::atomic<bool> statsEnabled{false};
+
+// Process-wide totals, shared by every thread (and worker) using the addon
+static Stats compressTotals;
+static Stats decompressTotals;
+
+void Stats::max(StatIndex index, uint64_t value) {
+  uint64_t current = values[index].load(std::memory_order_relaxed);
+  while (current < value &&
+         !values[index].compare_exchange_weak(current, value,
+                                              std::memory_order_relaxed)) {
+  }
+}
+
+Float64Array Stats::toArray(Napi::Env env) const {
+  Float64Array result = Float64Array::New(env, kStatCount);
+  for (size_t i = 0; i < kStatCount; i++) {
+    result[i] = static_cast<double>(values[i].load(std::memory_order_relaxed));
+  }
+  return result;
+}
+
+static void record(Stats& totals,
+                   Stats* stats,
+                   uint64_t start,
+                   uint64_t bytesIn,
+                   uint64_t bytesOut,
+                   uint64_t memory) {
+  // Stats may have been disabled mid-call, in which case the call is dropped
+  uint64_t now = beginStats();
+  if (now == 0)
+    return;
+  for (Stats* target : {&totals, stats}) {
+    if (target == nullptr)
+      continue;
+    target->add(kStatCalls, 1);
+    target->add(kStatBytesIn, bytesIn);
+    target->add(kStatBytesOut, bytesOut);
+    target->add(kStatNanos, now - start);
+    target->max(kStatPeakMemory, memory);
+  }
+}
+
+void recordCompress(Stats* stats,
+                    const ZSTD_CCtx* cctx,
+                    uint64_t start,
+                    uint64_t bytesIn,
+                    uint64_t bytesOut) {
+  record(compressTotals, stats, start, bytesIn, bytesOut,
+         ZSTD_sizeof_CCtx(cctx));
+}
+
+void recordDecompress(Stats* stats,
+                      const ZSTD_DCtx* dctx,
+                      uint64_t start,
+                      uint64_t bytesIn,
+                      uint64_t bytesOut) {
+  record(decompressTotals, stats, start, bytesIn, bytesOut,
+         ZSTD_sizeof_DCtx(dctx));
+}
+
+Value wrapSetStatsEnabled(const CallbackInfo& info) {
+  checkArgCount(info, 1);
+  statsEnabled.store(info[0].ToBoolean(), std::memory_order_relaxed);
+  return info.Env().Undefined();
+}
+
+Value wrapGetStats(const CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 0);
+  // Compression totals first, then decompression, so polling both only takes
+  // one call
+  Float64Array result = Float64Array::New(env, 2 * kStatCount);
+  for (size_t i = 0; i < kStatCount; i++) {
+    result[i] = static_cast<double>(
+        compressTotals.values[i].load(std::memory_order_relaxed));
+    result[kStatCount + i] = static_cast<double>(
+        decompressTotals.values[i].load(std::memory_order_relaxed));
+  }
+  return result;
+}
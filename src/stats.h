@@ -0,0 +1,85 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <napi.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "zstd.h"
+
+// Indices into a stats array, exported to JS as the Stat enum
+enum StatIndex {
+  kStatCalls,
+  kStatBytesIn,
+  kStatBytesOut,
+  kStatNanos,
+  kStatPeakMemory,
+  kStatCount,
+};
+
+// Counters for a single context. Only the thread running the context's current
+// operation updates them, but JS may read them at any time, so they're atomic
+// (uncontended, so relaxed updates are nearly free).
+struct Stats {
+  std::atomic<uint64_t> values[kStatCount] = {};
+
+  void add(StatIndex index, uint64_t amount) {
+    values[index].fetch_add(amount, std::memory_order_relaxed);
+  }
+  void max(StatIndex index, uint64_t value);
+  Napi::Float64Array toArray(Napi::Env env) const;
+};
+
+extern std::atomic<bool> statsEnabled;
+
+// Returns the start time of a libzstd call to pass to endStats, or zero if
+// stats are disabled (in which case endStats does nothing).
+static inline uint64_t beginStats() {
+  if (!statsEnabled.load(std::memory_order_relaxed))
+    return 0;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Records a call in `stats` (if not null) and the process-wide totals
+void recordCompress(Stats* stats,
+                    const ZSTD_CCtx* cctx,
+                    uint64_t start,
+                    uint64_t bytesIn,
+                    uint64_t bytesOut);
+void recordDecompress(Stats* stats,
+                      const ZSTD_DCtx* dctx,
+                      uint64_t start,
+                      uint64_t bytesIn,
+                      uint64_t bytesOut);
+
+static inline void endStats(Stats* stats,
+                            const ZSTD_CCtx* cctx,
+                            uint64_t start,
+                            uint64_t bytesIn,
+                            uint64_t bytesOut) {
+  if (start != 0)
+    recordCompress(stats, cctx, start, bytesIn, bytesOut);
+}
+
+static inline void endStats(Stats* stats,
+                            const ZSTD_DCtx* dctx,
+                            uint64_t start,
+                            uint64_t bytesIn,
+                            uint64_t bytesOut) {
+  if (start != 0)
+    recordDecompress(stats, dctx, start, bytesIn, bytesOut);
+}
+
+// Output size of a one-shot call, which is zero if it failed
+static inline uint64_t resultSize(size_t ret) {
+  return ZSTD_isError(ret) ? 0 : ret;
+}
+
+Napi::Value wrapSetStatsEnabled(const Napi::CallbackInfo& info);
+Napi::Value wrapGetStats(const Napi::CallbackInfo& info);
+
+#endif
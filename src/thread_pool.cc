@@ -0,0 +1,69 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+using namespace Napi;
+
+const napi_type_tag ThreadPool::typeTag = {0x6e1f0b9d2c7a4835,
+                                           0xa4d83c5e91f2706b};
+
+void ThreadPool::Init(Napi::Env env, Napi::Object exports) {
+  Function func = DefineClass(
+      env, "ThreadPool",
+      {
+          InstanceMethod<&ThreadPool::wrapGetNumThreads>("getNumThreads",
+                                                         napi_default_method),
+      });
+  exports.Set("ThreadPool", func);
+}
+
+// Deliberately leaked, like the context pools, since pooled contexts keep
+// using it until exit
+const SharedThreadPool& sharedThreadPool() {
+  static const SharedThreadPool* shared = [] {
+    // A pool can't usefully have more threads than a context can have workers
+    ZSTD_bounds bounds = ZSTD_cParam_getBounds(ZSTD_c_nbWorkers);
+    size_t numThreads = std::min<size_t>(
+        std::max(std::thread::hardware_concurrency(), 1u), bounds.upperBound);
+    return new SharedThreadPool{
+        std::shared_ptr<ZSTD_threadPool>(ZSTD_createThreadPool(numThreads),
+                                         ZSTD_freeThreadPool),
+        numThreads};
+  }();
+  return *shared;
+}
+
+ThreadPool::ThreadPool(const Napi::CallbackInfo& info)
+    : ObjectWrapHelper<ThreadPool>(info) {
+  Napi::Env env = info.Env();
+  checkArgCount(info, 0, 1);
+  if (info.Length() == 0) {
+    const SharedThreadPool& shared = sharedThreadPool();
+    if (!shared.pool)
+      throw Error::New(env, "Failed to create ThreadPool");
+    pool = shared.pool;
+    numThreads = shared.numThreads;
+    return;
+  }
+  int64_t requested = info[0].ToNumber().Int64Value();
+
+  // A pool can't usefully have more threads than a context can have workers
+  ZSTD_bounds bounds = ZSTD_cParam_getBounds(ZSTD_c_nbWorkers);
+  if (requested < 1 || requested > bounds.upperBound) {
+    char errMsg[128];
+    snprintf(errMsg, sizeof(errMsg),
+             "Number of threads must be between 1 and %d", bounds.upperBound);
+    throw RangeError::New(env, errMsg);
+  }
+
+  numThreads = requested;
+  pool.reset(ZSTD_createThreadPool(numThreads), ZSTD_freeThreadPool);
+  if (!pool)
+    throw Error::New(env, "Failed to create ThreadPool");
+}
+
+Napi::Value ThreadPool::wrapGetNumThreads(const Napi::CallbackInfo& info) {
+  return Number::New(info.Env(), numThreads);
+}
@@ -0,0 +1,39 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <napi.h>
+
+#include <memory>
+
+#include "object_wrap_helper.h"
+#include "util.h"
+#include "zstd.h"
+
+// Process-wide pool, sized to the number of CPU cores, which is shared by
+// pooled contexts and high-level compressors. The pool is null if it couldn't
+// be created.
+struct SharedThreadPool {
+  std::shared_ptr<ZSTD_threadPool> pool;
+  size_t numThreads;
+};
+const SharedThreadPool& sharedThreadPool();
+
+class ThreadPool : public ObjectWrapHelper<ThreadPool> {
+ public:
+  static const napi_type_tag typeTag;
+  static void Init(Napi::Env env, Napi::Object exports);
+  ThreadPool(const Napi::CallbackInfo& info);
+
+ private:
+  friend class CCtx;
+  // Shared with every context referencing the pool, which must not outlive it
+  std::shared_ptr<ZSTD_threadPool> pool;
+  size_t numThreads = 0;
+
+  // Worker stacks aren't allocated on the heap, so aren't worth reporting
+  int64_t getCurrentSize() override { return 0; }
+
+  Napi::Value wrapGetNumThreads(const Napi::CallbackInfo& info);
+};
+
+#endif
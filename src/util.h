@@ -17,6 +17,17 @@ static inline void checkArgCount(const Napi::CallbackInfo& info, size_t count) {
   }
 }
 
+static inline void checkArgCount(const Napi::CallbackInfo& info,
+                                 size_t minCount,
+                                 size_t maxCount) {
+  if (info.Length() < minCount || info.Length() > maxCount) {
+    char errMsg[128];
+    snprintf(errMsg, sizeof(errMsg), "Expected %zu-%zu arguments, got %zu",
+             minCount, maxCount, info.Length());
+    throw Napi::TypeError::New(info.Env(), errMsg);
+  }
+}
+
 static inline void checkZstdError(Napi::Env env, size_t ret) {
   if (ZSTD_isError(ret))
     throw Napi::Error::New(env, ZSTD_getErrorName(ret));
@@ -27,6 +38,19 @@ static inline Napi::Number convertZstdResult(Napi::Env env, size_t ret) {
   return Napi::Number::New(env, ret);
 }
 
+// No block decompresses to more than ZSTD_BLOCKSIZE_MAX bytes, and the smallest
+// block (an RLE block) is its 3-byte header plus a single byte
+static constexpr unsigned long long kMaxBlockOutput = ZSTD_BLOCKSIZE_MAX;
+static constexpr size_t kMinBlockSize = 4;
+
+// Whether `srcSize` bytes of frames could really decompress to `contentSize`
+// bytes, as claimed by their headers
+static inline bool isPlausibleContentSize(unsigned long long contentSize,
+                                          size_t srcSize) {
+  unsigned long long maxBlocks = srcSize / kMinBlockSize;
+  return contentSize <= maxBlocks * kMaxBlockOutput;
+}
+
 static inline ZSTD_inBuffer makeZstdInBuffer(Napi::Uint8Array& buf) {
   ZSTD_inBuffer result;
   result.src = buf.Data();
@@ -56,6 +80,44 @@ static inline Napi::Value makeStreamResult(Napi::Env env,
   return result;
 }
 
+// The *Into streaming methods store their StreamResult in a caller-provided
+// Float64Array, so hot loops don't allocate an array on every call. Validated
+// before the call so a bad argument can't discard progress.
+static inline double* getStreamResultArray(Napi::Env env, Napi::Value value) {
+  if (!value.IsTypedArray() ||
+      value.As<Napi::TypedArray>().TypedArrayType() != napi_float64_array ||
+      value.As<Napi::TypedArray>().ElementLength() < 3) {
+    throw Napi::TypeError::New(
+        env, "Result must be a Float64Array with at least 3 elements");
+  }
+  return value.As<Napi::Float64Array>().Data();
+}
+
+static inline void storeStreamResult(Napi::Env env,
+                                     double* result,
+                                     size_t ret,
+                                     ZSTD_outBuffer& outBuf,
+                                     ZSTD_inBuffer& inBuf) {
+  checkZstdError(env, ret);
+  result[0] = static_cast<double>(ret);
+  result[1] = static_cast<double>(outBuf.pos);
+  result[2] = static_cast<double>(inBuf.pos);
+}
+
+// Optional starting position in a buffer passed to the *Into streaming methods.
+// The stable buffer parameters require every call to pass the same buffer, with
+// the position where the previous call left off.
+static inline size_t getBufferPos(Napi::Env env,
+                                  Napi::Value value,
+                                  size_t size) {
+  if (value.IsUndefined())
+    return 0;
+  double pos = value.ToNumber().DoubleValue();
+  if (!(pos >= 0 && pos <= static_cast<double>(size)))
+    throw Napi::RangeError::New(env, "Buffer position is out of range");
+  return static_cast<size_t>(pos);
+}
+
 template <typename T, size_t (*fn)(T*)>
 using zstd_unique_ptr =
     std::unique_ptr<T, std::integral_constant<decltype(fn), fn>>;
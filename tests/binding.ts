@@ -1,4 +1,12 @@
-import { beforeEach, describe, expect, test } from '@jest/globals';
+import {
+  afterEach,
+  beforeEach,
+  describe,
+  expect,
+  test,
+} from '@jest/globals';
+import { strict as assert } from 'assert';
+import { randomBytes } from 'crypto';
 import * as events from 'events';
 import * as fs from 'fs';
 import * as path from 'path';
@@ -28,6 +36,9 @@ const abcDictFrame = hex('28b52ffd237448b2231e650000306162633132330100014b11');
 const abcStreamFrame = hex('28b52ffd0058650000306162633132330100014b11');
 const abcFrameContent = Buffer.from('abc123abc123abc123abc123abc123');
 
+// Single RLE block of 10 bytes, in a frame claiming 4 GiB of content
+const bombFrame = hex('28b52ffde0000000000100000053000061');
+
 function expectCompress(
   input: Buffer,
   expected: Buffer,
@@ -86,6 +97,17 @@ describe('CCtx', () => {
     );
   });
 
+  test('#compressUsingCDictAsync works', async () => {
+    const cdict = new binding.CDict(minDict, 3);
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const len = await cctx.compressUsingCDictAsync(
+      output,
+      abcFrameContent,
+      cdict,
+    );
+    expect(output.subarray(0, len).equals(abcDictFrame)).toBe(true);
+  });
+
   test('#compressUsingCDict rejects invalid dictionary objects', () => {
     expect(() => {
       const ddict = new binding.DDict(minDict);
@@ -130,6 +152,35 @@ describe('CCtx', () => {
     );
   });
 
+  test('#compress2Async works', async () => {
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const len = await cctx.compress2Async(output, abcFrameContent);
+    expect(output.subarray(0, len).equals(abcFrame)).toBe(true);
+  });
+
+  test('#compress2Async propagates errors', async () => {
+    await expect(
+      cctx.compress2Async(Buffer.alloc(0), abcFrameContent),
+    ).rejects.toThrow('Destination buffer is too small');
+  });
+
+  test('#compress2Async locks the context until complete', async () => {
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const promise = cctx.compress2Async(output, abcFrameContent);
+    expect(() => {
+      cctx.compress2(output, abcFrameContent);
+    }).toThrowErrorMatchingInlineSnapshot(
+      `"Object is in use by an asynchronous operation"`,
+    );
+    expect(() => {
+      void cctx.compress2Async(output, abcFrameContent);
+    }).toThrowErrorMatchingInlineSnapshot(
+      `"Object is in use by an asynchronous operation"`,
+    );
+    await promise;
+    expect(cctx.compress2(output, abcFrameContent)).toBe(abcFrame.length);
+  });
+
   test('#compressStream2 works', () => {
     const output = Buffer.alloc(abcStreamFrame.length);
     let [toFlush, dstProduced, srcConsumed] = cctx.compressStream2(
@@ -151,6 +202,201 @@ describe('CCtx', () => {
     expect(output.equals(abcStreamFrame)).toBe(true);
   });
 
+  test('#compressStream2Async works', async () => {
+    const output = Buffer.alloc(abcStreamFrame.length);
+    const [toFlush, dstProduced, srcConsumed] =
+      await cctx.compressStream2Async(
+        output,
+        abcFrameContent,
+        binding.EndDirective.end,
+      );
+    expect(toFlush).toBe(0);
+    expect(dstProduced).toBe(output.length);
+    expect(srcConsumed).toBe(abcFrameContent.length);
+    expect(output.equals(abcStreamFrame)).toBe(true);
+  });
+
+  test('#compressStream2Into works', () => {
+    const output = Buffer.alloc(abcStreamFrame.length);
+    const result = new Float64Array(3);
+    cctx.compressStream2Into(
+      output,
+      abcFrameContent,
+      binding.EndDirective.end,
+      result,
+    );
+    expect(Array.from(result)).toStrictEqual([
+      0,
+      output.length,
+      abcFrameContent.length,
+    ]);
+    expect(output.equals(abcStreamFrame)).toBe(true);
+  });
+
+  test('#compressStream2Into rejects invalid result arrays', () => {
+    const output = Buffer.alloc(abcStreamFrame.length);
+    for (const result of [new Float64Array(2), new Uint32Array(3)]) {
+      expect(() => {
+        cctx.compressStream2Into(
+          output,
+          abcFrameContent,
+          binding.EndDirective.end,
+          // @ts-expect-error: testing invalid value
+          result,
+        );
+      }).toThrow(TypeError);
+    }
+  });
+
+  test('#compressStream2Into continues from the given positions', () => {
+    cctx.setParameter(binding.CParameter.stableInBuffer, 1);
+    cctx.setParameter(binding.CParameter.stableOutBuffer, 1);
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const input = Buffer.from(abcFrameContent);
+    const result = new Float64Array(3);
+    const half = input.length / 2;
+    cctx.compressStream2Into(
+      output,
+      input.subarray(0, half),
+      binding.EndDirective.continue,
+      result,
+    );
+    // Stable buffers may grow, as long as they start at the same place
+    cctx.compressStream2Into(
+      output,
+      input,
+      binding.EndDirective.end,
+      result,
+      result[1],
+      result[2],
+    );
+    expect(result[0]).toBe(0);
+    expect(result[2]).toBe(input.length);
+    const decompressed = Buffer.alloc(input.length);
+    new binding.DCtx().decompressStream(
+      decompressed,
+      output.subarray(0, result[1]),
+    );
+    expect(decompressed.equals(input)).toBe(true);
+  });
+
+  test('#compressStream2Into rejects positions out of range', () => {
+    const output = Buffer.alloc(abcStreamFrame.length);
+    const result = new Float64Array(3);
+    for (const [dstPos, srcPos] of [
+      [output.length + 1, 0],
+      [0, -1],
+      [0, NaN],
+    ]) {
+      expect(() => {
+        cctx.compressStream2Into(
+          output,
+          abcFrameContent,
+          binding.EndDirective.end,
+          result,
+          dstPos,
+          srcPos,
+        );
+      }).toThrow(RangeError);
+    }
+  });
+
+  test('#getFrameProgression reports progress', () => {
+    const output = Buffer.alloc(abcStreamFrame.length);
+    cctx.compressStream2(
+      output,
+      abcFrameContent,
+      binding.EndDirective.continue,
+    );
+    // Input is buffered until a whole block is available
+    expect(cctx.getFrameProgression()).toStrictEqual({
+      ingested: abcFrameContent.length,
+      consumed: 0,
+      produced: 0,
+      flushed: 0,
+      currentJobID: 0,
+      nbActiveWorkers: 0,
+    });
+    expect(cctx.toFlushNow()).toBe(0);
+
+    cctx.compressStream2(output, Buffer.alloc(0), binding.EndDirective.end);
+    expect(cctx.getFrameProgression()).toMatchObject({
+      ingested: abcFrameContent.length,
+      consumed: abcFrameContent.length,
+    });
+  });
+
+  test('#compressBatch works', () => {
+    const src = Buffer.concat([abcFrameContent, abcFrameContent]);
+    const srcOffsets = new Uint32Array([0, 30, 30, 60]);
+    const dstOffsets = new Uint32Array(4);
+    const output = Buffer.alloc(256);
+    const len = cctx.compressBatch(output, src, srcOffsets, dstOffsets);
+    const expected = Buffer.concat([abcFrame, minEmptyFrame, abcFrame]);
+    expect(output.subarray(0, len).equals(expected)).toBe(true);
+    expect(Array.from(dstOffsets)).toStrictEqual([
+      0,
+      abcFrame.length,
+      abcFrame.length + minEmptyFrame.length,
+      expected.length,
+    ]);
+  });
+
+  test('#compressBatch validates offsets', () => {
+    const output = Buffer.alloc(256);
+    expect(() =>
+      cctx.compressBatch(
+        output,
+        abcFrameContent,
+        new Uint32Array([0, 31]),
+        new Uint32Array(2),
+      ),
+    ).toThrowErrorMatchingInlineSnapshot(`"Invalid source offsets"`);
+    expect(() =>
+      cctx.compressBatch(
+        output,
+        abcFrameContent,
+        new Uint32Array([20, 10]),
+        new Uint32Array(2),
+      ),
+    ).toThrowErrorMatchingInlineSnapshot(`"Invalid source offsets"`);
+    expect(() =>
+      cctx.compressBatch(
+        output,
+        abcFrameContent,
+        new Uint32Array([0, 30]),
+        new Uint32Array(3),
+      ),
+    ).toThrowErrorMatchingInlineSnapshot(
+      `"Offset arrays must have the same, non-zero length"`,
+    );
+  });
+
+  test('#compressBatch propagates errors', () => {
+    expect(() =>
+      cctx.compressBatch(
+        Buffer.alloc(abcFrame.length + 1),
+        Buffer.concat([abcFrameContent, abcFrameContent]),
+        new Uint32Array([0, 30, 60]),
+        new Uint32Array(3),
+      ),
+    ).toThrow('Destination buffer is too small');
+  });
+
+  test('#compressBatchAsync works', async () => {
+    const srcOffsets = new Uint32Array([0, 30]);
+    const dstOffsets = new Uint32Array(2);
+    const output = Buffer.alloc(256);
+    const len = await cctx.compressBatchAsync(
+      output,
+      abcFrameContent,
+      srcOffsets,
+      dstOffsets,
+    );
+    expect(output.subarray(0, len).equals(abcFrame)).toBe(true);
+    expect(Array.from(dstOffsets)).toStrictEqual([0, abcFrame.length]);
+  });
+
   test('#loadDictionary works', () => {
     cctx.loadDictionary(minDict);
     expectCompress(abcFrameContent, abcDictFrame, (dst, src) =>
@@ -158,6 +404,100 @@ describe('CCtx', () => {
     );
   });
 
+  test('#refCDict works', () => {
+    cctx.refCDict(new binding.CDict(minDict, 3));
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const frame = output.subarray(0, cctx.compress2(output, abcFrameContent));
+    expect(binding.getDictIDFromFrame(frame)).toBe(minDictId);
+    expectDecompress(frame, abcFrameContent, (dst, src) =>
+      new binding.DCtx().decompressUsingDict(dst, src, minDict),
+    );
+  });
+
+  // 'abc123' once as literals, then a 24-byte match of it
+  const abcSequences = Uint32Array.of(6, 6, 24, 0);
+
+  test('#compressSequences works', () => {
+    cctx.setParameter(binding.CParameter.validateSequences, 1);
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const len = cctx.compressSequences(output, abcSequences, abcFrameContent);
+    expectDecompress(
+      output.subarray(0, len),
+      abcFrameContent,
+      binding.decompress,
+    );
+  });
+
+  test('#compressSequencesAsync works', async () => {
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const len = await cctx.compressSequencesAsync(
+      output,
+      abcSequences,
+      abcFrameContent,
+    );
+    expectDecompress(
+      output.subarray(0, len),
+      abcFrameContent,
+      binding.decompress,
+    );
+  });
+
+  test('#compressSequences rejects partial sequences', () => {
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    expect(() => {
+      cctx.compressSequences(output, new Uint32Array(3), abcFrameContent);
+    }).toThrowErrorMatchingInlineSnapshot(
+      `"Sequences must have 4 elements each"`,
+    );
+  });
+
+  test('#registerSequenceProducer rejects other values', () => {
+    expect(() => {
+      // @ts-expect-error: testing invalid value
+      cctx.registerSequenceProducer({});
+    }).toThrow(TypeError);
+    cctx.registerSequenceProducer(null);
+  });
+
+  test('#refThreadPool shares workers between contexts', () => {
+    const pool = new binding.ThreadPool(2);
+    const input = Buffer.concat(
+      Array.from({ length: 1000 }, () => abcFrameContent),
+    );
+    for (const other of [cctx, new binding.CCtx()]) {
+      other.setParameter(binding.CParameter.nbWorkers, 2);
+      other.refThreadPool(pool);
+      const output = Buffer.alloc(binding.compressBound(input.length));
+      const frame = output.subarray(0, other.compress2(output, input));
+      expectDecompress(frame, input, binding.decompress);
+    }
+    cctx.refThreadPool(null);
+  });
+
+  test('#refPrefix matches against the prefix for one frame', () => {
+    const prefix = randomBytes(4096);
+    const output = Buffer.alloc(binding.compressBound(prefix.length));
+    cctx.refPrefix(prefix);
+    const patch = output.subarray(0, cctx.compress2(output, prefix));
+    const plain = binding.compress(output.subarray(patch.length), prefix, 3);
+    expect(patch.length).toBeLessThan(plain / 10);
+
+    const dctx = new binding.DCtx();
+    dctx.refPrefix(prefix);
+    expectDecompress(patch, prefix, (dst, src) => dctx.decompress(dst, src));
+    expect(() => {
+      dctx.decompress(Buffer.alloc(prefix.length), patch);
+    }).toThrow();
+  });
+
+  test('#reset clears referenced dictionary', () => {
+    cctx.refCDict(new binding.CDict(minDict, 3));
+    cctx.reset(binding.ResetDirective.parameters);
+    expectCompress(abcFrameContent, abcFrame, (dst, src) =>
+      cctx.compress2(dst, src),
+    );
+  });
+
   test('prototype property descriptors have standard attributes', () => {
     expectPrototypeProperties(binding.CCtx.prototype);
   });
@@ -175,6 +515,59 @@ describe('CDict', () => {
     expect(cdict.getDictID()).toBe(minDictId);
   });
 
+  test('identical dictionaries can be created repeatedly', () => {
+    const cdicts = [
+      new binding.CDict(minDict, 3),
+      new binding.CDict(Buffer.from(minDict), 3),
+    ];
+    for (const cdict of cdicts) {
+      expect(cdict.getDictID()).toBe(minDictId);
+      expectCompress(abcFrameContent, abcDictFrame, (dst, src) =>
+        new binding.CCtx().compressUsingCDict(dst, src, cdict),
+      );
+    }
+    expect(new binding.CDict(minDict, 9).getDictID()).toBe(minDictId);
+  });
+
+  function expectCDictRoundTrip(cdict: binding.CDict): void {
+    const cctx = new binding.CCtx();
+    cctx.refCDict(cdict);
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const frame = output.subarray(0, cctx.compress2(output, abcFrameContent));
+    expect(binding.getDictIDFromFrame(frame)).toBe(minDictId);
+    expectDecompress(frame, abcFrameContent, (dst, src) =>
+      new binding.DCtx().decompressUsingDict(dst, src, minDict),
+    );
+  }
+
+  test('constructor accepts advanced parameters', () => {
+    const params = Int32Array.of(
+      binding.CParameter.compressionLevel,
+      19,
+      binding.CParameter.windowLog,
+      20,
+      binding.CParameter.strategy,
+      binding.Strategy.btopt,
+    );
+    const cdict = new binding.CDict(minDict, params, false);
+    expect(cdict.getDictID()).toBe(minDictId);
+    expectCDictRoundTrip(cdict);
+  });
+
+  test('constructor can reference the dictionary in place', () => {
+    const params = Int32Array.of(binding.CParameter.compressionLevel, 3);
+    const cdict = new binding.CDict(Buffer.from(minDict), params, true);
+    expect(cdict.getDictID()).toBe(minDictId);
+    expectCDictRoundTrip(cdict);
+  });
+
+  test('constructor rejects invalid advanced parameters', () => {
+    const params = Int32Array.of(binding.CParameter.windowLog, 100);
+    expect(() => new binding.CDict(minDict, params, false)).toThrow(
+      'Parameter is out of bound',
+    );
+  });
+
   test('prototype property descriptors have standard attributes', () => {
     expectPrototypeProperties(binding.CDict.prototype);
   });
@@ -193,6 +586,98 @@ describe('DCtx', () => {
     );
   });
 
+  test('#decompressAsync works', async () => {
+    const output = Buffer.alloc(abcFrameContent.length);
+    const len = await dctx.decompressAsync(output, abcFrame);
+    expect(output.subarray(0, len).equals(abcFrameContent)).toBe(true);
+  });
+
+  test('#decompressAsync locks the context until complete', async () => {
+    const output = Buffer.alloc(abcFrameContent.length);
+    const promise = dctx.decompressAsync(output, abcFrame);
+    expect(() => {
+      dctx.reset(binding.ResetDirective.sessionOnly);
+    }).toThrowErrorMatchingInlineSnapshot(
+      `"Object is in use by an asynchronous operation"`,
+    );
+    await expect(promise).resolves.toBe(abcFrameContent.length);
+    dctx.reset(binding.ResetDirective.sessionOnly);
+  });
+
+  test('#decompressBatch works', () => {
+    const src = Buffer.concat([abcFrame, minEmptyFrame, abcFrame]);
+    const srcOffsets = new Uint32Array([
+      0,
+      abcFrame.length,
+      abcFrame.length + minEmptyFrame.length,
+      src.length,
+    ]);
+    const dstOffsets = new Uint32Array(4);
+    const output = Buffer.alloc(60);
+    const len = dctx.decompressBatch(output, src, srcOffsets, dstOffsets);
+    expect(len).toBe(60);
+    expect(
+      output.equals(Buffer.concat([abcFrameContent, abcFrameContent])),
+    ).toBe(true);
+    expect(Array.from(dstOffsets)).toStrictEqual([0, 30, 30, 60]);
+  });
+
+  test('#decompressBatchAsync works', async () => {
+    const srcOffsets = new Uint32Array([0, abcFrame.length]);
+    const dstOffsets = new Uint32Array(2);
+    const output = Buffer.alloc(abcFrameContent.length);
+    const len = await dctx.decompressBatchAsync(
+      output,
+      abcFrame,
+      srcOffsets,
+      dstOffsets,
+    );
+    expect(len).toBe(abcFrameContent.length);
+    expect(output.equals(abcFrameContent)).toBe(true);
+    expect(Array.from(dstOffsets)).toStrictEqual([0, abcFrameContent.length]);
+  });
+
+  test('#decompressBatchAsync propagates errors', async () => {
+    await expect(
+      dctx.decompressBatchAsync(
+        Buffer.alloc(1),
+        abcFrame,
+        new Uint32Array([0, abcFrame.length]),
+        new Uint32Array(2),
+      ),
+    ).rejects.toThrow('Destination buffer is too small');
+  });
+
+  test('#refDDict works', () => {
+    dctx.refDDict(new binding.DDict(minDict));
+    expectDecompress(abcDictFrame, abcFrameContent, (output) =>
+      dctx.decompress(output, abcDictFrame),
+    );
+  });
+
+  test('#refDDict selects dictionaries by ID with refMultipleDDicts', () => {
+    const otherDictId = minDictId + 1;
+    const otherDict = Buffer.from(minDict);
+    otherDict.writeUInt32LE(otherDictId, 4);
+    const cctx = new binding.CCtx();
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const otherFrame = output.subarray(
+      0,
+      cctx.compressUsingDict(output, abcFrameContent, otherDict, 3),
+    );
+    expect(binding.getDictIDFromFrame(otherFrame)).toBe(otherDictId);
+
+    dctx.setParameter(binding.DParameter.refMultipleDDicts, 1);
+    dctx.refDDict(new binding.DDict(minDict));
+    dctx.refDDict(new binding.DDict(otherDict));
+    expectDecompress(abcDictFrame, abcFrameContent, (dst, src) =>
+      dctx.decompress(dst, src),
+    );
+    expectDecompress(otherFrame, abcFrameContent, (dst, src) =>
+      dctx.decompress(dst, src),
+    );
+  });
+
   test('#decompressStream works', () => {
     const output = Buffer.alloc(abcFrameContent.length);
     let [inputHint, dstProduced, srcConsumed] = dctx.decompressStream(
@@ -212,6 +697,104 @@ describe('DCtx', () => {
     expect(output.equals(abcFrameContent)).toBe(true);
   });
 
+  test('#decompressStreamAsync works', async () => {
+    const output = Buffer.alloc(abcFrameContent.length);
+    const [inputHint, dstProduced, srcConsumed] =
+      await dctx.decompressStreamAsync(output, abcStreamFrame);
+    expect(inputHint).toBe(0);
+    expect(dstProduced).toBe(abcFrameContent.length);
+    expect(srcConsumed).toBe(abcStreamFrame.length);
+    expect(output.equals(abcFrameContent)).toBe(true);
+  });
+
+  test('#decompressStreamInto works', () => {
+    const output = Buffer.alloc(abcFrameContent.length);
+    const result = new Float64Array(3);
+    dctx.decompressStreamInto(output, abcStreamFrame, result);
+    expect(Array.from(result)).toStrictEqual([
+      0,
+      abcFrameContent.length,
+      abcStreamFrame.length,
+    ]);
+    expect(output.equals(abcFrameContent)).toBe(true);
+  });
+
+  test('#decompressStreamInto continues from the given position', () => {
+    dctx.setParameter(binding.DParameter.stableOutBuffer, 1);
+    const output = Buffer.alloc(abcFrameContent.length);
+    const result = new Float64Array(3);
+    const head = abcStreamFrame.subarray(0, -4);
+    const tail = abcStreamFrame.subarray(-4);
+    dctx.decompressStreamInto(output, head, result);
+    dctx.decompressStreamInto(output, tail, result, result[1]);
+    expect(Array.from(result)).toStrictEqual([
+      0,
+      abcFrameContent.length,
+      tail.length,
+    ]);
+    expect(output.equals(abcFrameContent)).toBe(true);
+  });
+
+  test('#decompressStreamInto enforces stableOutBuffer', () => {
+    dctx.setParameter(binding.DParameter.stableOutBuffer, 1);
+    const output = Buffer.alloc(abcFrameContent.length);
+    const result = new Float64Array(3);
+    dctx.decompressStreamInto(output, abcStreamFrame.subarray(0, -4), result);
+    expect(() => {
+      dctx.decompressStreamInto(
+        Buffer.alloc(output.length),
+        abcStreamFrame.subarray(-4),
+        result,
+      );
+    }).toThrow('Destination buffer is wrong');
+  });
+
+  test('#decompressStreamAsync propagates errors', async () => {
+    await expect(
+      dctx.decompressStreamAsync(Buffer.alloc(1), Buffer.alloc(16)),
+    ).rejects.toThrow('Unknown frame descriptor');
+  });
+
+  test('#decompressFrames continues across frames', () => {
+    const input = Buffer.concat([abcStreamFrame, minStreamFrame, abcFrame]);
+    const output = Buffer.alloc(2 * abcFrameContent.length);
+    const [inputHint, dstProduced, srcConsumed] = dctx.decompressFrames(
+      output,
+      input,
+    );
+    expect(inputHint).toBe(0);
+    expect(dstProduced).toBe(output.length);
+    expect(srcConsumed).toBe(input.length);
+    expect(
+      output.equals(Buffer.concat([abcFrameContent, abcFrameContent])),
+    ).toBe(true);
+  });
+
+  test('#decompressFrames stops when the output is full', () => {
+    const input = Buffer.concat([abcStreamFrame, abcStreamFrame]);
+    const output = Buffer.alloc(abcFrameContent.length);
+    const [, dstProduced, srcConsumed] = dctx.decompressFrames(output, input);
+    expect(dstProduced).toBe(abcFrameContent.length);
+    expect(srcConsumed).toBe(abcStreamFrame.length);
+    expect(output.equals(abcFrameContent)).toBe(true);
+  });
+
+  test('#decompressFramesAsync works', async () => {
+    const input = Buffer.concat([abcStreamFrame, abcStreamFrame]);
+    const output = Buffer.alloc(2 * abcFrameContent.length);
+    const [inputHint, dstProduced, srcConsumed] =
+      await dctx.decompressFramesAsync(output, input);
+    expect(inputHint).toBe(0);
+    expect(dstProduced).toBe(output.length);
+    expect(srcConsumed).toBe(input.length);
+  });
+
+  test('#decompressFramesAsync propagates errors', async () => {
+    await expect(
+      dctx.decompressFramesAsync(Buffer.alloc(1), Buffer.alloc(16)),
+    ).rejects.toThrow('Unknown frame descriptor');
+  });
+
   test('#decompressUsingDict works', () => {
     expectDecompress(abcDictFrame, abcFrameContent, (output) =>
       dctx.decompressUsingDict(output, abcDictFrame, minDict),
@@ -262,6 +845,16 @@ describe('DCtx', () => {
     );
   });
 
+  test('#refPrefix rejects non-idle contexts', async () => {
+    const promise = dctx.decompressAsync(Buffer.alloc(1), minEmptyFrame);
+    expect(() => {
+      dctx.refPrefix(Buffer.alloc(1));
+    }).toThrowErrorMatchingInlineSnapshot(
+      `"Object is in use by an asynchronous operation"`,
+    );
+    await promise;
+  });
+
   test('prototype property descriptors have standard attributes', () => {
     expectPrototypeProperties(binding.DCtx.prototype);
   });
@@ -284,6 +877,152 @@ describe('DDict', () => {
   });
 });
 
+describe('ThreadPool', () => {
+  test('#getNumThreads works', () => {
+    expect(new binding.ThreadPool(3).getNumThreads()).toBe(3);
+  });
+
+  test('constructor rejects invalid thread counts', () => {
+    expect(() => new binding.ThreadPool(0)).toThrow(RangeError);
+  });
+
+  test('constructor without a count returns the shared pool', () => {
+    const shared = new binding.ThreadPool();
+    const { upperBound } = binding.cParamGetBounds(
+      binding.CParameter.nbWorkers,
+    );
+    expect(shared.getNumThreads()).toBeGreaterThanOrEqual(1);
+    expect(shared.getNumThreads()).toBeLessThanOrEqual(upperBound);
+    expect(new binding.ThreadPool().getNumThreads()).toBe(
+      shared.getNumThreads(),
+    );
+  });
+
+  test('prototype property descriptors have standard attributes', () => {
+    expectPrototypeProperties(binding.ThreadPool.prototype);
+  });
+});
+
+// Seek table (in the seekable format) for frames of the given sizes
+function makeSeekTable(frames: [number, number][]): Buffer {
+  const table = Buffer.alloc(8 + frames.length * 8 + 9);
+  table.writeUInt32LE(0x184d2a5e, 0);
+  table.writeUInt32LE(table.length - 8, 4);
+  frames.forEach(([compressedSize, decompressedSize], i) => {
+    table.writeUInt32LE(compressedSize, 8 + i * 8);
+    table.writeUInt32LE(decompressedSize, 12 + i * 8);
+  });
+  table.writeUInt32LE(frames.length, table.length - 9);
+  table.writeUInt32LE(0x8f92eab1, table.length - 4);
+  return table;
+}
+
+describe('SeekableReader', () => {
+  const frames = Buffer.concat([abcFrame, abcStreamFrame]);
+  const content = Buffer.concat([abcFrameContent, abcFrameContent]);
+  const seekTable = makeSeekTable([
+    [abcFrame.length, abcFrameContent.length],
+    [abcStreamFrame.length, abcFrameContent.length],
+  ]);
+  let reader: binding.SeekableReader;
+
+  beforeEach(() => {
+    reader = new binding.SeekableReader(Buffer.concat([frames, seekTable]));
+  });
+
+  test('constructor errors on missing seek table', () => {
+    expect(() => {
+      new binding.SeekableReader(abcFrame);
+    }).toThrowErrorMatchingInlineSnapshot(`"Missing seek table"`);
+  });
+
+  test('constructor errors on truncated seek table', () => {
+    expect(() => {
+      new binding.SeekableReader(seekTable.subarray(4));
+    }).toThrow(RangeError);
+  });
+
+  test('constructor errors on corrupt seek table', () => {
+    const corrupt = Buffer.from(seekTable);
+    corrupt.writeUInt32LE(0, 4);
+    expect(() => {
+      new binding.SeekableReader(corrupt);
+    }).toThrowErrorMatchingInlineSnapshot(`"Corrupt seek table"`);
+  });
+
+  test('constructor errors on implausible frame sizes', () => {
+    // At most one maximum-size block per 4 bytes of compressed data
+    const limit = 4 * 128 * 1024;
+    const largest = new binding.SeekableReader(makeSeekTable([[16, limit]]));
+    expect(largest.getFrameDecompressedSize(0)).toBe(limit);
+    expect(() => {
+      new binding.SeekableReader(makeSeekTable([[16, limit + 1]]));
+    }).toThrowErrorMatchingInlineSnapshot(`"Corrupt seek table"`);
+  });
+
+  test('frame accessors work', () => {
+    expect(reader.getNumFrames()).toBe(2);
+    expect(reader.getFrameCompressedOffset(1)).toBe(abcFrame.length);
+    expect(reader.getFrameCompressedOffset(2)).toBe(frames.length);
+    expect(reader.getFrameCompressedSize(1)).toBe(abcStreamFrame.length);
+    expect(reader.getFrameDecompressedOffset(1)).toBe(30);
+    expect(reader.getFrameDecompressedOffset(2)).toBe(60);
+    expect(reader.getFrameDecompressedSize(0)).toBe(30);
+    expect(() => reader.getFrameCompressedSize(2)).toThrow(RangeError);
+    expect(() => reader.getFrameDecompressedOffset(-1)).toThrow(RangeError);
+  });
+
+  test('#offsetToFrameIndex works', () => {
+    expect(reader.offsetToFrameIndex(0)).toBe(0);
+    expect(reader.offsetToFrameIndex(29)).toBe(0);
+    expect(reader.offsetToFrameIndex(30)).toBe(1);
+    expect(reader.offsetToFrameIndex(60)).toBe(2);
+  });
+
+  test('#decompress works across frames', () => {
+    const output = Buffer.alloc(20);
+    expect(reader.decompress(output, frames, 20)).toBe(20);
+    expect(output.equals(content.subarray(20, 40))).toBe(true);
+  });
+
+  test('#decompress only needs the overlapping frames', () => {
+    const output = Buffer.alloc(10);
+    const src = frames.subarray(abcFrame.length);
+    expect(reader.decompress(output, src, 35)).toBe(10);
+    expect(output.equals(content.subarray(35, 45))).toBe(true);
+  });
+
+  test('#decompress stops at the end of the data', () => {
+    const output = Buffer.alloc(100);
+    expect(reader.decompress(output, frames, 50)).toBe(10);
+    expect(output.subarray(0, 10).equals(content.subarray(50))).toBe(true);
+  });
+
+  test('#decompress errors if frames are missing', () => {
+    expect(() => {
+      reader.decompress(Buffer.alloc(60), abcFrame, 0);
+    }).toThrowErrorMatchingInlineSnapshot(`"Src size is incorrect"`);
+  });
+
+  test('#decompressAsync works', async () => {
+    const output = Buffer.alloc(content.length);
+    await expect(reader.decompressAsync(output, frames, 0)).resolves.toBe(
+      content.length,
+    );
+    expect(output.equals(content)).toBe(true);
+  });
+
+  test('seekTableSize works', () => {
+    expect(binding.seekTableSize(seekTable.subarray(-9))).toBe(
+      seekTable.length,
+    );
+  });
+
+  test('prototype property descriptors have standard attributes', () => {
+    expectPrototypeProperties(binding.SeekableReader.prototype);
+  });
+});
+
 test('versionString works', () => {
   expect(binding.versionString()).toBe('1.5.7');
 });
@@ -304,6 +1043,148 @@ test('decompress works', () => {
   );
 });
 
+describe('compressPooled', () => {
+  test('works', () => {
+    const params = Int32Array.of(binding.CParameter.compressionLevel, 3);
+    expectCompress(abcFrameContent, abcFrame, (dest, src) =>
+      binding.compressPooled(dest, src, params),
+    );
+  });
+
+  test('applies parameters', () => {
+    const params = Int32Array.of(
+      binding.CParameter.windowLog,
+      10,
+      binding.CParameter.contentSizeFlag,
+      0,
+    );
+    expectCompress(Buffer.alloc(0), minStreamFrame, (dest, src) =>
+      binding.compressPooled(dest, src, params),
+    );
+    // Same parameter set in a different order gets the same result
+    params.set([binding.CParameter.contentSizeFlag, 0]);
+    params.set([binding.CParameter.windowLog, 10], 2);
+    expectCompress(Buffer.alloc(0), minStreamFrame, (dest, src) =>
+      binding.compressPooled(dest, src, params),
+    );
+    // Parameters don't leak between parameter sets
+    expectCompress(abcFrameContent, abcFrame, (dest, src) =>
+      binding.compressPooled(dest, src, new Int32Array(0)),
+    );
+  });
+
+  test('rejects malformed parameter lists', () => {
+    expect(() => {
+      binding.compressPooled(
+        Buffer.alloc(0),
+        Buffer.alloc(0),
+        Int32Array.of(binding.CParameter.compressionLevel),
+      );
+    }).toThrowErrorMatchingInlineSnapshot(
+      `"Parameter list must have an even length"`,
+    );
+  });
+
+  test('propagates parameter errors', () => {
+    const params = Int32Array.of(binding.CParameter.windowLog, 1);
+    expect(() => {
+      binding.compressPooled(Buffer.alloc(64), Buffer.alloc(0), params);
+    }).toThrowErrorMatchingInlineSnapshot(`"Parameter is out of bound"`);
+  });
+});
+
+test('compressPooledAsync works', async () => {
+  const outputs = Array.from({ length: 8 }, () =>
+    Buffer.alloc(binding.compressBound(abcFrameContent.length)),
+  );
+  const lengths = await Promise.all(
+    outputs.map((output) =>
+      binding.compressPooledAsync(output, abcFrameContent, new Int32Array(0)),
+    ),
+  );
+  expect(lengths).toStrictEqual(Array(8).fill(abcFrame.length));
+  for (const output of outputs) {
+    expect(output.subarray(0, abcFrame.length).equals(abcFrame)).toBe(true);
+  }
+});
+
+test('decompressPooled works', () => {
+  const params = Int32Array.of(binding.DParameter.windowLogMax, 20);
+  expectDecompress(abcFrame, abcFrameContent, (dest, src) =>
+    binding.decompressPooled(dest, src, params),
+  );
+});
+
+test('decompressPooledAsync works', async () => {
+  const output = Buffer.alloc(abcFrameContent.length);
+  await expect(
+    binding.decompressPooledAsync(output, abcFrame, new Int32Array(0)),
+  ).resolves.toBe(abcFrameContent.length);
+  expect(output.equals(abcFrameContent)).toBe(true);
+});
+
+describe('decompressParallel', () => {
+  const input = Buffer.concat(
+    Array.from({ length: 16 }, () => Buffer.concat([abcFrame, minEmptyFrame])),
+  );
+  const expected = Buffer.concat(
+    Array.from({ length: 16 }, () => abcFrameContent),
+  );
+  const params = new Int32Array(0);
+
+  test('decompresses every frame into place', () => {
+    for (const threads of [0, 1, 4, 64]) {
+      const output = Buffer.alloc(expected.length);
+      expect(binding.decompressParallel(output, input, params, threads)).toBe(
+        expected.length,
+      );
+      expect(output.equals(expected)).toBe(true);
+    }
+  });
+
+  test('async version works', async () => {
+    const output = Buffer.alloc(expected.length);
+    await expect(
+      binding.decompressParallelAsync(output, input, params, 4),
+    ).resolves.toBe(expected.length);
+    expect(output.equals(expected)).toBe(true);
+  });
+
+  test('handles empty input', () => {
+    expect(
+      binding.decompressParallel(Buffer.alloc(0), Buffer.alloc(0), params, 4),
+    ).toBe(0);
+  });
+
+  test('requires every frame to record its size', () => {
+    const output = Buffer.alloc(2 * abcFrameContent.length);
+    expect(() =>
+      binding.decompressParallel(
+        output,
+        Buffer.concat([abcFrame, abcStreamFrame]),
+        params,
+        4,
+      ),
+    ).toThrow('Unsupported frame parameter');
+  });
+
+  test('throws error when output is too small', () => {
+    const output = Buffer.alloc(expected.length - 1);
+    expect(() => {
+      binding.decompressParallel(output, input, params, 4);
+    }).toThrowErrorMatchingInlineSnapshot(`"Destination buffer is too small"`);
+  });
+
+  test('throws error when a frame is corrupt', async () => {
+    const corrupt = Buffer.from(input);
+    corrupt[corrupt.length - 3] ^= 0xff;
+    const output = Buffer.alloc(expected.length);
+    await expect(
+      binding.decompressParallelAsync(output, corrupt, params, 4),
+    ).rejects.toThrow();
+  });
+});
+
 describe('getFrameContentSize', () => {
   test('works on normal frames', () => {
     expect(binding.getFrameContentSize(minEmptyFrame)).toBe(0);
@@ -324,6 +1205,189 @@ test('findFrameCompressedSize works', () => {
   );
 });
 
+describe('findDecompressedSize', () => {
+  test('sums the sizes of all frames', () => {
+    const input = Buffer.concat([abcFrame, minEmptyFrame, abcFrame]);
+    expect(binding.findDecompressedSize(input)).toBe(
+      2 * abcFrameContent.length,
+    );
+  });
+  test('returns null when any size is unknown', () => {
+    const input = Buffer.concat([abcFrame, abcStreamFrame]);
+    expect(binding.findDecompressedSize(input)).toBeNull();
+  });
+  test('throws error when a frame is corrupt', () => {
+    const input = Buffer.concat([abcFrame, abcFrame.subarray(0, 8)]);
+    expect(() => {
+      binding.findDecompressedSize(input);
+    }).toThrowErrorMatchingInlineSnapshot(`"Could not parse Zstandard frames"`);
+  });
+});
+
+describe('decompressBound', () => {
+  test('bounds frames without content size', () => {
+    const input = Buffer.concat([abcFrame, abcStreamFrame]);
+    expect(binding.decompressBound(input)).toBeGreaterThanOrEqual(
+      2 * abcFrameContent.length,
+    );
+  });
+  test('throws error when a frame is corrupt', () => {
+    expect(() => {
+      binding.decompressBound(abcFrame.subarray(0, 8));
+    }).toThrowErrorMatchingInlineSnapshot(`"Could not parse Zstandard frames"`);
+  });
+});
+
+describe('checkDecompressedSize', () => {
+  test('returns the size of frames with content size', () => {
+    const input = Buffer.concat([abcFrame, abcFrame]);
+    expect(binding.checkDecompressedSize(input, Infinity)).toBe(
+      2 * abcFrameContent.length,
+    );
+  });
+  test('returns null when any size is unknown', () => {
+    const input = Buffer.concat([abcFrame, abcStreamFrame]);
+    expect(binding.checkDecompressedSize(input, 0)).toBeNull();
+  });
+  test('enforces maxOutputSize', () => {
+    const size = abcFrameContent.length;
+    expect(binding.checkDecompressedSize(abcFrame, size)).toBe(size);
+    expect(() => {
+      binding.checkDecompressedSize(abcFrame, size - 1);
+    }).toThrow(RangeError);
+  });
+  test('rejects sizes larger than the frame could hold', () => {
+    expect(binding.findDecompressedSize(bombFrame)).toBe(2 ** 32);
+    expect(() => {
+      binding.checkDecompressedSize(bombFrame, Infinity);
+    }).toThrowErrorMatchingInlineSnapshot(
+      `"Frame content size is larger than its data allows"`,
+    );
+  });
+  test('allows up to a maximum-size block per 4 bytes of input', () => {
+    // Same layout as bombFrame: 17 bytes, so room for at most 4 blocks
+    const claiming = (size: number): Buffer => {
+      const frame = Buffer.from(bombFrame);
+      frame.writeBigUInt64LE(BigInt(size), 5);
+      return frame;
+    };
+    const limit = 4 * 128 * 1024;
+    expect(binding.checkDecompressedSize(claiming(limit), Infinity)).toBe(
+      limit,
+    );
+    expect(() => {
+      binding.checkDecompressedSize(claiming(limit + 1), Infinity);
+    }).toThrow('Frame content size is larger than its data allows');
+  });
+  test('throws error when a frame is corrupt', () => {
+    expect(() => {
+      binding.checkDecompressedSize(abcFrame.subarray(0, 8), Infinity);
+    }).toThrowErrorMatchingInlineSnapshot(`"Could not parse Zstandard frames"`);
+  });
+});
+
+describe('scanFrames', () => {
+  const { FRAME_FIELD_COUNT, FrameField } = binding;
+  // Skippable frame with magic number variant 3 and a 3-byte payload
+  const skippableFrame = hex('532a4d1803000000616263');
+
+  function rows(table: Float64Array): number[][] {
+    const result = [];
+    for (let i = 0; i < table.length; i += FRAME_FIELD_COUNT) {
+      result.push(Array.from(table.subarray(i, i + FRAME_FIELD_COUNT)));
+    }
+    return result;
+  }
+
+  test('has a column per field', () => {
+    expect(FRAME_FIELD_COUNT).toBe(Object.keys(FrameField).length / 2);
+  });
+
+  test('describes every frame', () => {
+    const input = Buffer.concat([abcFrame, skippableFrame, abcDictFrame]);
+    const table = rows(binding.scanFrames(input));
+    expect(table).toHaveLength(3);
+    const contentSize = abcFrameContent.length;
+    expect(table[0]).toStrictEqual([
+      0,
+      abcFrame.length,
+      contentSize,
+      contentSize,
+      contentSize,
+      0,
+      0,
+      0,
+    ]);
+    expect(table[1]).toStrictEqual([
+      abcFrame.length,
+      skippableFrame.length,
+      0,
+      0,
+      0,
+      3,
+      0,
+      1,
+    ]);
+    expect(table[2]?.[FrameField.offset]).toBe(
+      abcFrame.length + skippableFrame.length,
+    );
+    expect(table[2]?.[FrameField.dictID]).toBe(minDictId);
+  });
+
+  test('bounds frames without content size', () => {
+    const [row] = rows(binding.scanFrames(abcStreamFrame));
+    expect(row?.[FrameField.contentSize]).toBe(-1);
+    expect(row?.[FrameField.decompressBound]).toBeGreaterThanOrEqual(
+      abcFrameContent.length,
+    );
+    expect(row?.[FrameField.windowSize]).toBe(2 ** 21);
+  });
+
+  test('returns an empty table for empty input', () => {
+    expect(binding.scanFrames(Buffer.alloc(0))).toHaveLength(0);
+  });
+
+  test('throws error when a frame is corrupt', () => {
+    const input = Buffer.concat([abcFrame, abcFrame.subarray(0, 8)]);
+    expect(() => {
+      binding.scanFrames(input);
+    }).toThrowErrorMatchingInlineSnapshot(`"Could not parse Zstandard frames"`);
+  });
+});
+
+describe('skippable frames', () => {
+  const { SKIPPABLEHEADERSIZE } = binding;
+
+  test('round trip through write and read', () => {
+    const payload = Buffer.from('metadata');
+    const frame = Buffer.alloc(payload.length + SKIPPABLEHEADERSIZE);
+    expect(binding.writeSkippableFrame(frame, payload, 7)).toBe(frame.length);
+    const table = binding.scanFrames(frame);
+    expect(table[binding.FrameField.frameType]).toBe(1);
+    expect(table[binding.FrameField.dictID]).toBe(7);
+
+    const dst = Buffer.alloc(payload.length);
+    expect(binding.readSkippableFrame(dst, frame)).toStrictEqual([
+      payload.length,
+      7,
+    ]);
+    expect(dst.equals(payload)).toBe(true);
+  });
+
+  test('writeSkippableFrame rejects invalid variants', () => {
+    const frame = Buffer.alloc(SKIPPABLEHEADERSIZE);
+    expect(() =>
+      binding.writeSkippableFrame(frame, Buffer.alloc(0), 16),
+    ).toThrow();
+  });
+
+  test('readSkippableFrame rejects other frames', () => {
+    expect(() =>
+      binding.readSkippableFrame(Buffer.alloc(100), abcFrame),
+    ).toThrow();
+  });
+});
+
 describe('compressBound', () => {
   test('works on normal values', () => {
     const bound = binding.compressBound(0);
@@ -396,6 +1460,180 @@ test('wrapGetDictIDFromFrame works', () => {
   expect(binding.getDictIDFromFrame(minDictFrame)).toBe(minDictId);
 });
 
+describe('stats', () => {
+  const { Stat } = binding;
+
+  function delta(after: Float64Array, before: Float64Array, i: number) {
+    return (after[i] ?? 0) - (before[i] ?? 0);
+  }
+
+  afterEach(() => {
+    binding.setStatsEnabled(false);
+  });
+
+  test('CCtx counters only advance while enabled', () => {
+    const cctx = new binding.CCtx();
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    cctx.compress2(output, abcFrameContent);
+    expect(Array.from(cctx.getStats())).toEqual([0, 0, 0, 0, 0]);
+
+    binding.setStatsEnabled(true);
+    const len = cctx.compress2(output, abcFrameContent);
+    const stats = cctx.getStats();
+    expect(stats[Stat.calls]).toBe(1);
+    expect(stats[Stat.bytesIn]).toBe(abcFrameContent.length);
+    expect(stats[Stat.bytesOut]).toBe(len);
+    expect(stats[Stat.nanos]).toBeGreaterThan(0);
+    expect(stats[Stat.peakMemory]).toBeGreaterThan(0);
+  });
+
+  test('DCtx counts streaming progress from async calls', async () => {
+    binding.setStatsEnabled(true);
+    const dctx = new binding.DCtx();
+    const output = Buffer.alloc(abcFrameContent.length);
+    await dctx.decompressStreamAsync(output, abcStreamFrame.subarray(0, 10));
+    await dctx.decompressStreamAsync(output, abcStreamFrame.subarray(10));
+    const stats = dctx.getStats();
+    expect(stats[Stat.calls]).toBe(2);
+    expect(stats[Stat.bytesIn]).toBe(abcStreamFrame.length);
+    expect(stats[Stat.bytesOut]).toBe(abcFrameContent.length);
+  });
+
+  test('getStats aggregates over the process', () => {
+    binding.setStatsEnabled(true);
+    const before = binding.getStats();
+    const half = before.length / 2;
+    expect(half).toBe(Object.keys(Stat).length / 2);
+
+    const output = Buffer.alloc(binding.compressBound(abcFrameContent.length));
+    const params = new Int32Array(0);
+    const len = binding.compressPooled(output, abcFrameContent, params);
+    new binding.DCtx().decompress(output, abcFrame);
+    const after = binding.getStats();
+
+    expect(delta(after, before, Stat.calls)).toBe(1);
+    expect(delta(after, before, Stat.bytesIn)).toBe(abcFrameContent.length);
+    expect(delta(after, before, Stat.bytesOut)).toBe(len);
+    expect(delta(after, before, half + Stat.calls)).toBe(1);
+    expect(delta(after, before, half + Stat.bytesIn)).toBe(abcFrame.length);
+    expect(delta(after, before, half + Stat.bytesOut)).toBe(
+      abcFrameContent.length,
+    );
+  });
+});
+
+describe('dictionary builder', () => {
+  // Small records with plenty of shared structure, like real training data
+  const samples = Array.from({ length: 1000 }, (_, i) =>
+    Buffer.from(
+      JSON.stringify({
+        id: i,
+        name: `user-${(i * 7919) % 1000}`,
+        email: `user${i}@example.com`,
+        active: i % 3 === 0,
+        tags: ['alpha', 'beta', 'gamma', 'delta'].slice(i % 4),
+      }),
+    ),
+  );
+  const samplesBuf = Buffer.concat(samples);
+  const sampleSizes = Uint32Array.from(samples, (s) => s.length);
+
+  function expectDictRoundTrip(dict: Buffer): void {
+    const sample = samples[42];
+    assert(sample);
+    const cctx = new binding.CCtx();
+    const compressed = Buffer.alloc(binding.compressBound(sample.length));
+    const len = cctx.compressUsingDict(compressed, sample, dict, 3);
+    const frame = compressed.subarray(0, len);
+    expect(binding.getDictIDFromFrame(frame)).toBe(
+      binding.getDictIDFromDict(dict),
+    );
+    const dctx = new binding.DCtx();
+    const output = Buffer.alloc(sample.length);
+    expect(dctx.decompressUsingDict(output, frame, dict)).toBe(sample.length);
+    expect(output.equals(sample)).toBe(true);
+  }
+
+  test('trainFromBuffer works', async () => {
+    const dict = Buffer.alloc(4096);
+    const size = await binding.trainFromBuffer(dict, samplesBuf, sampleSizes);
+    expect(size).toBeGreaterThan(0);
+    expect(size).toBeLessThanOrEqual(dict.length);
+    expect(binding.getDictIDFromDict(dict)).not.toBe(0);
+    expectDictRoundTrip(dict.subarray(0, size));
+  });
+
+  test('trainFromBuffer propagates errors', async () => {
+    await expect(
+      binding.trainFromBuffer(
+        Buffer.alloc(4096),
+        Buffer.alloc(16),
+        new Uint32Array([8, 8]),
+      ),
+    ).rejects.toThrow();
+  });
+
+  test('trainFromBuffer validates sample sizes', () => {
+    expect(() =>
+      binding.trainFromBuffer(
+        Buffer.alloc(4096),
+        Buffer.alloc(16),
+        new Uint32Array([8, 9]),
+      ),
+    ).toThrowErrorMatchingInlineSnapshot(
+      `"Sample sizes exceed samples buffer length"`,
+    );
+  });
+
+  test('optimizeTrainFromBufferCover works', async () => {
+    const dict = Buffer.alloc(4096);
+    const result = await binding.optimizeTrainFromBufferCover(
+      dict,
+      samplesBuf,
+      sampleSizes,
+      { k: 200, d: 8, nbThreads: 2, dictID: 1234 },
+    );
+    expect(result).toMatchObject({ k: 200, d: 8 });
+    expect(result.dictSize).toBeGreaterThan(0);
+    expect(binding.getDictIDFromDict(dict)).toBe(1234);
+    expectDictRoundTrip(dict.subarray(0, result.dictSize));
+  });
+
+  test('optimizeTrainFromBufferFastCover selects parameters', async () => {
+    const dict = Buffer.alloc(4096);
+    const result = await binding.optimizeTrainFromBufferFastCover(
+      dict,
+      samplesBuf,
+      sampleSizes,
+      { steps: 4, nbThreads: 2 },
+    );
+    expect(result).toMatchObject({
+      dictSize: expect.any(Number),
+      k: expect.any(Number),
+      d: expect.any(Number),
+      f: expect.any(Number),
+      accel: expect.any(Number),
+    });
+    expect(result.k).toBeGreaterThan(0);
+    expect(result.d).toBeGreaterThan(0);
+    expectDictRoundTrip(dict.subarray(0, result.dictSize));
+  });
+
+  test('finalizeDictionary works', async () => {
+    const content = samplesBuf.subarray(0, 2048);
+    const dict = Buffer.alloc(4096);
+    const size = await binding.finalizeDictionary(
+      dict,
+      content,
+      samplesBuf,
+      sampleSizes,
+      { dictID: 5678 },
+    );
+    expect(binding.getDictIDFromDict(dict)).toBe(5678);
+    expectDictRoundTrip(dict.subarray(0, size));
+  });
+});
+
 test('loading from multiple threads works', async () => {
   async function runInWorker() {
     const worker = new Worker('./binding.js');
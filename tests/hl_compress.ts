@@ -9,14 +9,32 @@ import {
 import { strict as assert } from 'assert';
 import { randomBytes } from 'crypto';
 import { expectTypeOf } from 'expect-type';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import * as v8 from 'v8';
+import * as vm from 'vm';
 import * as binding from '../binding';
 import {
   Compressor,
   CompressParameters,
   CompressStream,
+  Decompressor,
   compress,
+  compressAsync,
+  compressFile,
   decompress,
+  prepareCompressDictionary,
 } from '../lib';
+import { LevelController } from '../lib/compress';
+
+const minDict = fs.readFileSync(path.join(__dirname, 'data', 'minimal.dct'));
+
+function expectDictDecompress(input: Buffer, expected: Buffer): void {
+  const decompressor = new Decompressor();
+  decompressor.loadDictionary(minDict);
+  expect(decompressor.decompress(input).equals(expected)).toBe(true);
+}
 
 function expectDecompress(input: Buffer, expected: Buffer): void {
   const output = decompress(input);
@@ -76,6 +94,66 @@ describe('Compressor', () => {
     expect(output.buffer).toBe(scratch?.buffer);
   });
 
+  test('#compressAsync compresses data', async () => {
+    const input = Buffer.from('hello');
+    const output = await compressor.compressAsync(input);
+    expectDecompress(output, input);
+  });
+
+  test('#compressAsync avoids copying incompressible output', async () => {
+    const input = randomBytes(8192);
+    const output = await compressor.compressAsync(input);
+    expectDecompress(output, input);
+    expect(output.buffer.byteLength).toBe(binding.compressBound(input.length));
+  });
+
+  test('#compressSequences compresses data', async () => {
+    const original = Buffer.from('abc123abc123abc123abc123abc123');
+    // 'abc123' once as literals, then a 24-byte match of it
+    const sequences = Uint32Array.of(6, 6, 24, 0);
+    compressor.updateParameters({ validateSequences: true });
+    expectDecompress(
+      compressor.compressSequences(sequences, original),
+      original,
+    );
+    expectDecompress(
+      await compressor.compressSequencesAsync(sequences, original),
+      original,
+    );
+  });
+
+  test('#compressBatch compresses each buffer', () => {
+    const inputs = [
+      Buffer.from('hello'),
+      Buffer.alloc(0),
+      randomBytes(8192),
+      Buffer.from('world'),
+    ];
+    const outputs = compressor.compressBatch(inputs);
+    expect(outputs).toHaveLength(inputs.length);
+    inputs.forEach((input, i) => {
+      const output = outputs[i];
+      assert(output);
+      expectDecompress(output, input);
+      expect(output.equals(compressor.compress(input))).toBe(true);
+    });
+  });
+
+  test('#compressBatch handles an empty batch', () => {
+    expect(compressor.compressBatch([])).toStrictEqual([]);
+  });
+
+  test('#compressBatchAsync compresses each buffer', async () => {
+    const inputs = [Buffer.from('hello'), Buffer.from('world')];
+    const outputs = await compressor.compressBatchAsync(inputs);
+    expect(outputs).toHaveLength(inputs.length);
+    inputs.forEach((input, i) => {
+      const output = outputs[i];
+      assert(output);
+      expectDecompress(output, input);
+    });
+  });
+
   test('#loadDictionary works', () => {
     using loadDict = jest.spyOn(compressor['cctx'], 'loadDictionary');
 
@@ -84,6 +162,33 @@ describe('Compressor', () => {
     expect(loadDict).toHaveBeenCalledWith(dictBuf);
   });
 
+  test('#loadDictionary accepts prepared dictionaries', () => {
+    using refCDict = jest.spyOn(compressor['cctx'], 'refCDict');
+
+    const cdict = new binding.CDict(minDict, 3);
+    compressor.loadDictionary(cdict);
+    expect(refCDict).toHaveBeenCalledWith(cdict);
+
+    const input = Buffer.from('hello hello hello');
+    const output = compressor.compress(input);
+    expect(binding.getDictIDFromFrame(output)).toBe(cdict.getDictID());
+    expectDictDecompress(output, input);
+  });
+
+  test('#loadDictionary accepts tuned dictionaries', () => {
+    const cdict = prepareCompressDictionary(
+      minDict,
+      { compressionLevel: 19, windowLog: 20 },
+      { byReference: true },
+    );
+    compressor.loadDictionary(cdict);
+
+    const input = Buffer.from('hello hello hello');
+    const output = compressor.compress(input);
+    expect(binding.getDictIDFromFrame(output)).toBe(cdict.getDictID());
+    expectDictDecompress(output, input);
+  });
+
   test('#setParameters resets other parameters', () => {
     using reset = jest.spyOn(compressor['cctx'], 'reset');
     using setParam = jest.spyOn(compressor['cctx'], 'setParameter');
@@ -155,6 +260,20 @@ describe('Compressor', () => {
     compressor.updateParameters({ compressionLevel: undefined });
     expect(setParam).not.toHaveBeenCalled();
   });
+
+  test('#updateParameters shares a thread pool for nbWorkers', () => {
+    using refPool = jest.spyOn(compressor['cctx'], 'refThreadPool');
+    const other = new Compressor();
+    using otherRefPool = jest.spyOn(other['cctx'], 'refThreadPool');
+
+    compressor.updateParameters({ nbWorkers: 2 });
+    other.updateParameters({ nbWorkers: 4 });
+    expect(refPool).toHaveBeenCalledTimes(1);
+    expect(otherRefPool.mock.calls).toStrictEqual(refPool.mock.calls);
+
+    const input = randomBytes(1024);
+    expect(decompress(compressor.compress(input)).equals(input)).toBe(true);
+  });
 });
 
 describe('CompressParameters', () => {
@@ -191,6 +310,41 @@ describe('CompressStream', () => {
     stream.end('hello');
   });
 
+  test('dictionary option works', (done) => {
+    const cdict = new binding.CDict(minDict, 3);
+    const dictStream = new CompressStream({}, { dictionary: cdict });
+    const dictChunks: Buffer[] = [];
+    dictStream.on('data', (chunk: Buffer) => dictChunks.push(chunk));
+    dictStream.on('end', () => {
+      const output = Buffer.concat(dictChunks);
+      expect(binding.getDictIDFromFrame(output)).toBe(cdict.getDictID());
+      expectDictDecompress(output, Buffer.from('hello'));
+      return done();
+    });
+
+    dictStream.end('hello');
+  });
+
+  test('can be dropped mid-frame with nbWorkers and a dictionary', async () => {
+    // Collects the stream while its first job may still be queued
+    v8.setFlagsFromString('--expose-gc');
+    const gc = vm.runInNewContext('gc') as () => void;
+    (() => {
+      const cdict = new binding.CDict(minDict, 3);
+      const dropped = new CompressStream(
+        { nbWorkers: 2 },
+        { dictionary: cdict },
+      );
+      dropped.write(randomBytes(4 * 1024 * 1024));
+    })();
+    gc();
+    await new Promise(setImmediate);
+    gc();
+
+    const input = randomBytes(1024);
+    expectDecompress(compress(input, { nbWorkers: 2 }), input);
+  });
+
   test('#endFrame ends the frame at the correct point', (done) => {
     stream.on('end', () => {
       const result = Buffer.concat(chunks);
@@ -267,7 +421,7 @@ describe('CompressStream', () => {
 
   test('#_transform correctly propagates errors', (done) => {
     using _compress = jest
-      .spyOn(stream['cctx'], 'compressStream2')
+      .spyOn(stream['cctx'], 'compressStream2Into')
       .mockImplementationOnce(() => {
         throw new Error('Simulated error');
       });
@@ -284,7 +438,7 @@ describe('CompressStream', () => {
 
   test('#_flush correctly propagates errors', (done) => {
     using _compress = jest
-      .spyOn(stream['cctx'], 'compressStream2')
+      .spyOn(stream['cctx'], 'compressStream2Into')
       .mockImplementationOnce(() => {
         throw new Error('Simulated error');
       });
@@ -298,6 +452,106 @@ describe('CompressStream', () => {
     stream.end();
   });
 
+  test('#writeMetadata writes a skippable frame between frames', (done) => {
+    stream.on('end', () => {
+      const result = Buffer.concat(chunks);
+      const { FRAME_FIELD_COUNT, FrameField } = binding;
+      const table = binding.scanFrames(result);
+      const types = [];
+      for (let i = 0; i < table.length; i += FRAME_FIELD_COUNT) {
+        types.push(table[i + FrameField.frameType]);
+      }
+      expect(types).toStrictEqual([0, 1, 0]);
+      expect(table[FRAME_FIELD_COUNT + FrameField.dictID]).toBe(5);
+      expectDecompress(result, Buffer.from('helloworld'));
+      return done();
+    });
+
+    stream.write('hello');
+    stream.writeMetadata(5, Buffer.from('metadata'));
+    stream.end('world');
+  });
+
+  test('#writeMetadata at the end adds no empty frame', (done) => {
+    stream.on('end', () => {
+      const result = Buffer.concat(chunks);
+      const frameLen = binding.findFrameCompressedSize(result);
+      const metadata = result.subarray(frameLen);
+      const dst = Buffer.alloc(8);
+      expect(binding.readSkippableFrame(dst, metadata)).toStrictEqual([8, 0]);
+      expect(dst.toString()).toBe('metadata');
+      return done();
+    });
+
+    stream.write('hello');
+    stream.writeMetadata(0, Buffer.from('metadata'));
+    stream.end();
+  });
+
+  test('#writeMetadata after an empty flush adds no empty frame', (done) => {
+    stream.on('end', () => {
+      const result = Buffer.concat(chunks);
+      const { FRAME_FIELD_COUNT, FrameField } = binding;
+      const table = binding.scanFrames(result);
+      const types = [];
+      for (let i = 0; i < table.length; i += FRAME_FIELD_COUNT) {
+        types.push(table[i + FrameField.frameType]);
+      }
+      expect(types).toStrictEqual([0, 1]);
+      expectDecompress(result, Buffer.from('hello'));
+      return done();
+    });
+
+    stream.write('hello');
+    stream.endFrame();
+    stream.flush();
+    stream.write(Buffer.alloc(0));
+    stream.writeMetadata(0, Buffer.from('metadata'));
+    stream.end();
+  });
+
+  test('offload option works', (done) => {
+    const original = randomBytes(300000);
+    const offloadStream = new CompressStream({}, { offload: true });
+    const offloadChunks: Buffer[] = [];
+    offloadStream.on('data', (chunk: Buffer) => offloadChunks.push(chunk));
+    offloadStream.on('end', () => {
+      const result = Buffer.concat(offloadChunks);
+      const firstFrameLen = binding.findFrameCompressedSize(result);
+      expectDecompress(result.subarray(0, firstFrameLen), original);
+      expectDecompress(result, Buffer.concat([original, original]));
+      return done();
+    });
+
+    offloadStream.write(original);
+    offloadStream.endFrame();
+    offloadStream.flush();
+    offloadStream.writeMetadata(0, Buffer.from('metadata'));
+    offloadStream.end(original);
+  });
+
+  test('emits progress events', (done) => {
+    const progress = jest.fn();
+    stream.on('progress', progress);
+    stream.on('end', () => {
+      expect(progress).toHaveBeenCalledTimes(2);
+      expect(progress).toHaveBeenLastCalledWith(
+        expect.objectContaining({ ingested: 5, consumed: 5 }),
+      );
+      return done();
+    });
+
+    stream.end('hello');
+  });
+
+  test('#getFrameProgression reports progress', (done) => {
+    stream.write('hello', () => {
+      expect(stream.getFrameProgression()).toMatchObject({ ingested: 5 });
+      stream.end();
+      return done();
+    });
+  });
+
   test('handles input larger than buffer size', (done) => {
     // Generate incompressible input that's larger than the buffer
     const input = randomBytes(binding.cStreamInSize() * 2 + 1);
@@ -314,6 +568,91 @@ describe('CompressStream', () => {
       stream.end();
     });
   });
+
+  test('adaptiveLevel option changes the level between jobs', async () => {
+    const adaptive = new CompressStream({}, { adaptiveLevel: {} });
+    using _progress = jest
+      .spyOn(adaptive['cctx'], 'getFrameProgression')
+      .mockReturnValue(progression(3));
+    using setParam = jest.spyOn(adaptive['cctx'], 'setParameter');
+    const adaptiveChunks: Buffer[] = [];
+    adaptive.on('data', (chunk: Buffer) => adaptiveChunks.push(chunk));
+    const ended = new Promise((resolve) => adaptive.on('end', resolve));
+    adaptive.end('hello');
+    await ended;
+
+    // Input was never held up, so compression can afford to work harder
+    expect(setParam).toHaveBeenCalledTimes(1);
+    expect(setParam).toHaveBeenCalledWith(
+      binding.CParameter.compressionLevel,
+      binding.defaultCLevel() + 1,
+    );
+    expectDecompress(Buffer.concat(adaptiveChunks), Buffer.from('hello'));
+  });
+
+  test('adaptiveLevel option requires multithreading', () => {
+    expect(
+      () => new CompressStream({ nbWorkers: 0 }, { adaptiveLevel: {} }),
+    ).toThrow(RangeError);
+  });
+});
+
+function progression(currentJobID: number): binding.FrameProgression {
+  return {
+    ingested: 0,
+    consumed: 0,
+    produced: 0,
+    flushed: 0,
+    currentJobID,
+    nbActiveWorkers: 1,
+  };
+}
+
+describe('LevelController', () => {
+  test('clamps the starting level to its bounds', () => {
+    expect(new LevelController(3, 1, { minLevel: 5 }).level).toBe(5);
+    expect(new LevelController(3, 1, { maxLevel: 2 }).level).toBe(2);
+    expect(
+      () => new LevelController(3, 1, { minLevel: 5, maxLevel: 4 }),
+    ).toThrow(RangeError);
+  });
+
+  test('only changes level once every worker has started a job', () => {
+    const controller = new LevelController(3, 2, {});
+    for (const jobID of [1, 2, 3, 3]) {
+      expect(controller.update(progression(jobID))).toBeUndefined();
+    }
+    expect(controller.update(progression(4))).toBe(4);
+    expect(controller.update(progression(4))).toBeUndefined();
+  });
+
+  test('rises when the output is blocked', () => {
+    const controller = new LevelController(3, 1, {});
+    controller.presentInput(true);
+    controller.blockOutput();
+    expect(controller.update(progression(3))).toBe(4);
+  });
+
+  test('drops when the input is often blocked', () => {
+    const controller = new LevelController(3, 1, {});
+    controller.presentInput(true);
+    controller.presentInput(false);
+    expect(controller.update(progression(3))).toBe(2);
+  });
+
+  test('holds when the input is rarely blocked', () => {
+    const controller = new LevelController(3, 1, {});
+    controller.presentInput(true);
+    for (let i = 0; i < 10; i++) controller.presentInput(false);
+    expect(controller.update(progression(3))).toBeUndefined();
+  });
+
+  test('stays within its bounds', () => {
+    const controller = new LevelController(3, 1, { maxLevel: 4 });
+    expect(controller.update(progression(3))).toBe(4);
+    expect(controller.update(progression(4))).toBeUndefined();
+    expect(controller.level).toBe(4);
+  });
 });
 
 describe('compress', () => {
@@ -321,4 +660,97 @@ describe('compress', () => {
     const input = Buffer.from('hello');
     expectDecompress(compress(input), input);
   });
+
+  test('respects parameters', () => {
+    const input = Buffer.from('hello');
+    const output = compress(input, { contentSizeFlag: false });
+    expect(binding.getFrameContentSize(output)).toBeNull();
+    expect(binding.getFrameContentSize(compress(input))).toBe(input.length);
+  });
+
+  test('compresses with workers from the shared pool', () => {
+    const input = randomBytes(1024 * 1024);
+    expectDecompress(compress(input, { nbWorkers: 2 }), input);
+  });
+
+  test('rejects invalid parameters', () => {
+    expect(() => {
+      // @ts-expect-error: deliberately passing wrong arguments
+      compress(Buffer.alloc(0), { invalidName: 42 });
+    }).toThrowErrorMatchingInlineSnapshot(
+      `"Invalid parameter name: invalidName"`,
+    );
+  });
+});
+
+describe('compressAsync', () => {
+  test('basic functionality works', async () => {
+    const input = Buffer.from('hello');
+    expectDecompress(await compressAsync(input), input);
+  });
+
+  test('handles concurrent calls', async () => {
+    const inputs = Array.from({ length: 16 }, () => randomBytes(4096));
+    const outputs = await Promise.all(
+      inputs.map((input, i) => compressAsync(input, { compressionLevel: i })),
+    );
+    outputs.forEach((output, i) => {
+      expectDecompress(output, inputs[i] as Buffer);
+    });
+  });
+});
+
+describe('compressFile', () => {
+  let dir: string;
+
+  beforeEach(async () => {
+    dir = await fs.promises.mkdtemp(path.join(os.tmpdir(), 'zstd-napi-'));
+  });
+
+  afterEach(async () => {
+    await fs.promises.rm(dir, { recursive: true });
+  });
+
+  test('compresses a file', async () => {
+    const original = Buffer.concat([
+      randomBytes(1024 * 1024),
+      Buffer.alloc(2 * 1024 * 1024),
+      randomBytes(1024 * 1024),
+    ]);
+    const src = path.join(dir, 'data');
+    const dst = path.join(dir, 'data.zst');
+    await fs.promises.writeFile(src, original);
+    const size = await compressFile(src, dst, { nbWorkers: 2 });
+    const output = await fs.promises.readFile(dst);
+    expect(output).toHaveLength(size);
+    expect(binding.getFrameContentSize(output)).toBe(original.length);
+    expectDecompress(output, original);
+  });
+
+  test('compresses an empty file', async () => {
+    const src = path.join(dir, 'empty');
+    const dst = path.join(dir, 'empty.zst');
+    await fs.promises.writeFile(src, Buffer.alloc(0));
+    await compressFile(src, dst);
+    expectDecompress(await fs.promises.readFile(dst), Buffer.alloc(0));
+  });
+
+  test('rejects the same file as input and output', async () => {
+    const original = randomBytes(100000);
+    const src = path.join(dir, 'data');
+    await fs.promises.writeFile(src, original);
+    await expect(compressFile(src, src)).rejects.toThrow(
+      'Input and output are the same file',
+    );
+    const contents = await fs.promises.readFile(src);
+    expect(contents.equals(original)).toBe(true);
+  });
+
+  test('rejects missing input without creating output', async () => {
+    const dst = path.join(dir, 'missing.zst');
+    await expect(
+      compressFile(path.join(dir, 'missing'), dst),
+    ).rejects.toThrow('Could not open input file');
+    expect(fs.existsSync(dst)).toBe(false);
+  });
 });
@@ -8,15 +8,51 @@ import {
 } from '@jest/globals';
 import { randomBytes } from 'crypto';
 import { expectTypeOf } from 'expect-type';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { Readable } from 'stream';
+import { pipeline } from 'stream/promises';
 import * as binding from '../binding';
 import {
+  Compressor,
+  DecompressIntoStream,
   Decompressor,
   DecompressParameters,
   DecompressStream,
   compress,
   decompress,
+  decompressAsync,
+  decompressFile,
+  decompressParallelAsync,
 } from '../lib';
 
+const minDict = fs.readFileSync(path.join(__dirname, 'data', 'minimal.dct'));
+
+// Same dictionary content under a different ID
+const otherDict = Buffer.from(minDict);
+otherDict.writeUInt32LE(minDict.readUInt32LE(4) + 1, 4);
+
+function compressWithDict(input: Buffer, dict: Buffer): Buffer {
+  const compressor = new Compressor();
+  compressor.loadDictionary(dict);
+  return compressor.compress(input);
+}
+
+function chunked(input: Buffer, size: number): Readable {
+  const chunks = [];
+  for (let i = 0; i < input.length; i += size) {
+    chunks.push(input.subarray(i, i + size));
+  }
+  return Readable.from(chunks);
+}
+
+function skippableFrame(magicVariant: number, payload: string): Buffer {
+  const frame = Buffer.alloc(payload.length + binding.SKIPPABLEHEADERSIZE);
+  binding.writeSkippableFrame(frame, Buffer.from(payload), magicVariant);
+  return frame;
+}
+
 describe('Decompressor', () => {
   let decompressor: Decompressor;
 
@@ -69,6 +105,117 @@ describe('Decompressor', () => {
     expect(decompressor.decompress(input).equals(original)).toBe(true);
   });
 
+  test('#decompressAsync handles frames with content size', async () => {
+    const original = Buffer.from('hello');
+    const input = compress(original);
+    const output = await decompressor.decompressAsync(input);
+    expect(output.equals(original)).toBe(true);
+  });
+
+  test('#decompressAsync handles frames without content size', async () => {
+    const originals = [Buffer.from('hello'), Buffer.from(' world')];
+    const frames = originals.map((b) =>
+      compress(b, { contentSizeFlag: false }),
+    );
+    const output = await decompressor.decompressAsync(Buffer.concat(frames));
+    expect(output.equals(Buffer.concat(originals))).toBe(true);
+  });
+
+  test('#decompress grows the output buffer as needed', () => {
+    using decompressFrames = jest.spyOn(
+      decompressor['dctx'],
+      'decompressFrames',
+    );
+
+    const original = Buffer.alloc(1024 * 1024);
+    const input = compress(original, { contentSizeFlag: false });
+    expect(decompressor.decompress(input).equals(original)).toBe(true);
+    expect(decompressFrames.mock.calls.length).toBeGreaterThan(1);
+  });
+
+  test('#decompress uses sizeHint for the initial allocation', () => {
+    using decompressFrames = jest.spyOn(
+      decompressor['dctx'],
+      'decompressFrames',
+    );
+
+    const original = Buffer.alloc(1024 * 1024);
+    const input = compress(original, { contentSizeFlag: false });
+    const output = decompressor.decompress(input, {
+      sizeHint: original.length,
+    });
+    expect(output.equals(original)).toBe(true);
+    expect(decompressFrames).toHaveBeenCalledTimes(1);
+  });
+
+  test('#decompress enforces maxOutputSize', () => {
+    const original = Buffer.alloc(1024 * 1024);
+    for (const contentSizeFlag of [true, false]) {
+      const input = compress(original, { contentSizeFlag });
+      expect(() =>
+        decompressor.decompress(input, { maxOutputSize: original.length - 1 }),
+      ).toThrow(RangeError);
+      const output = decompressor.decompress(input, {
+        maxOutputSize: original.length,
+      });
+      expect(output.equals(original)).toBe(true);
+    }
+  });
+
+  test('#decompress blames the input for exceeding its own bound', () => {
+    const original = Buffer.alloc(1024 * 1024);
+    const input = compress(original, { contentSizeFlag: false });
+    // Spy on the module object itself, as the namespace import is a copy
+    const native = jest.requireActual<typeof binding>('../binding');
+    using decompressBound = jest
+      .spyOn(native, 'decompressBound')
+      .mockReturnValue(1024);
+    expect(() => decompressor.decompress(input)).toThrow(
+      new Error('Decompressed size exceeds what the frame headers allow'),
+    );
+    expect(() =>
+      decompressor.decompress(input, { maxOutputSize: 1024 }),
+    ).toThrow(RangeError);
+    expect(decompressBound).toHaveBeenCalledTimes(2);
+  });
+
+  test('#decompress rejects truncated input', () => {
+    const original = Buffer.from('hello');
+    const input = compress(original, { contentSizeFlag: false });
+    expect(() =>
+      decompressor.decompress(input.subarray(0, input.length - 1)),
+    ).toThrowErrorMatchingInlineSnapshot(`"Could not parse Zstandard frames"`);
+    expect(decompressor.decompress(input).equals(original)).toBe(true);
+  });
+
+  test('#decompressAsync enforces maxOutputSize', async () => {
+    const original = Buffer.alloc(1024 * 1024);
+    const input = compress(original, { contentSizeFlag: false });
+    await expect(
+      decompressor.decompressAsync(input, { maxOutputSize: 1024 }),
+    ).rejects.toThrow(RangeError);
+  });
+
+  test('#decompressInto writes into the provided buffer', () => {
+    const original = Buffer.from('hello');
+    const input = compress(original, { contentSizeFlag: false });
+    const dest = Buffer.alloc(16);
+    expect(decompressor.decompressInto(dest, input)).toBe(original.length);
+    expect(dest.subarray(0, original.length).equals(original)).toBe(true);
+    expect(() =>
+      decompressor.decompressInto(Buffer.alloc(2), input),
+    ).toThrowErrorMatchingInlineSnapshot(`"Destination buffer is too small"`);
+  });
+
+  test('#decompressIntoAsync writes into the provided buffer', async () => {
+    const original = Buffer.from('hello');
+    const dest = Buffer.alloc(original.length);
+    await expect(
+      decompressor.decompressIntoAsync(dest, compress(original)),
+    ).resolves.toBe(original.length);
+    expect(dest.equals(original)).toBe(true);
+  });
+
   test('#loadDictionary works', () => {
     using loadDict = jest.spyOn(decompressor['dctx'], 'loadDictionary');
 
@@ -77,6 +224,30 @@ describe('Decompressor', () => {
     expect(loadDict).toHaveBeenCalledWith(dictBuf);
   });
 
+  test('#loadDictionary accepts prepared dictionaries', () => {
+    using refDDict = jest.spyOn(decompressor['dctx'], 'refDDict');
+
+    const ddict = new binding.DDict(minDict);
+    decompressor.loadDictionary(ddict);
+    expect(refDDict).toHaveBeenCalledWith(ddict);
+
+    const original = Buffer.from('hello');
+    const input = compressWithDict(original, minDict);
+    expect(decompressor.decompress(input).equals(original)).toBe(true);
+  });
+
+  test('#loadDictionary selects dictionaries by ID with refMultipleDDicts', () => {
+    decompressor.setParameters({ refMultipleDDicts: true });
+    decompressor.loadDictionary(new binding.DDict(minDict));
+    decompressor.loadDictionary(new binding.DDict(otherDict));
+
+    const original = Buffer.from('hello');
+    for (const dict of [minDict, otherDict]) {
+      const input = compressWithDict(original, dict);
+      expect(decompressor.decompress(input).equals(original)).toBe(true);
+    }
+  });
+
   test('#setParameters resets other parameters', () => {
     using reset = jest.spyOn(decompressor['dctx'], 'reset');
     using setParam = jest.spyOn(decompressor['dctx'], 'setParameter');
@@ -157,9 +328,31 @@ describe('DecompressStream', () => {
     stream.end(compress(original));
   });
 
+  test('dictionary option selects dictionaries by ID', (done) => {
+    const dictStream = new DecompressStream(
+      {},
+      {
+        dictionary: [new binding.DDict(minDict), new binding.DDict(otherDict)],
+      },
+    );
+    const dictChunks: Buffer[] = [];
+    dictStream.on('data', (chunk: Buffer) => dictChunks.push(chunk));
+    dictStream.on('end', () => {
+      expect(Buffer.concat(dictChunks).toString()).toBe('hello world');
+      return done();
+    });
+
+    dictStream.end(
+      Buffer.concat([
+        compressWithDict(Buffer.from('hello'), minDict),
+        compressWithDict(Buffer.from(' world'), otherDict),
+      ]),
+    );
+  });
+
   test('#_transform correctly propagates errors', (done) => {
     using _decompress = jest
-      .spyOn(stream['dctx'], 'decompressStream')
+      .spyOn(stream['dctx'], 'decompressStreamInto')
       .mockImplementationOnce(() => {
         throw new Error('Simulated error');
       });
@@ -243,6 +436,144 @@ describe('DecompressStream', () => {
       stream.end();
     });
   });
+
+  test('maxOutputSize option allows output up to the limit', (done) => {
+    const original = Buffer.alloc(100000);
+    const limitStream = new DecompressStream({}, { maxOutputSize: 100000 });
+    const limitChunks: Buffer[] = [];
+    limitStream.on('data', (chunk: Buffer) => limitChunks.push(chunk));
+    limitStream.on('end', () => {
+      expect(Buffer.concat(limitChunks).equals(original)).toBe(true);
+      return done();
+    });
+    limitStream.end(compress(original));
+  });
+
+  test('maxOutputSize option stops output over the limit', (done) => {
+    const limitStream = new DecompressStream({}, { maxOutputSize: 99999 });
+    let produced = 0;
+    limitStream.on('data', (chunk: Buffer) => (produced += chunk.length));
+    limitStream.on('error', (err) => {
+      expect(err).toBeInstanceOf(RangeError);
+      expect(produced).toBeLessThanOrEqual(99999);
+      return done();
+    });
+    limitStream.end(compress(Buffer.alloc(100000)));
+  });
+
+  test('offload option works', async () => {
+    const original = randomBytes(300000);
+    const input = Buffer.concat([
+      compress(original.subarray(0, 100000)),
+      compress(original.subarray(100000), { contentSizeFlag: false }),
+    ]);
+    const offloadStream = new DecompressStream({}, { offload: true });
+    const output: Buffer[] = [];
+    offloadStream.on('data', (chunk: Buffer) => output.push(chunk));
+    await pipeline(chunked(input, 50000), offloadStream);
+    expect(Buffer.concat(output).equals(original)).toBe(true);
+  });
+
+  test('offload option propagates errors', async () => {
+    const offloadStream = new DecompressStream({}, { offload: true });
+    await expect(
+      pipeline(chunked(Buffer.alloc(100), 10), offloadStream),
+    ).rejects.toThrow('Unknown frame descriptor');
+  });
+
+  describe('skippableFrames option', () => {
+    const input = Buffer.concat([
+      skippableFrame(1, 'first'),
+      compress(Buffer.from('hello')),
+      skippableFrame(2, ''),
+      skippableFrame(3, 'second'),
+      compress(Buffer.from('world'), { contentSizeFlag: false }),
+    ]);
+
+    async function run(
+      chunkSize: number,
+      skippableFrames = true,
+    ): Promise<[Buffer, [string, number][]]> {
+      const frames: [string, number][] = [];
+      const output: Buffer[] = [];
+      const frameStream = new DecompressStream({}, { skippableFrames });
+      frameStream.on('skippableFrame', (payload: Buffer, variant: number) => {
+        frames.push([payload.toString(), variant]);
+      });
+      frameStream.on('data', (chunk: Buffer) => output.push(chunk));
+      await pipeline(chunked(input, chunkSize), frameStream);
+      return [Buffer.concat(output), frames];
+    }
+
+    test('emits skippable frames', async () => {
+      for (const chunkSize of [1, 3, 7, input.length]) {
+        const [output, frames] = await run(chunkSize);
+        expect(output.toString()).toBe('helloworld');
+        expect(frames).toStrictEqual([
+          ['first', 1],
+          ['', 2],
+          ['second', 3],
+        ]);
+      }
+    });
+
+    test('is off by default', async () => {
+      const [output, frames] = await run(input.length, false);
+      expect(output.toString()).toBe('helloworld');
+      expect(frames).toHaveLength(0);
+    });
+
+    test('fails if in the middle of a skippable frame', async () => {
+      const frameStream = new DecompressStream({}, { skippableFrames: true });
+      const truncated = skippableFrame(0, 'metadata').subarray(0, 10);
+      await expect(
+        pipeline(chunked(truncated, 4), frameStream),
+      ).rejects.toThrow('Stream ended in middle of skippable frame');
+    });
+  });
+});
+
+describe('DecompressIntoStream', () => {
+  test('decompresses chunked input into the buffer', async () => {
+    const original = randomBytes(200000);
+    const input = Buffer.concat([
+      compress(original.subarray(0, 100000)),
+      compress(original.subarray(100000), { contentSizeFlag: false }),
+    ]);
+    const dest = Buffer.alloc(original.length + 1);
+    const stream = new DecompressIntoStream(dest);
+    await pipeline(chunked(input, 1000), stream);
+    expect(stream.bytesWritten).toBe(original.length);
+    expect(dest.subarray(0, original.length).equals(original)).toBe(true);
+  });
+
+  test('dictionary option works', async () => {
+    const dest = Buffer.alloc(5);
+    const stream = new DecompressIntoStream(
+      dest,
+      {},
+      { dictionary: minDict },
+    );
+    const input = compressWithDict(Buffer.from('hello'), minDict);
+    await pipeline(chunked(input, 3), stream);
+    expect(dest.toString()).toBe('hello');
+  });
+
+  test('fails if the output does not fit', async () => {
+    const input = compress(randomBytes(1000));
+    const stream = new DecompressIntoStream(Buffer.alloc(999));
+    await expect(pipeline(chunked(input, 100), stream)).rejects.toThrow(
+      'Destination buffer is too small',
+    );
+  });
+
+  test('fails if in the middle of a frame', async () => {
+    const input = compress(Buffer.from('hello'));
+    const stream = new DecompressIntoStream(Buffer.alloc(5));
+    await expect(
+      pipeline(chunked(input.subarray(0, input.length - 1), 3), stream),
+    ).rejects.toThrow('Stream ended in middle of compressed data frame');
+  });
 });
 
 describe('decompress', () => {
@@ -250,4 +581,147 @@ describe('decompress', () => {
     const original = Buffer.from('hello');
     expect(decompress(compress(original)).equals(original)).toBe(true);
   });
+
+  test('handles frames without content size', () => {
+    const original = Buffer.from('hello');
+    const input = compress(original, { contentSizeFlag: false });
+    expect(decompress(input).equals(original)).toBe(true);
+  });
+
+  test('enforces maxOutputSize', () => {
+    const original = Buffer.from('hello');
+    for (const contentSizeFlag of [true, false]) {
+      const input = compress(original, { contentSizeFlag });
+      expect(() => decompress(input, {}, { maxOutputSize: 4 })).toThrow(
+        RangeError,
+      );
+    }
+  });
+
+  test('rejects frames claiming more content than they hold', () => {
+    // Single RLE block of 10 bytes, in a frame claiming 4 GiB of content
+    const input = Buffer.from('28b52ffde0000000000100000053000061', 'hex');
+    using allocSpy = jest.spyOn(Buffer, 'allocUnsafe');
+    expect(() => decompress(input)).toThrow(
+      'Frame content size is larger than its data allows',
+    );
+    expect(allocSpy).not.toHaveBeenCalled();
+  });
+});
+
+describe('decompressAsync', () => {
+  test('handles frames with content size', async () => {
+    const original = Buffer.from('hello');
+    const output = await decompressAsync(compress(original));
+    expect(output.equals(original)).toBe(true);
+  });
+
+  test('handles frames without content size', async () => {
+    const original = Buffer.from('hello');
+    const input = compress(original, { contentSizeFlag: false });
+    const output = await decompressAsync(input);
+    expect(output.equals(original)).toBe(true);
+  });
+});
+
+describe('decompressParallelAsync', () => {
+  const parts = Array.from({ length: 32 }, () => randomBytes(1024));
+  const original = Buffer.concat(parts);
+
+  test('decompresses multi-frame data', async () => {
+    const input = Buffer.concat(parts.map((part) => compress(part)));
+    using parallel = jest.spyOn(binding, 'decompressParallelAsync');
+
+    const output = await decompressParallelAsync(input, {}, { threads: 4 });
+    expect(output.equals(original)).toBe(true);
+    expect(parallel.mock.calls.length).toBe(1);
+  });
+
+  test('falls back for frames without content size', async () => {
+    const input = Buffer.concat(
+      parts.map((part) => compress(part, { contentSizeFlag: false })),
+    );
+    const output = await decompressParallelAsync(input);
+    expect(output.equals(original)).toBe(true);
+  });
+
+  test('enforces maxOutputSize', async () => {
+    const input = Buffer.concat(parts.map((part) => compress(part)));
+    await expect(
+      decompressParallelAsync(input, {}, { maxOutputSize: 1024 }),
+    ).rejects.toThrow(RangeError);
+  });
+
+  test('rejects invalid thread counts', async () => {
+    await expect(
+      decompressParallelAsync(compress(original), {}, { threads: -1 }),
+    ).rejects.toThrow(RangeError);
+  });
+});
+
+describe('decompressFile', () => {
+  const original = Buffer.concat([
+    randomBytes(1024 * 1024),
+    Buffer.alloc(2 * 1024 * 1024),
+  ]);
+  let dir: string;
+
+  beforeEach(async () => {
+    dir = await fs.promises.mkdtemp(path.join(os.tmpdir(), 'zstd-napi-'));
+  });
+
+  afterEach(async () => {
+    await fs.promises.rm(dir, { recursive: true });
+  });
+
+  async function roundTrip(input: Buffer): Promise<Buffer> {
+    const src = path.join(dir, 'data.zst');
+    const dst = path.join(dir, 'data');
+    await fs.promises.writeFile(src, input);
+    const size = await decompressFile(src, dst);
+    const output = await fs.promises.readFile(dst);
+    expect(output).toHaveLength(size);
+    return output;
+  }
+
+  test('decompresses a file', async () => {
+    const output = await roundTrip(compress(original));
+    expect(output.equals(original)).toBe(true);
+  });
+
+  test('decompresses frames without content size', async () => {
+    const input = Buffer.concat([
+      compress(original.subarray(0, 1000), { contentSizeFlag: false }),
+      compress(original.subarray(1000)),
+    ]);
+    const output = await roundTrip(input);
+    expect(output.equals(original)).toBe(true);
+  });
+
+  test('rejects truncated input and removes the output', async () => {
+    const input = compress(original);
+    await expect(
+      roundTrip(input.subarray(0, input.length - 1)),
+    ).rejects.toThrow('File ended in middle of compressed data frame');
+    expect(fs.existsSync(path.join(dir, 'data'))).toBe(false);
+  });
+
+  test('rejects output linked to the input', async () => {
+    const input = compress(original);
+    const src = path.join(dir, 'data.zst');
+    const link = path.join(dir, 'link.zst');
+    await fs.promises.writeFile(src, input);
+    await fs.promises.link(src, link);
+    await expect(decompressFile(src, link)).rejects.toThrow(
+      'Input and output are the same file',
+    );
+    const contents = await fs.promises.readFile(src);
+    expect(contents.equals(input)).toBe(true);
+  });
+
+  test('rejects corrupt input', async () => {
+    await expect(roundTrip(Buffer.alloc(100))).rejects.toThrow(
+      'Unknown frame descriptor',
+    );
+  });
 });
@@ -0,0 +1,75 @@
+import { describe, expect, test } from '@jest/globals';
+import { randomBytes } from 'crypto';
+import {
+  compress,
+  compressDelta,
+  compressDeltaAsync,
+  decompressDelta,
+  decompressDeltaAsync,
+} from '../lib';
+
+// Incompressible on its own, so any savings come from the reference
+const reference = randomBytes(256 * 1024);
+const edited = Buffer.concat([
+  reference.subarray(0, 1000),
+  Buffer.from('inserted content'),
+  reference.subarray(1000, 200 * 1024),
+  randomBytes(100),
+  reference.subarray(210 * 1024),
+]);
+
+describe('compressDelta', () => {
+  test('produces a small patch against the reference', () => {
+    const patch = compressDelta(reference, edited);
+    expect(patch.length).toBeLessThan(1024);
+    expect(patch.length).toBeLessThan(compress(edited).length / 100);
+    expect(decompressDelta(reference, patch).equals(edited)).toBe(true);
+  });
+
+  test('reaches references larger than the default window', () => {
+    const large = randomBytes(9 * 1024 * 1024);
+    const patch = compressDelta(large, large, { compressionLevel: 1 });
+    expect(patch.length).toBeLessThan(64 * 1024);
+    expect(decompressDelta(large, patch).equals(large)).toBe(true);
+  });
+
+  test('allows overriding parameters', () => {
+    const patch = compressDelta(reference, edited, { windowLog: 10 });
+    expect(patch.length).toBeGreaterThan(edited.length / 2);
+    expect(decompressDelta(reference, patch).equals(edited)).toBe(true);
+  });
+
+  test('async variant works', async () => {
+    const patch = await compressDeltaAsync(reference, edited);
+    expect(patch.equals(compressDelta(reference, edited))).toBe(true);
+  });
+});
+
+describe('decompressDelta', () => {
+  const patch = compressDelta(reference, edited);
+
+  test('requires the same reference', () => {
+    const other = randomBytes(reference.length);
+    expect(() => decompressDelta(other, patch)).toThrow();
+  });
+
+  test('rejects patches without a content size', () => {
+    const unsized = compressDelta(reference, edited, {
+      contentSizeFlag: false,
+    });
+    expect(() => decompressDelta(reference, unsized)).toThrow(
+      'Patch does not record its decompressed size',
+    );
+  });
+
+  test('respects maxOutputSize', () => {
+    expect(() =>
+      decompressDelta(reference, patch, {}, { maxOutputSize: 1024 }),
+    ).toThrow(RangeError);
+  });
+
+  test('async variant works', async () => {
+    const result = await decompressDeltaAsync(reference, patch);
+    expect(result.equals(edited)).toBe(true);
+  });
+});
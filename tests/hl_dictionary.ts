@@ -0,0 +1,86 @@
+import { describe, expect, test } from '@jest/globals';
+import * as binding from '../binding';
+import {
+  Compressor,
+  Decompressor,
+  finalizeDictionary,
+  trainDictionary,
+} from '../lib';
+
+// Small records with plenty of shared structure, like real training data
+const samples = Array.from({ length: 1000 }, (_, i) =>
+  Buffer.from(
+    JSON.stringify({
+      id: i,
+      name: `user-${(i * 7919) % 1000}`,
+      email: `user${i}@example.com`,
+      active: i % 3 === 0,
+      tags: ['alpha', 'beta', 'gamma', 'delta'].slice(i % 4),
+    }),
+  ),
+);
+
+function expectUsable(dict: Buffer): void {
+  const input = Buffer.from(
+    JSON.stringify({ id: 1001, name: 'user-1', email: 'user1001@example.com' }),
+  );
+  const cmp = new Compressor();
+  cmp.loadDictionary(dict);
+  const compressed = cmp.compress(input);
+  const dec = new Decompressor();
+  dec.loadDictionary(dict);
+  expect(dec.decompress(compressed).equals(input)).toBe(true);
+
+  const plain = new Compressor().compress(input);
+  expect(compressed.length).toBeLessThan(plain.length);
+}
+
+describe('trainDictionary', () => {
+  test('trains a usable dictionary', async () => {
+    const dict = await trainDictionary(samples, { maxSize: 4096 });
+    expect(dict.length).toBeLessThanOrEqual(4096);
+    expectUsable(dict);
+  });
+
+  test('supports the cover algorithm', async () => {
+    const dict = await trainDictionary(samples, {
+      algorithm: 'cover',
+      maxSize: 4096,
+      k: 200,
+      d: 8,
+      threads: 2,
+      dictID: 1234,
+    });
+    expect(binding.getDictIDFromDict(dict)).toBe(1234);
+    expectUsable(dict);
+  });
+
+  test('copies samples before returning', async () => {
+    const mutable = samples.map((s) => Buffer.from(s));
+    const promise = trainDictionary(mutable, { maxSize: 4096 });
+    for (const s of mutable) s.fill(0);
+    expectUsable(await promise);
+  });
+
+  test('propagates errors', async () => {
+    await expect(trainDictionary([Buffer.from('a')])).rejects.toThrow();
+  });
+});
+
+describe('finalizeDictionary', () => {
+  test('builds a usable dictionary', async () => {
+    const content = Buffer.concat(samples.slice(0, 20));
+    const dict = await finalizeDictionary(content, samples, { dictID: 5678 });
+    expect(binding.getDictIDFromDict(dict)).toBe(5678);
+    expectUsable(dict);
+  });
+
+  test('trims content to fit maxSize', async () => {
+    const content = Buffer.concat(samples.slice(0, 40));
+    const dict = await finalizeDictionary(content, samples, {
+      maxSize: 2048,
+    });
+    expect(dict.length).toBeLessThanOrEqual(2048);
+    expectUsable(dict);
+  });
+});
@@ -0,0 +1,168 @@
+import { describe, expect, test } from '@jest/globals';
+import * as events from 'events';
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import * as binding from '../binding';
+import {
+  CompressParameters,
+  SeekableCompressStream,
+  SeekableCompressStreamOptions,
+  SeekableDecompressor,
+  compress,
+  decompress,
+} from '../lib';
+
+// Compressible but not trivially so, and different at every offset
+const original = Buffer.from(
+  Array.from({ length: 20000 }, (_, i) => `line ${i}\n`).join(''),
+);
+
+// Small enough to split the input into many frames
+const smallFrames = { maxFrameSize: 4096 };
+
+async function compressSeekable(
+  input: Buffer,
+  parameters: CompressParameters = {},
+  options: SeekableCompressStreamOptions = {},
+): Promise<Buffer> {
+  const stream = new SeekableCompressStream(parameters, options);
+  const chunks: Buffer[] = [];
+  stream.on('data', (chunk: Buffer) => chunks.push(chunk));
+  stream.end(input);
+  await events.once(stream, 'end');
+  return Buffer.concat(chunks);
+}
+
+describe('SeekableCompressStream', () => {
+  test('output is readable by regular decompressors', async () => {
+    const output = await compressSeekable(original, {}, smallFrames);
+    expect(decompress(output).equals(original)).toBe(true);
+  });
+
+  test('splits input into frames of maxFrameSize', async () => {
+    const output = await compressSeekable(original, {}, smallFrames);
+    const reader = new binding.SeekableReader(output);
+    expect(reader.getNumFrames()).toBe(Math.ceil(original.length / 4096));
+    expect(reader.getFrameDecompressedSize(0)).toBe(4096);
+    expect(reader.getFrameDecompressedOffset(reader.getNumFrames())).toBe(
+      original.length,
+    );
+  });
+
+  test('records checksums with checksumFlag', async () => {
+    const output = await compressSeekable(original, { checksumFlag: true });
+    const tableSize = binding.seekTableSize(output);
+    // Header, one entry with checksum, and footer
+    expect(tableSize).toBe(8 + 12 + 9);
+    const frame = output.subarray(0, output.length - tableSize);
+    const table = output.subarray(frame.length);
+    expect(table.readUInt32LE(16)).toBe(frame.readUInt32LE(frame.length - 4));
+    expect(table.readUInt8(table.length - 5)).toBe(0x80);
+  });
+
+  test('#endFrame ends the current frame', async () => {
+    const stream = new SeekableCompressStream();
+    const chunks: Buffer[] = [];
+    stream.on('data', (chunk: Buffer) => chunks.push(chunk));
+    stream.write('hello');
+    stream.endFrame();
+    stream.endFrame();
+    stream.end(' world');
+    await events.once(stream, 'end');
+
+    const reader = new binding.SeekableReader(Buffer.concat(chunks));
+    expect(reader.getNumFrames()).toBe(2);
+    expect(reader.getFrameDecompressedSize(0)).toBe(5);
+  });
+
+  test('empty input produces only a seek table', async () => {
+    const output = await compressSeekable(Buffer.alloc(0));
+    expect(output.length).toBe(8 + 9);
+    expect(decompress(output).length).toBe(0);
+  });
+
+  test('fails once the seekable format runs out of frames', async () => {
+    const stream = new SeekableCompressStream({}, { maxFrameSize: 1 });
+    // Skip ahead to the last frame the seek table can hold
+    stream['numFrames'] = 0x8000000 - 1;
+    stream.resume();
+    stream.end('ab');
+    await expect(events.once(stream, 'end')).rejects.toThrow(
+      'Too many frames for the seekable format',
+    );
+  });
+
+  test('rejects invalid maxFrameSize', () => {
+    expect(() => new SeekableCompressStream({}, { maxFrameSize: 0 })).toThrow(
+      RangeError,
+    );
+  });
+});
+
+describe('SeekableDecompressor', () => {
+  test('reads arbitrary ranges', async () => {
+    const output = await compressSeekable(original, {}, smallFrames);
+    const dec = await SeekableDecompressor.open(output);
+    expect(dec.size).toBe(original.length);
+
+    const ranges: [number, number][] = [
+      [0, original.length],
+      [0, 1],
+      [100, 200],
+      [4000, 5000],
+      [4096, 8192],
+      [10000, 50000],
+      [original.length - 1, original.length],
+    ];
+    for (const [start, end] of ranges) {
+      const result = await dec.read(start, end);
+      expect(result.equals(original.subarray(start, end))).toBe(true);
+    }
+  });
+
+  test('clamps ranges to the end of the data', async () => {
+    const dec = await SeekableDecompressor.open(
+      await compressSeekable(original),
+    );
+    const tail = await dec.read(original.length - 10, original.length + 10);
+    expect(tail.equals(original.subarray(-10))).toBe(true);
+    const past = await dec.read(original.length + 10, original.length + 20);
+    expect(past).toHaveLength(0);
+    await expect(dec.read(10, 5)).rejects.toThrow(RangeError);
+  });
+
+  test('reads from files', async () => {
+    const dir = await fs.promises.mkdtemp(path.join(os.tmpdir(), 'zstd-napi-'));
+    const file = path.join(dir, 'data.zst');
+    try {
+      await fs.promises.writeFile(
+        file,
+        await compressSeekable(original, {}, smallFrames),
+      );
+      const handle = await fs.promises.open(file);
+      try {
+        const dec = await SeekableDecompressor.open(handle);
+        const result = await dec.read(5000, 15000);
+        expect(result.equals(original.subarray(5000, 15000))).toBe(true);
+      } finally {
+        await handle.close();
+      }
+    } finally {
+      await fs.promises.rm(dir, { recursive: true });
+    }
+  });
+
+  test('rejects data without a seek table', async () => {
+    await expect(
+      SeekableDecompressor.open(compress(original)),
+    ).rejects.toThrowErrorMatchingInlineSnapshot(`"Missing seek table"`);
+  });
+
+  test('rejects seek tables that do not match the data', async () => {
+    const output = await compressSeekable(original);
+    await expect(
+      SeekableDecompressor.open(Buffer.concat([Buffer.alloc(1), output])),
+    ).rejects.toThrow('Seek table does not match the compressed data');
+  });
+});
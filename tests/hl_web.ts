@@ -0,0 +1,138 @@
+import { describe, expect, test } from '@jest/globals';
+import { randomBytes } from 'crypto';
+import { ReadableStream } from 'stream/web';
+import {
+  ZstdCompressionStream,
+  ZstdDecompressionStream,
+  compress,
+  decompress,
+} from '../lib';
+
+function streamOf(
+  input: Uint8Array,
+  chunkSize: number,
+): ReadableStream<Uint8Array> {
+  let offset = 0;
+  return new ReadableStream<Uint8Array>({
+    pull(controller) {
+      if (offset >= input.length) {
+        controller.close();
+        return;
+      }
+      controller.enqueue(input.subarray(offset, offset + chunkSize));
+      offset += chunkSize;
+    },
+  });
+}
+
+async function readAll(stream: ReadableStream<Uint8Array>): Promise<Buffer> {
+  const chunks = [];
+  for await (const chunk of stream) {
+    chunks.push(chunk);
+  }
+  return Buffer.concat(chunks);
+}
+
+const original = Buffer.concat([
+  randomBytes(100000),
+  Buffer.alloc(300000),
+  randomBytes(100000),
+]);
+
+describe('ZstdCompressionStream', () => {
+  test('basic functionality works', async () => {
+    const stream = streamOf(original, 10000);
+    const output = await readAll(
+      stream.pipeThrough(new ZstdCompressionStream()),
+    );
+    expect(output.length).toBeLessThan(original.length);
+    expect(decompress(output).equals(original)).toBe(true);
+  });
+
+  test('compresses empty input to an empty frame', async () => {
+    const stream = streamOf(Buffer.alloc(0), 1);
+    const output = await readAll(
+      stream.pipeThrough(new ZstdCompressionStream()),
+    );
+    expect(decompress(output)).toHaveLength(0);
+  });
+
+  test('dictionary option works', async () => {
+    const dictionary = original.subarray(0, 100000);
+    const input = original.subarray(0, 50000);
+    const cmp = new ZstdCompressionStream({}, { dictionary });
+    const compressed = await readAll(streamOf(input, 4096).pipeThrough(cmp));
+    expect(compressed.length).toBeLessThan(1000);
+
+    const dec = new ZstdDecompressionStream({}, { dictionary });
+    const output = await readAll(streamOf(compressed, 100).pipeThrough(dec));
+    expect(output.equals(input)).toBe(true);
+  });
+});
+
+describe('ZstdDecompressionStream', () => {
+  test('basic functionality works', async () => {
+    const input = Buffer.concat([
+      compress(original.subarray(0, 250000)),
+      compress(original.subarray(250000), { contentSizeFlag: false }),
+    ]);
+    const stream = streamOf(input, 1000);
+    const output = await readAll(
+      stream.pipeThrough(new ZstdDecompressionStream()),
+    );
+    expect(output.equals(original)).toBe(true);
+  });
+
+  test('supports BYOB readers', async () => {
+    const stream = streamOf(compress(original), 1000);
+    const reader = stream
+      .pipeThrough(new ZstdDecompressionStream())
+      .getReader({ mode: 'byob' });
+    let view = new Uint8Array(4096);
+    let offset = 0;
+    for (;;) {
+      const { done, value } = await reader.read(view);
+      if (done) break;
+      // Decompressed straight into the buffer we passed in
+      expect(value.byteOffset).toBe(0);
+      expect(value.buffer.byteLength).toBe(4096);
+      const expected = original.subarray(offset, offset + value.length);
+      expect(Buffer.from(value).equals(expected)).toBe(true);
+      offset += value.length;
+      view = new Uint8Array(value.buffer);
+    }
+    expect(offset).toBe(original.length);
+  });
+
+  test('fails if the input ends in the middle of a frame', async () => {
+    const input = compress(original);
+    const stream = streamOf(input.subarray(0, input.length - 1), 1000);
+    await expect(
+      readAll(stream.pipeThrough(new ZstdDecompressionStream())),
+    ).rejects.toThrow('Stream ended in middle of compressed data frame');
+  });
+
+  test('fails on corrupt input', async () => {
+    const stream = streamOf(Buffer.alloc(100), 10);
+    await expect(
+      readAll(stream.pipeThrough(new ZstdDecompressionStream())),
+    ).rejects.toThrow('Unknown frame descriptor');
+  });
+
+  test('maxOutputSize option stops output over the limit', async () => {
+    const dec = new ZstdDecompressionStream(
+      {},
+      { maxOutputSize: original.length - 1 },
+    );
+    const stream = streamOf(compress(original), 1000);
+    await expect(readAll(stream.pipeThrough(dec))).rejects.toThrow(RangeError);
+  });
+
+  test('cancelling the readable side fails writes', async () => {
+    const dec = new ZstdDecompressionStream();
+    const writer = dec.writable.getWriter();
+    const write = writer.write(compress(original));
+    await dec.readable.cancel(new Error('Cancelled'));
+    await expect(write).rejects.toThrow('Cancelled');
+  });
+});
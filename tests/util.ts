@@ -1,5 +1,12 @@
 import { describe, expect, it } from '@jest/globals';
-import { mapNumber, mapParameters } from '../lib/util';
+import * as binding from '../binding';
+import {
+  OutputSlab,
+  compressBound,
+  mapNumber,
+  mapParameters,
+  packParameters,
+} from '../lib/util';
 
 describe('mapParameters', () => {
   enum TestParameter {
@@ -35,3 +42,52 @@ describe('mapParameters', () => {
     }).toThrow();
   });
 });
+
+describe('packParameters', () => {
+  it('should pack parameters as pairs', () => {
+    const packed = packParameters(new Map([[3, 5]]));
+    expect(Array.from(packed)).toEqual([3, 5]);
+  });
+
+  it('should share an empty array when there are no parameters', () => {
+    const packed = packParameters(new Map());
+    expect(packed).toHaveLength(0);
+    expect(packParameters(new Map())).toBe(packed);
+  });
+});
+
+describe('compressBound', () => {
+  it('should match the native implementation', () => {
+    const limit = 128 * 1024;
+    const sizes = [0, 1, 255, 256, 2047, limit - 1, limit, limit + 1, 2 ** 33];
+    for (const size of sizes) {
+      expect(compressBound(size)).toBe(binding.compressBound(size));
+    }
+  });
+});
+
+describe('OutputSlab', () => {
+  it('should hand out consecutive chunks of a shared slab', () => {
+    const slab = new OutputSlab(16, 64);
+    expect(slab.free).toHaveLength(64);
+    slab.free.fill(1, 0, 10);
+    const first = slab.take(10);
+    slab.free.fill(2, 0, 10);
+    const second = slab.take(10);
+
+    expect(second.buffer).toBe(first.buffer);
+    expect(second.byteOffset).toBe(first.byteOffset + 10);
+    expect(first.equals(Buffer.alloc(10, 1))).toBe(true);
+    expect(second.equals(Buffer.alloc(10, 2))).toBe(true);
+    expect(slab.free).toHaveLength(44);
+  });
+
+  it('should start a new slab when too little space is left', () => {
+    const slab = new OutputSlab(16, 64);
+    const first = slab.take(slab.free.length - 15);
+    first.fill(1);
+    slab.free.fill(2);
+    expect(slab.free).toHaveLength(64);
+    expect(first.equals(Buffer.alloc(49, 1))).toBe(true);
+  });
+});